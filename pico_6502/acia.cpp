@@ -0,0 +1,150 @@
+//
+// Emulated 6551 ACIA bridged to a hardware UART
+//
+// Copyright 2026, John Clark
+//
+
+#include "acia.h"
+#include "spsc_ring.hpp"
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/uart.h"
+
+// UART0 on header pins 27/28 (UART1 carries the stdio console)
+#define ACIA_UART         uart0
+#define ACIA_UART_IRQ     UART0_IRQ
+#define ACIA_UART_TX_PIN  0
+#define ACIA_UART_RX_PIN  1
+#define ACIA_UART_BAUD    115200
+
+// Ring sizes (power of two)
+#define ACIA_RX_SIZE 256
+#define ACIA_TX_SIZE 256
+
+// Status register bits
+#define ACIA_ST_OVERRUN  0x04
+#define ACIA_ST_RDRF     0x08
+#define ACIA_ST_TDRE     0x10
+#define ACIA_ST_IRQ      0x80
+
+// Command register bits
+#define ACIA_CMD_DTR     0x01
+#define ACIA_CMD_IRD     0x02  // 1 = receiver IRQ disabled
+#define ACIA_CMD_TIC     0x0C  // transmitter control
+#define ACIA_CMD_TIC_IRQ 0x04  // TX IRQ enabled, RTS low
+
+// Receive ring: UART IRQ (core 1) -> 6502 (core 0)
+static SpscRing<uint8_t, ACIA_RX_SIZE> rx_ring;
+static volatile bool rx_overrun = false;
+
+// Transmit ring: 6502 (core 0) -> UART IRQ (core 1)
+static SpscRing<uint8_t, ACIA_TX_SIZE> tx_ring;
+
+// 6551 registers (core 0)
+static uint8_t command_reg = 0;
+static uint8_t control_reg = 0;
+static uint8_t last_rx = 0;
+
+
+// Move bytes between the UART FIFOs and the rings (core 1, interrupts off)
+static void uart_service(void) {
+    while (uart_is_readable(ACIA_UART)) {
+        uint8_t ch = (uint8_t)uart_get_hw(ACIA_UART)->dr;
+        if (!rx_ring.push(ch)) {
+            rx_overrun = true;
+        }
+    }
+
+    uint8_t ch;
+    while (uart_is_writable(ACIA_UART) && tx_ring.pop(ch)) {
+        uart_get_hw(ACIA_UART)->dr = ch;
+    }
+
+    // Nothing left to send: stop TX interrupts until core 0 queues more
+    if (tx_ring.empty()) {
+        hw_clear_bits(&uart_get_hw(ACIA_UART)->imsc, UART_UARTIMSC_TXIM_BITS);
+    }
+}
+
+static void acia_uart_irq(void) {
+    uart_service();
+}
+
+void acia_init(void) {
+    uart_init(ACIA_UART, ACIA_UART_BAUD);
+    gpio_set_function(ACIA_UART_TX_PIN, GPIO_FUNC_UART);
+    gpio_set_function(ACIA_UART_RX_PIN, GPIO_FUNC_UART);
+    uart_set_hw_flow(ACIA_UART, false, false);
+    uart_set_format(ACIA_UART, 8, 1, UART_PARITY_NONE);
+    uart_set_fifo_enabled(ACIA_UART, true);
+
+    irq_set_exclusive_handler(ACIA_UART_IRQ, acia_uart_irq);
+    irq_set_enabled(ACIA_UART_IRQ, true);
+    uart_set_irqs_enabled(ACIA_UART, true, false);
+}
+
+void acia_task(void) {
+    // The TX interrupt only fires on a FIFO level transition, so an idle
+    // UART needs the first bytes of a burst pushed from here
+    if (!tx_ring.empty() && uart_is_writable(ACIA_UART)) {
+        uint32_t irq_state = save_and_disable_interrupts();
+        uart_service();
+        restore_interrupts(irq_state);
+    }
+}
+
+uint8_t acia_read(uint8_t reg) {
+    switch (reg & 0x03) {
+        case ACIA_REG_DATA:
+            rx_ring.pop(last_rx);
+            rx_overrun = false;
+            return last_rx;
+
+        case ACIA_REG_STATUS: {
+            uint8_t status = 0;
+            if (rx_overrun) status |= ACIA_ST_OVERRUN;
+            if (!rx_ring.empty()) status |= ACIA_ST_RDRF;
+            if (!tx_ring.full()) status |= ACIA_ST_TDRE;
+            if (acia_irq_asserted()) status |= ACIA_ST_IRQ;
+            return status;
+        }
+
+        case ACIA_REG_COMMAND:
+            return command_reg;
+
+        default:
+            return control_reg;
+    }
+}
+
+void acia_write(uint8_t reg, uint8_t val) {
+    switch (reg & 0x03) {
+        case ACIA_REG_DATA:
+            if (tx_ring.push(val)) {
+                hw_set_bits(&uart_get_hw(ACIA_UART)->imsc, UART_UARTIMSC_TXIM_BITS);
+            }
+            break;
+
+        case ACIA_REG_STATUS:
+            // Programmed reset: clear command bits 0-4, keep parity settings
+            command_reg &= 0xE0;
+            rx_overrun = false;
+            break;
+
+        case ACIA_REG_COMMAND:
+            command_reg = val;
+            break;
+
+        default:
+            control_reg = val;
+            break;
+    }
+}
+
+bool acia_irq_asserted(void) {
+    if (!(command_reg & ACIA_CMD_DTR)) return false;
+    bool rx_irq = !(command_reg & ACIA_CMD_IRD) && !rx_ring.empty();
+    bool tx_irq = ((command_reg & ACIA_CMD_TIC) == ACIA_CMD_TIC_IRQ) && !tx_ring.full();
+    return rx_irq || tx_irq;
+}
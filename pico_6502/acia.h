@@ -0,0 +1,51 @@
+//
+// Emulated 6551 ACIA bridged to a hardware UART
+//
+// Copyright 2026, John Clark
+//
+// The 6502 side (core 0) only touches the RX/TX rings; the UART side runs on
+// core 1 from the UART interrupt, so serial traffic never stalls emulation.
+//
+// Register map (offset from ACIA_BASE, mirrored every 4 bytes):
+//   $00  read: receive data       write: transmit data
+//   $01  read: status             write: programmed reset
+//   $02  command (bit 0 DTR, bit 1 receiver IRQ disable, bits 2-3 TX control)
+//   $03  control (stored only - the link always runs at ACIA_UART_BAUD)
+//
+// Status bits: 2 overrun, 3 receive data register full,
+//              4 transmit data register empty, 7 IRQ
+//
+
+#ifndef _ACIA_H_
+#define _ACIA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACIA_REG_DATA     0x00
+#define ACIA_REG_STATUS   0x01
+#define ACIA_REG_COMMAND  0x02
+#define ACIA_REG_CONTROL  0x03
+
+// Initialize UART and its RX/TX interrupt - call from core 1
+void acia_init(void);
+
+// Kick transmission after idle periods - call regularly from the core 1 loop
+void acia_task(void);
+
+// 6502 register access (core 0)
+uint8_t acia_read(uint8_t reg);
+void acia_write(uint8_t reg, uint8_t val);
+
+// True while the emulated IRQ output is asserted (core 0)
+bool acia_irq_asserted(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _ACIA_H_
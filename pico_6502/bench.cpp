@@ -0,0 +1,152 @@
+//
+//  Emulator core benchmark for RP2350
+//
+//  Copyright 2026, John Clark
+//
+//  Runs a fixed 6502 workload unthrottled on core 0 and reports the
+//  steady-state emulated MHz and per-slice timing jitter on the serial
+//  console. The build produces one image with the core in XIP flash and one
+//  with it in SRAM (W65C02S_CORE_IN_RAM) so the placements can be compared.
+//
+//  The cold pass invalidates the XIP cache before every slice, standing in
+//  for USB, display and printf code evicting the emulator from the cache.
+//  The traced pass runs the steady workload with the execution trace ring
+//  attached, as the emulator does with PICO_6502_TRACE, and prints its cost
+//  relative to the steady pass and in system clock cycles per instruction.
+//
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/vreg.h"
+#include "hardware/xip_cache.h"
+#include "w65c02s.hpp"
+#include "ram.hpp"
+
+#if W65C02S_CORE_IN_RAM
+#define BENCH_PLACEMENT "SRAM"
+#define BENCH_FUNC(name) __not_in_flash_func(name)
+#else
+#define BENCH_PLACEMENT "XIP flash"
+#define BENCH_FUNC(name) name
+#endif
+
+#define BENCH_SLICE_CYCLES  8192   // emulated cycles per timed slice
+#define BENCH_SLICES        2000   // slices per pass
+
+// Mixed workload: loads/stores across addressing modes, ALU, RMW, stack and JSR/RTS
+static const uint16_t bench_load_addr = 0x0600;
+static const uint8_t bench_program[] = {
+    0xa2, 0x00,         // $0600  ldx #$00
+    0xbd, 0x00, 0x07,   // $0602  lda $0700,x
+    0x69, 0x01,         // $0605  adc #$01
+    0x9d, 0x00, 0x02,   // $0607  sta $0200,x
+    0x0a,               // $060a  asl a
+    0x66, 0x10,         // $060b  ror $10
+    0xe6, 0x11,         // $060d  inc $11
+    0xa4, 0x11,         // $060f  ldy $11
+    0xb1, 0x12,         // $0611  lda ($12),y
+    0x45, 0x15,         // $0613  eor $15
+    0x85, 0x15,         // $0615  sta $15
+    0x20, 0x20, 0x06,   // $0617  jsr $0620
+    0xe8,               // $061a  inx
+    0xd0, 0xe5,         // $061b  bne $0602
+    0x4c, 0x00, 0x06,   // $061d  jmp $0600
+    0x48,               // $0620  pha
+    0x18,               // $0621  clc
+    0xa5, 0x14,         // $0622  lda $14
+    0xe9, 0x03,         // $0624  sbc #$03
+    0x85, 0x14,         // $0626  sta $14
+    0x68,               // $0628  pla
+    0x60,               // $0629  rts
+};
+
+static HookedRam ram;
+static W65C02S cpu;
+
+// Same ring size as the emulator's trace
+static constexpr uint32_t BENCH_TRACE_RECORDS = 16384;
+static uint32_t trace_storage[BENCH_TRACE_RECORDS];
+static TraceBuffer trace(trace_storage, BENCH_TRACE_RECORDS);
+
+struct BenchResult {
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t elapsed_us;
+    uint32_t slice_min_us;
+    uint32_t slice_max_us;
+};
+
+// Run BENCH_SLICES slices of emulation, timing each one
+static BenchResult BENCH_FUNC(run_pass)(bool cold) {
+    BenchResult r = {0, 0, 0, UINT32_MAX, 0};
+    uint64_t pass_start = time_us_64();
+
+    for (int i = 0; i < BENCH_SLICES; i++) {
+        if (cold) xip_cache_invalidate_all();
+
+        uint64_t slice_start = time_us_64();
+        uint64_t target = cpu.cycles + BENCH_SLICE_CYCLES;
+        while (cpu.cycles < target) {
+            cpu.step();
+            r.instructions++;
+        }
+        uint32_t slice_us = (uint32_t)(time_us_64() - slice_start);
+
+        if (slice_us < r.slice_min_us) r.slice_min_us = slice_us;
+        if (slice_us > r.slice_max_us) r.slice_max_us = slice_us;
+    }
+
+    r.cycles = (uint64_t)BENCH_SLICES * BENCH_SLICE_CYCLES;
+    r.elapsed_us = time_us_64() - pass_start;
+    return r;
+}
+
+static void print_result(const char* label, const BenchResult& r) {
+    uint32_t avg_us = (uint32_t)(r.elapsed_us / BENCH_SLICES);
+    printf("  %-6s %6.2f MHz   slice %lu/%lu/%lu us (min/avg/max)   jitter %lu us\n",
+           label, (double)r.cycles / (double)r.elapsed_us,
+           (unsigned long)r.slice_min_us, (unsigned long)avg_us, (unsigned long)r.slice_max_us,
+           (unsigned long)(r.slice_max_us - r.slice_min_us));
+}
+
+int main() {
+    // Same clock setup as the emulator
+    vreg_set_voltage(VREG_VOLTAGE_1_15);
+    sleep_ms(10);
+    set_sys_clock_khz(200000, true);
+    stdio_init_all();
+
+    HookedRam::set_instance(&ram);
+    cpu.ram_read = &HookedRam::static_read;
+    cpu.ram_write = &HookedRam::static_write;
+
+    ram.load(bench_load_addr, bench_program, sizeof(bench_program));
+    ram[0x12] = 0x00;  // ($12) -> $0700
+    ram[0x13] = 0x07;
+    cpu.reset();
+    cpu.reg.pc = bench_load_addr;
+
+    // Warm up caches and branch predictors before measuring
+    run_pass(false);
+
+    while (true) {
+        printf("pico_6502 benchmark: core in %s, %d x %d cycle slices\n",
+               BENCH_PLACEMENT, BENCH_SLICES, BENCH_SLICE_CYCLES);
+        BenchResult steady = run_pass(false);
+        print_result("steady", steady);
+        print_result("cold", run_pass(true));
+
+        trace.start(cpu.reg.pc, cpu.reg.sp);
+        cpu.trace = &trace;
+        BenchResult traced = run_pass(false);
+        cpu.trace = nullptr;
+        print_result("traced", traced);
+        double clocks_per_us = (double)clock_get_hz(clk_sys) / 1e6;
+        printf("  trace overhead %+.1f%%, %.1f clocks per instruction\n",
+               100.0 * ((double)traced.elapsed_us / (double)steady.elapsed_us - 1.0),
+               clocks_per_us * ((double)traced.elapsed_us / (double)traced.instructions -
+                                (double)steady.elapsed_us / (double)steady.instructions));
+        sleep_ms(2000);
+    }
+}
@@ -0,0 +1,141 @@
+//
+//  Memory-mapped blitter for the 6502 emulator
+//
+//  Copyright 2026, John Clark
+//
+//  Released under the GNU General Public License
+//  https://www.gnu.org/licenses/gpl.html
+//
+//  Fill, copy and masked copy over emulated RAM, run natively (memset and
+//  memmove per row) the moment the command register is written. The registers
+//  are ordinary bytes in the blitter's page of RAM, so they read back as
+//  written and snapshots (rewind.hpp) capture them for free. The caller adds
+//  the returned cycle cost to the CPU's cycle counter, which stalls the
+//  program for as long as the transfer is modelled to take.
+//
+//  Registers (offset from the base):
+//    $00-$01  source address
+//    $02-$03  destination address
+//    $04-$05  width in bytes (the whole length for a linear transfer)
+//    $06      height in rows (0 = 1)
+//    $07      source stride (0 = width)
+//    $08      destination stride (0 = width)
+//    $09      fill value, or the transparent byte for a masked copy
+//    $0A      cost in CPU cycles per 16 bytes (0 = free)
+//    $0F      command: write 1 fill, 2 copy, 3 masked copy
+//
+//  The blitter writes RAM directly: device registers in the destination are
+//  not triggered and gdb watchpoints do not see the writes. Addresses wrap at
+//  64K. Copies behave like memmove, including rectangles whose rows overlap.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+enum BlitterReg : uint8_t {
+    BLIT_SRC = 0x00,
+    BLIT_DST = 0x02,
+    BLIT_WIDTH = 0x04,
+    BLIT_HEIGHT = 0x06,
+    BLIT_SRC_STRIDE = 0x07,
+    BLIT_DST_STRIDE = 0x08,
+    BLIT_VALUE = 0x09,
+    BLIT_COST = 0x0A,
+    BLIT_COMMAND = 0x0F,
+};
+
+enum BlitterCommand : uint8_t { BLIT_FILL = 1, BLIT_COPY = 2, BLIT_COPY_MASKED = 3 };
+
+class Blitter {
+public:
+    // mem is the 64K the CPU runs on, base the page the registers live in
+    Blitter(uint8_t* mem, uint16_t base) : mem_(mem), base_(base) {}
+
+    // Run a command with the current register contents; returns its cost in
+    // CPU cycles (0 for an unknown command)
+    uint32_t run(uint8_t command) {
+        uint16_t src = reg16(BLIT_SRC);
+        uint16_t dst = reg16(BLIT_DST);
+        uint16_t width = reg16(BLIT_WIDTH);
+        uint16_t height = reg(BLIT_HEIGHT) ? reg(BLIT_HEIGHT) : 1;
+        uint16_t src_stride = reg(BLIT_SRC_STRIDE) ? reg(BLIT_SRC_STRIDE) : width;
+        uint16_t dst_stride = reg(BLIT_DST_STRIDE) ? reg(BLIT_DST_STRIDE) : width;
+        uint8_t value = reg(BLIT_VALUE);
+
+        dirty_begin_ = dst;
+        dirty_len_ = 0;
+        if (width == 0) return 0;
+
+        switch (command) {
+            case BLIT_FILL:
+                for (uint16_t row = 0; row < height; row++) {
+                    fill_row((uint16_t)(dst + row * dst_stride), width, value);
+                }
+                break;
+            case BLIT_COPY:
+            case BLIT_COPY_MASKED: {
+                // Bottom-up when the destination is above the source, so overlapping rows survive
+                bool reverse = (uint16_t)(dst - src) < (uint32_t)height * src_stride && dst != src;
+                for (uint16_t i = 0; i < height; i++) {
+                    uint16_t row = reverse ? height - 1 - i : i;
+                    copy_row((uint16_t)(src + row * src_stride), (uint16_t)(dst + row * dst_stride), width,
+                             command == BLIT_COPY_MASKED, value);
+                }
+                break;
+            }
+            default:
+                return 0;
+        }
+
+        uint32_t bytes = (uint32_t)width * height;
+        uint32_t span = (uint32_t)(height - 1) * dst_stride + width;
+        dirty_len_ = span < 0x10000 ? span : 0x10000;
+        return (bytes * reg(BLIT_COST) + 15) / 16;
+    }
+
+    // Destination bytes the last command may have changed: dirty_len() bytes
+    // from dirty_begin(), wrapping at 64K
+    uint16_t dirty_begin() const { return dirty_begin_; }
+    uint32_t dirty_len() const { return dirty_len_; }
+
+    // True when the last command's destination touched [begin, begin + len)
+    bool dirtied(uint16_t begin, uint32_t len) const {
+        if (dirty_len_ == 0 || len == 0) return false;
+        uint32_t start = (uint16_t)(begin - dirty_begin_);  // offset into the dirty span
+        return start < dirty_len_ || (uint16_t)(dirty_begin_ - begin) < len;
+    }
+
+private:
+    uint8_t reg(uint8_t offset) const { return mem_[(uint16_t)(base_ + offset)]; }
+    uint16_t reg16(uint8_t offset) const { return reg(offset) | (reg(offset + 1) << 8); }
+
+    void fill_row(uint16_t dst, uint16_t len, uint8_t value) {
+        if ((uint32_t)dst + len <= 0x10000) {
+            memset(mem_ + dst, value, len);
+            return;
+        }
+        for (uint16_t i = 0; i < len; i++) mem_[(uint16_t)(dst + i)] = value;
+    }
+
+    void copy_row(uint16_t src, uint16_t dst, uint16_t len, bool masked, uint8_t key) {
+        bool contiguous = (uint32_t)src + len <= 0x10000 && (uint32_t)dst + len <= 0x10000;
+        if (!masked && contiguous) {
+            memmove(mem_ + dst, mem_ + src, len);
+            return;
+        }
+        // Masked or wrapping: byte at a time, in the direction memmove would use
+        bool backward = (uint16_t)(dst - src) < len && dst != src;
+        for (uint16_t n = 0; n < len; n++) {
+            uint16_t i = backward ? len - 1 - n : n;
+            uint8_t b = mem_[(uint16_t)(src + i)];
+            if (!masked || b != key) mem_[(uint16_t)(dst + i)] = b;
+        }
+    }
+
+    uint8_t* mem_;
+    uint16_t base_;
+    uint16_t dirty_begin_ = 0;
+    uint32_t dirty_len_ = 0;
+};
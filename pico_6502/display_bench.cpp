@@ -0,0 +1,172 @@
+//
+//  Display benchmark for RP2350
+//
+//  Copyright 2026, John Clark
+//
+//  Draws fixed sets of lines, circles, filled polygons (3, 5 and 16
+//  vertices, with the integer and the old floating point fill) and lines of
+//  text (HAGL per glyph and the HAL glyph cache) through HAGL on the ILI9488,
+//  and reports shapes per second and microseconds per shape on the serial
+//  console. The build produces one image with pixel coalescing in the HAL
+//  (HAGL_HAL_COALESCE_PIXELS), one that writes every pixel through its own
+//  address window, and one drawing into SRAM frames (HAGL_HAL_BUFFERED), so
+//  they can be compared on the same panel. Passes end with the shapes on it.
+//
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/vreg.h"
+#include "hagl.h"
+#include "hagl_hal.h"
+#include "font6x9.h"
+
+#if HAGL_HAL_BUFFERED
+#define BENCH_MODE "buffered"
+#elif HAGL_HAL_COALESCE_PIXELS
+#define BENCH_MODE "coalesced"
+#else
+#define BENCH_MODE "per-pixel"
+#endif
+
+#define BENCH_SHAPES  500   // shapes per pass
+
+static hagl_backend_t *display;
+
+// Deterministic shape parameters so both images draw the same thing
+static uint32_t bench_seed;
+
+static uint32_t bench_rand(uint32_t n) {
+    bench_seed = bench_seed * 1664525u + 1013904223u;
+    return (bench_seed >> 8) % n;
+}
+
+static hagl_color_t bench_color() {
+    return hagl_color(display, 64 + bench_rand(192), 64 + bench_rand(192), 64 + bench_rand(192));
+}
+
+// Wait until everything drawn is on the panel
+static void bench_flush() {
+    hagl_flush(display);
+#if HAGL_HAL_BUFFERED
+    hagl_hal_flush_wait();
+#endif
+}
+
+static void bench_clear() {
+    hagl_hal_fill_rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, hagl_color(display, 0, 0, 0));
+    bench_flush();
+}
+
+static uint64_t pass_lines() {
+    bench_seed = 1;
+    uint64_t start = time_us_64();
+    for (int i = 0; i < BENCH_SHAPES; i++) {
+        int16_t x0 = bench_rand(DISPLAY_WIDTH), y0 = bench_rand(DISPLAY_HEIGHT);
+        int16_t x1 = bench_rand(DISPLAY_WIDTH), y1 = bench_rand(DISPLAY_HEIGHT);
+        hagl_draw_line(display, x0, y0, x1, y1, bench_color());
+    }
+    bench_flush();
+    return time_us_64() - start;
+}
+
+static uint64_t pass_circles() {
+    bench_seed = 2;
+    uint64_t start = time_us_64();
+    for (int i = 0; i < BENCH_SHAPES; i++) {
+        int16_t r = 4 + bench_rand(DISPLAY_HEIGHT / 2 - 4);
+        int16_t x = bench_rand(DISPLAY_WIDTH), y = bench_rand(DISPLAY_HEIGHT);
+        hagl_draw_circle(display, x, y, r, bench_color());
+    }
+    bench_flush();
+    return time_us_64() - start;
+}
+
+// Points on a circle of radius 64, 16 steps
+static const int8_t circle16[16][2] = {
+    {64, 0}, {59, 24}, {45, 45}, {24, 59}, {0, 64}, {-24, 59}, {-45, 45}, {-59, 24},
+    {-64, 0}, {-59, -24}, {-45, -45}, {-24, -59}, {0, -64}, {24, -59}, {45, -45}, {59, -24},
+};
+
+typedef void (*fill_fn)(void const *surface, int16_t amount, int16_t *vertices, hagl_color_t color);
+
+// Star-like polygons: evenly spread angles, each vertex at its own radius
+static uint64_t pass_polygons(int amount, fill_fn fill) {
+    bench_seed = 3;
+    int16_t vertices[32];
+    uint64_t start = time_us_64();
+    for (int i = 0; i < BENCH_SHAPES; i++) {
+        int16_t x = 40 + bench_rand(DISPLAY_WIDTH - 80), y = 40 + bench_rand(DISPLAY_HEIGHT - 80);
+        for (int v = 0; v < amount; v++) {
+            const int8_t* p = circle16[v * 16 / amount];
+            int16_t r = 8 + bench_rand(32);  // 8 to 39 pixels
+            vertices[2 * v] = x + p[0] * r / 64;
+            vertices[2 * v + 1] = y + p[1] * r / 64;
+        }
+        fill(display, amount, vertices, bench_color());
+    }
+    bench_flush();
+    return time_us_64() - start;
+}
+
+typedef void (*text_fn)(const wchar_t *str, int16_t x0, int16_t y0, hagl_color_t color);
+
+static void text_hagl(const wchar_t *str, int16_t x0, int16_t y0, hagl_color_t color) {
+    hagl_put_text(display, str, x0, y0, color, font6x9);
+}
+
+static void text_cached(const wchar_t *str, int16_t x0, int16_t y0, hagl_color_t color) {
+    hagl_hal_put_text(str, x0, y0, color, hagl_color(display, 0, 0, 0), font6x9);
+}
+
+// Status-line sized strings at random places
+static uint64_t pass_text(text_fn put) {
+    static const wchar_t* const lines[] = {L"speed 1 MHz", L"200.00 MHz", L"READY", L"0123456789 ABCDEF"};
+    bench_seed = 4;
+    uint64_t start = time_us_64();
+    for (int i = 0; i < BENCH_SHAPES; i++) {
+        int16_t x = bench_rand(DISPLAY_WIDTH - 100), y = bench_rand(DISPLAY_HEIGHT - 9);
+        put(lines[bench_rand(4)], x, y, bench_color());
+    }
+    bench_flush();
+    return time_us_64() - start;
+}
+
+static void print_result(const char* label, uint64_t elapsed_us) {
+    printf("  %-8s %8.1f /s   %6lu us each\n", label,
+           BENCH_SHAPES * 1000000.0 / (double)elapsed_us,
+           (unsigned long)(elapsed_us / BENCH_SHAPES));
+}
+
+int main() {
+    // Same clock setup as the emulator
+    vreg_set_voltage(VREG_VOLTAGE_1_15);
+    sleep_ms(10);
+    set_sys_clock_khz(200000, true);
+    stdio_init_all();
+
+    display = hagl_init();
+
+    while (true) {
+        printf("pico_6502 display benchmark: %s pixels, %d shapes per pass\n", BENCH_MODE, BENCH_SHAPES);
+        bench_clear();
+        print_result("lines", pass_lines());
+        bench_clear();
+        print_result("circles", pass_circles());
+        static const int amounts[] = {3, 5, 16};
+        for (int amount : amounts) {
+            char label[16];
+            bench_clear();
+            snprintf(label, sizeof(label), "%d-gon", amount);
+            print_result(label, pass_polygons(amount, hagl_fill_polygon));
+            bench_clear();
+            snprintf(label, sizeof(label), "%d float", amount);
+            print_result(label, pass_polygons(amount, hagl_fill_polygon_float));
+        }
+        bench_clear();
+        print_result("text", pass_text(text_hagl));
+        bench_clear();
+        print_result("text hal", pass_text(text_cached));
+        sleep_ms(2000);
+    }
+}
@@ -0,0 +1,547 @@
+//
+//  GDB remote serial protocol stub for the 6502 emulator
+//
+//  Copyright 2026, John Clark
+//
+//  Released under the GNU General Public License
+//  https://www.gnu.org/licenses/gpl.html
+//
+//  Speaks enough of the remote protocol for gdb (or any RSP client) to read
+//  and write registers and memory, set breakpoints and watchpoints, single
+//  step, continue and interrupt. With a Rewinder attached it also takes the
+//  reverse step and reverse continue packets (bs/bc).
+//
+//  The transport is a pair of plain functions, so the same stub runs over the
+//  firmware's serial console and over a TCP socket in the headless runner.
+//  The run loop calls step() instead of cpu.step() only while active() is
+//  true, i.e. while stopped, single stepping, or with any breakpoint or
+//  watchpoint set, and poll() once per slice to see Ctrl-C and new packets.
+//  Breakpoints are looked up through a per-page count before the per-address
+//  bitmap, and watchpoints swap the CPU's memory functions for checking ones
+//  only while any are set, so unused features cost nothing.
+//
+//  Registers (gdb numbering): 0 a, 1 x, 2 y, 3 p, 4 sp (8 bit), 5 pc (16 bit)
+//
+
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "rewind.hpp"
+
+#define GDB_MAX_WATCHPOINTS 8
+#define GDB_MAX_PACKET 1024
+#define GDB_MAX_READ 256  // bytes per 'm' reply; gdb reads the rest with further packets
+
+template<typename Cpu>
+class GdbStub {
+public:
+    using ReadChar = int (*)();                         // next byte from the debugger, or -1
+    using Write = void (*)(const char* data, size_t len);
+
+    GdbStub(Cpu& cpu, uint8_t* mem, ReadChar read_char, Write write, bool start_stopped = true)
+        : cpu_(cpu), mem_(mem), read_char_(read_char), write_(write), stopped_(start_stopped) {
+        instance_ = this;
+        update_active();
+    }
+
+    // Enable reverse execution; steps then go through the rewinder
+    void attach_rewinder(Rewinder<Cpu>* rewinder) { rewinder_ = rewinder; }
+
+    bool stopped() const { return stopped_; }
+
+    // True while the run loop must call step() rather than cpu.step()
+    bool active() const { return active_; }
+
+    // Service the debugger: call once per slice while running. Returns true
+    // when a packet or Ctrl-C stopped or resumed the CPU.
+    bool poll() {
+        bool was_stopped = stopped_;
+        for (int c = read_char_(); c >= 0; c = read_char_()) {
+            receive((uint8_t)c);
+        }
+        return was_stopped != stopped_;
+    }
+
+    // One step under debugger control; 0 cycles when stopped (or stopping at a breakpoint)
+    int step() {
+        if (stopped_) {
+            poll();
+            return 0;
+        }
+        if (skip_breakpoint_) {
+            skip_breakpoint_ = false;
+            update_active();
+        } else if (breakpoint_at(cpu_.reg.pc)) {
+            halt("T05swbreak:;");
+            return 0;
+        }
+
+        watch_hit_ = false;
+        int cycles = rewinder_ ? rewinder_->step() : cpu_.step();
+        if (watch_hit_) {
+            char reply[32];
+            snprintf(reply, sizeof(reply), "T05%s:%04x;", watch_hit_name(), watch_hit_addr_);
+            halt(reply);
+        } else if (single_step_ || cpu_.halted) {
+            halt("S05");
+        }
+        return cycles;
+    }
+
+    // Tell the debugger the CPU halted while it ran without the stub stepping it
+    void report_halt() {
+        if (!stopped_) halt("S05");
+    }
+
+    // Stop from the host side (e.g. at program start) without a pending request
+    void stop() {
+        stopped_ = true;
+        update_active();
+    }
+
+    // ---------- Breakpoints and watchpoints (also used by the packets) ----------
+
+    bool breakpoint_at(uint16_t pc) const {
+        return bp_page_count_[pc >> 8] && (bp_bits_[pc >> 3] & (1u << (pc & 7)));
+    }
+
+    void set_breakpoint(uint16_t addr) {
+        if (breakpoint_at(addr)) return;
+        bp_bits_[addr >> 3] |= (uint8_t)(1u << (addr & 7));
+        bp_page_count_[addr >> 8]++;
+        bp_total_++;
+        update_active();
+    }
+
+    void clear_breakpoint(uint16_t addr) {
+        if (!breakpoint_at(addr)) return;
+        bp_bits_[addr >> 3] &= (uint8_t)~(1u << (addr & 7));
+        bp_page_count_[addr >> 8]--;
+        bp_total_--;
+        update_active();
+    }
+
+    enum WatchType : uint8_t { WATCH_WRITE = 2, WATCH_READ = 3, WATCH_ACCESS = 4 };  // Z2/Z3/Z4
+
+    bool set_watchpoint(WatchType type, uint16_t addr, uint16_t len) {
+        if (num_watch_ == GDB_MAX_WATCHPOINTS || len == 0) return false;
+        watch_[num_watch_++] = {addr, len, type};
+        for (uint32_t a = addr; a < (uint32_t)addr + len; a += 256 - (a & 0xff)) watch_page_count_[(a >> 8) & 0xff]++;
+        install_watch_hooks();
+        update_active();
+        return true;
+    }
+
+    bool clear_watchpoint(WatchType type, uint16_t addr, uint16_t len) {
+        for (int i = 0; i < num_watch_; i++) {
+            if (watch_[i].addr == addr && watch_[i].len == len && watch_[i].type == type) {
+                for (uint32_t a = addr; a < (uint32_t)addr + len; a += 256 - (a & 0xff)) watch_page_count_[(a >> 8) & 0xff]--;
+                watch_[i] = watch_[--num_watch_];
+                install_watch_hooks();
+                update_active();
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Watch {
+        uint16_t addr;
+        uint16_t len;
+        WatchType type;
+    };
+
+    // ---------- Packet layer ----------
+
+    void receive(uint8_t c) {
+        switch (rx_state_) {
+            case RX_IDLE:
+                if (c == '$') {
+                    rx_len_ = 0;
+                    rx_sum_ = 0;
+                    rx_state_ = RX_BODY;
+                } else if (c == 0x03 && !stopped_) {
+                    halt("S02");  // Ctrl-C
+                } else if (c == '-' && !no_ack_) {
+                    send_raw(last_packet_);
+                }
+                break;
+            case RX_BODY:
+                if (c == '#') {
+                    rx_state_ = RX_SUM1;
+                } else if (rx_len_ < GDB_MAX_PACKET) {
+                    rx_buf_[rx_len_++] = (char)c;
+                    rx_sum_ += c;
+                }
+                break;
+            case RX_SUM1:
+                rx_check_ = (uint8_t)(hex_value(c) << 4);
+                rx_state_ = RX_SUM2;
+                break;
+            case RX_SUM2:
+                rx_state_ = RX_IDLE;
+                rx_check_ |= (uint8_t)hex_value(c);
+                if (!no_ack_) write_(rx_check_ == rx_sum_ ? "+" : "-", 1);
+                if (rx_check_ == rx_sum_) {
+                    rx_buf_[rx_len_] = 0;
+                    handle(rx_buf_, rx_len_);
+                }
+                break;
+        }
+    }
+
+    void send_raw(const std::string& packet) {
+        if (!packet.empty()) write_(packet.data(), packet.size());
+    }
+
+    void send(const char* body) {
+        uint8_t sum = 0;
+        for (const char* p = body; *p; p++) sum += (uint8_t)*p;
+        char tail[4];
+        snprintf(tail, sizeof(tail), "#%02x", sum);
+        last_packet_ = std::string("$") + body + tail;
+        send_raw(last_packet_);
+    }
+
+    void halt(const char* reply) {
+        stopped_ = true;
+        single_step_ = false;
+        last_stop_ = reply;
+        update_active();
+        send(reply);
+    }
+
+    void resume(bool single) {
+        stopped_ = false;
+        single_step_ = single;
+        skip_breakpoint_ = breakpoint_at(cpu_.reg.pc);  // step off the breakpoint we stopped at
+        update_active();
+    }
+
+    // Memory or registers changed under the rewinder: later history no longer applies
+    void state_edited() {
+        if (rewinder_) rewinder_->cut_future();
+    }
+
+    // ---------- Commands ----------
+
+    void handle(const char* p, size_t len) {
+        char reply[2 * GDB_MAX_READ + 8];
+        switch (p[0]) {
+            case '?':
+                send(last_stop_.c_str());
+                return;
+            case 'g': {
+                const uint8_t r[5] = {cpu_.reg.a, cpu_.reg.x, cpu_.reg.y, cpu_.reg.flag.value(), cpu_.reg.sp};
+                for (int i = 0; i < 5; i++) put_hex8(reply + 2 * i, r[i]);
+                put_hex8(reply + 10, cpu_.reg.pc & 0xff);
+                put_hex8(reply + 12, cpu_.reg.pc >> 8);
+                reply[14] = 0;
+                send(reply);
+                return;
+            }
+            case 'G':
+                if (len < 15) break;
+                for (int i = 0; i < 5; i++) set_register(i, parse_hex(p + 1 + 2 * i, 2));
+                set_register(5, parse_hex(p + 11, 2) | (parse_hex(p + 13, 2) << 8));
+                state_edited();
+                send("OK");
+                return;
+            case 'p': {
+                int n = (int)parse_hex(p + 1, len - 1);
+                if (n > 5) break;
+                uint16_t v = get_register(n);
+                put_hex8(reply, v & 0xff);
+                if (n == 5) put_hex8(reply + 2, v >> 8);
+                reply[n == 5 ? 4 : 2] = 0;
+                send(reply);
+                return;
+            }
+            case 'P': {
+                const char* eq = strchr(p, '=');
+                if (!eq) break;
+                int n = (int)parse_hex(p + 1, eq - p - 1);
+                if (n > 5) break;
+                uint32_t v = parse_hex(eq + 1, 2);
+                if (n == 5) v |= parse_hex(eq + 3, 2) << 8;
+                set_register(n, v);
+                state_edited();
+                send("OK");
+                return;
+            }
+            case 'm': {
+                uint32_t addr, count;
+                if (!parse_addr_len(p + 1, addr, count)) break;
+                if (count > GDB_MAX_READ) count = GDB_MAX_READ;  // a short read is allowed
+                for (uint32_t i = 0; i < count; i++) put_hex8(reply + 2 * i, mem_[(addr + i) & 0xffff]);
+                reply[2 * count] = 0;
+                send(reply);
+                return;
+            }
+            case 'M': {
+                uint32_t addr, count;
+                const char* data = strchr(p, ':');
+                if (!data || !parse_addr_len(p + 1, addr, count) || strlen(data + 1) < 2 * count) break;
+                // Through the memory function (not the watch hook), so device hooks see debugger writes
+                auto write = num_watch_ ? ram_write_ : cpu_.ram_write;
+                for (uint32_t i = 0; i < count; i++) {
+                    write((uint16_t)(addr + i), (uint8_t)parse_hex(data + 1 + 2 * i, 2));
+                }
+                state_edited();
+                send("OK");
+                return;
+            }
+            case 'c':
+            case 's':
+                if (len > 1) cpu_.reg.pc = (uint16_t)parse_hex(p + 1, len - 1);
+                resume(p[0] == 's');
+                return;
+            case 'b':
+                if (!rewinder_ || len != 2) break;
+                reverse(p[1] == 's');
+                return;
+            case 'Z':
+            case 'z':
+                if (breakpoint_packet(p[0] == 'Z', p + 1)) return;
+                break;
+            case 'H':
+                send("OK");
+                return;
+            case 'k':
+            case 'D':
+                // Detach or kill: clear everything and let the program run
+                memset(bp_page_count_, 0, sizeof(bp_page_count_));
+                memset(bp_bits_, 0, sizeof(bp_bits_));
+                bp_total_ = 0;
+                num_watch_ = 0;
+                memset(watch_page_count_, 0, sizeof(watch_page_count_));
+                install_watch_hooks();
+                if (p[0] == 'D') send("OK");
+                resume(false);
+                return;
+            case 'q':
+                if (query(p)) return;
+                break;
+            case 'Q':
+                if (!strcmp(p, "QStartNoAckMode")) {
+                    send("OK");
+                    no_ack_ = true;
+                    return;
+                }
+                break;
+            default:
+                break;
+        }
+        send("");  // unsupported
+    }
+
+    bool query(const char* p) {
+        if (!strncmp(p, "qSupported", 10)) {
+            char reply[160];
+            snprintf(reply, sizeof(reply),
+                     "PacketSize=%x;qXfer:features:read+;QStartNoAckMode+;swbreak+;hwbreak+%s",
+                     GDB_MAX_PACKET, rewinder_ ? ";ReverseStep+;ReverseContinue+" : "");
+            send(reply);
+            return true;
+        }
+        if (!strcmp(p, "qAttached")) { send("1"); return true; }
+        if (!strcmp(p, "qC")) { send("QC1"); return true; }
+        if (!strcmp(p, "qfThreadInfo")) { send("m1"); return true; }
+        if (!strcmp(p, "qsThreadInfo")) { send("l"); return true; }
+        if (!strncmp(p, "qXfer:features:read:target.xml:", 31)) {
+            static const char xml[] =
+                "<?xml version=\"1.0\"?><!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+                "<target version=\"1.0\"><feature name=\"org.pico6502.cpu\">"
+                "<reg name=\"a\" bitsize=\"8\" type=\"uint8\"/>"
+                "<reg name=\"x\" bitsize=\"8\" type=\"uint8\"/>"
+                "<reg name=\"y\" bitsize=\"8\" type=\"uint8\"/>"
+                "<reg name=\"p\" bitsize=\"8\" type=\"uint8\"/>"
+                "<reg name=\"sp\" bitsize=\"8\" type=\"uint8\"/>"
+                "<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\"/>"
+                "</feature></target>";
+            uint32_t offset, length;
+            if (!parse_addr_len(p + 31, offset, length)) return false;
+            size_t total = sizeof(xml) - 1;
+            if (offset > total) offset = (uint32_t)total;
+            size_t n = total - offset < length ? total - offset : length;
+            if (n > GDB_MAX_PACKET - 2) n = GDB_MAX_PACKET - 2;
+            std::string reply(1, offset + n < total ? 'm' : 'l');
+            reply.append(xml + offset, n);
+            send(reply.c_str());
+            return true;
+        }
+        return false;
+    }
+
+    bool breakpoint_packet(bool insert, const char* p) {
+        // type,addr,kind
+        int type = p[0] - '0';
+        uint32_t addr, len;
+        if (p[1] != ',' || !parse_addr_len(p + 2, addr, len)) return false;
+        if (type == 0 || type == 1) {
+            if (insert) set_breakpoint((uint16_t)addr); else clear_breakpoint((uint16_t)addr);
+            send("OK");
+            return true;
+        }
+        if (type >= WATCH_WRITE && type <= WATCH_ACCESS) {
+            bool ok = insert ? set_watchpoint((WatchType)type, (uint16_t)addr, (uint16_t)len)
+                             : clear_watchpoint((WatchType)type, (uint16_t)addr, (uint16_t)len);
+            send(ok ? "OK" : "E01");
+            return true;
+        }
+        return false;
+    }
+
+    // Reverse step (one instruction) or reverse continue (to the previous breakpoint)
+    void reverse(bool single) {
+        bool found;
+        if (single) {
+            found = rewinder_->step_back(1);
+        } else {
+            found = rewinder_->run_back([this](const Cpu& cpu) { return breakpoint_at(cpu.reg.pc); });
+        }
+        halt(found ? (single ? "S05" : "T05swbreak:;") : "T05replaylog:begin;");
+    }
+
+    uint16_t get_register(int n) const {
+        switch (n) {
+            case 0: return cpu_.reg.a;
+            case 1: return cpu_.reg.x;
+            case 2: return cpu_.reg.y;
+            case 3: return cpu_.reg.flag.value();
+            case 4: return cpu_.reg.sp;
+            default: return cpu_.reg.pc;
+        }
+    }
+
+    void set_register(int n, uint32_t v) {
+        switch (n) {
+            case 0: cpu_.reg.a = (uint8_t)v; break;
+            case 1: cpu_.reg.x = (uint8_t)v; break;
+            case 2: cpu_.reg.y = (uint8_t)v; break;
+            case 3: cpu_.reg.flag.set_value((uint8_t)v); break;
+            case 4: cpu_.reg.sp = (uint8_t)v; break;
+            default: cpu_.reg.pc = (uint16_t)v; break;
+        }
+    }
+
+    // ---------- Watchpoint memory hooks ----------
+
+    // Swap the CPU memory functions for checking ones while any watchpoint is set
+    void install_watch_hooks() {
+        if (num_watch_ && cpu_.ram_read != &watch_read) {
+            ram_read_ = cpu_.ram_read;
+            ram_write_ = cpu_.ram_write;
+            cpu_.ram_read = &watch_read;
+            cpu_.ram_write = &watch_write;
+        } else if (!num_watch_ && cpu_.ram_read == &watch_read) {
+            cpu_.ram_read = ram_read_;
+            cpu_.ram_write = ram_write_;
+        }
+    }
+
+    void check_watch(uint16_t addr, bool write) {
+        if (!watch_page_count_[addr >> 8] || watch_hit_) return;
+        for (int i = 0; i < num_watch_; i++) {
+            const Watch& w = watch_[i];
+            if ((uint16_t)(addr - w.addr) >= w.len) continue;
+            if ((w.type == WATCH_WRITE && !write) || (w.type == WATCH_READ && write)) continue;
+            watch_hit_ = true;
+            watch_hit_addr_ = addr;
+            watch_hit_type_ = w.type;
+            return;
+        }
+    }
+
+    static uint8_t watch_read(uint16_t addr) {
+        instance_->check_watch(addr, false);
+        return instance_->ram_read_(addr);
+    }
+
+    static void watch_write(uint16_t addr, uint8_t val) {
+        instance_->check_watch(addr, true);
+        instance_->ram_write_(addr, val);
+    }
+
+    const char* watch_hit_name() const {
+        return watch_hit_type_ == WATCH_WRITE ? "watch" : (watch_hit_type_ == WATCH_READ ? "rwatch" : "awatch");
+    }
+
+    void update_active() {
+        active_ = stopped_ || single_step_ || skip_breakpoint_ || bp_total_ || num_watch_;
+    }
+
+    // ---------- Hex helpers ----------
+
+    static int hex_value(uint8_t c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return 0;
+    }
+
+    static uint32_t parse_hex(const char* p, size_t max) {
+        uint32_t v = 0;
+        for (size_t i = 0; i < max && isxdigit((unsigned char)p[i]); i++) v = (v << 4) | hex_value((uint8_t)p[i]);
+        return v;
+    }
+
+    static bool parse_addr_len(const char* p, uint32_t& addr, uint32_t& len) {
+        char* end;
+        addr = (uint32_t)strtoul(p, &end, 16);
+        if (*end != ',') return false;
+        len = (uint32_t)strtoul(end + 1, nullptr, 16);
+        return true;
+    }
+
+    static void put_hex8(char* out, uint8_t v) {
+        static const char digits[] = "0123456789abcdef";
+        out[0] = digits[v >> 4];
+        out[1] = digits[v & 0xf];
+    }
+
+    enum RxState : uint8_t { RX_IDLE, RX_BODY, RX_SUM1, RX_SUM2 };
+
+    Cpu& cpu_;
+    uint8_t* mem_;
+    ReadChar read_char_;
+    Write write_;
+    Rewinder<Cpu>* rewinder_ = nullptr;
+
+    // CPU memory functions while the watch hooks are installed
+    uint8_t (*ram_read_)(uint16_t) = nullptr;
+    void (*ram_write_)(uint16_t, uint8_t) = nullptr;
+
+    bool stopped_;
+    bool active_ = false;
+    bool single_step_ = false;
+    bool skip_breakpoint_ = false;
+    bool no_ack_ = false;
+    std::string last_stop_ = "S05";
+    std::string last_packet_;
+
+    RxState rx_state_ = RX_IDLE;
+    char rx_buf_[GDB_MAX_PACKET + 1];
+    size_t rx_len_ = 0;
+    uint8_t rx_sum_ = 0;
+    uint8_t rx_check_ = 0;
+
+    uint16_t bp_page_count_[256] = {};  // breakpoints per page: skip the bitmap for empty pages
+    uint8_t bp_bits_[0x10000 / 8] = {};
+    uint32_t bp_total_ = 0;
+
+    Watch watch_[GDB_MAX_WATCHPOINTS];
+    int num_watch_ = 0;
+    uint8_t watch_page_count_[256] = {};
+    bool watch_hit_ = false;
+    uint16_t watch_hit_addr_ = 0;
+    WatchType watch_hit_type_ = WATCH_WRITE;
+
+    static inline GdbStub* instance_{};  // for the watch hooks (plain function pointers)
+};
@@ -0,0 +1,87 @@
+/*
+ * Dirty rectangle tracker for partial display refresh
+ *
+ * Collects damaged areas as up to DIRTY_RECTS_MAX inclusive rectangles. A new
+ * rectangle is merged with an existing one when their bounding box costs at
+ * most merge_cost pixels more than the two separately (overlapping or
+ * edge-adjacent rectangles always merge); when every slot is taken it is merged
+ * with the cheapest one regardless. Units are whatever the caller draws in,
+ * e.g. source framebuffer pixels for the emulator blits.
+ */
+
+#ifndef _DIRTY_RECTS_H
+#define _DIRTY_RECTS_H
+
+#include <stdint.h>
+
+#define DIRTY_RECTS_MAX 8
+
+typedef struct {
+    int16_t x0, y0, x1, y1;  /* inclusive */
+} dirty_rect_t;
+
+typedef struct {
+    dirty_rect_t rect[DIRTY_RECTS_MAX];
+    uint8_t count;
+    uint32_t merge_cost;  /* extra pixels a merge may cover and still be taken */
+} dirty_rects_t;
+
+static inline uint32_t dirty_rect_area(const dirty_rect_t *r) {
+    return (uint32_t)(r->x1 - r->x0 + 1) * (uint32_t)(r->y1 - r->y0 + 1);
+}
+
+static inline dirty_rect_t dirty_rect_union(const dirty_rect_t *a, const dirty_rect_t *b) {
+    dirty_rect_t u = {
+        a->x0 < b->x0 ? a->x0 : b->x0, a->y0 < b->y0 ? a->y0 : b->y0,
+        a->x1 > b->x1 ? a->x1 : b->x1, a->y1 > b->y1 ? a->y1 : b->y1,
+    };
+    return u;
+}
+
+static inline void dirty_rects_init(dirty_rects_t *d, uint32_t merge_cost) {
+    d->count = 0;
+    d->merge_cost = merge_cost;
+}
+
+static inline void dirty_rects_clear(dirty_rects_t *d) {
+    d->count = 0;
+}
+
+/* Pixels the rectangles cover (overlaps counted twice) */
+static inline uint32_t dirty_rects_area(const dirty_rects_t *d) {
+    uint32_t area = 0;
+    for (uint8_t i = 0; i < d->count; i++) area += dirty_rect_area(&d->rect[i]);
+    return area;
+}
+
+/* Add a damaged rectangle (inclusive corners, x0 <= x1 and y0 <= y1) */
+static inline void dirty_rects_add(dirty_rects_t *d, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    dirty_rect_t r = {x0, y0, x1, y1};
+
+    /* Already covered: the common case for a program redrawing one area */
+    for (uint8_t i = 0; i < d->count; i++) {
+        const dirty_rect_t *e = &d->rect[i];
+        if (x0 >= e->x0 && x1 <= e->x1 && y0 >= e->y0 && y1 <= e->y1) return;
+    }
+
+    /* Absorb neighbours while it pays; a merged rectangle may reach further ones */
+    for (;;) {
+        int best = -1;
+        int64_t best_cost = 0;
+        for (uint8_t i = 0; i < d->count; i++) {
+            dirty_rect_t u = dirty_rect_union(&r, &d->rect[i]);
+            int64_t cost = (int64_t)dirty_rect_area(&u) - dirty_rect_area(&r) - dirty_rect_area(&d->rect[i]);
+            if (best < 0 || cost < best_cost) {
+                best = i;
+                best_cost = cost;
+            }
+        }
+        if (best < 0 || (best_cost > (int64_t)d->merge_cost && d->count < DIRTY_RECTS_MAX)) break;
+
+        r = dirty_rect_union(&r, &d->rect[best]);
+        d->rect[best] = d->rect[--d->count];
+    }
+    d->rect[d->count++] = r;
+}
+
+#endif /* _DIRTY_RECTS_H */
@@ -0,0 +1,99 @@
+/*
+ * Palette for the buffered display's 8-bit frames
+ *
+ * A colour takes an entry when it is first drawn; once all 256 are in use, new
+ * colours draw as the nearest existing entry. frame_palette_release() frees
+ * the entries no pixel of a frame still uses, so after a clear new colours get
+ * exact entries again. Entries still in use keep their index, so the frame
+ * needs no rewriting.
+ */
+
+#ifndef _FRAME_PALETTE_H
+#define _FRAME_PALETTE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Colour of a freed entry: no RGB888 colour matches it */
+#define FRAME_PALETTE_FREE 0xFFFFFFFFu
+
+typedef struct {
+    uint32_t color[256];
+    uint16_t used;        /* entries handed out, freed ones below it included */
+    uint16_t free_count;
+    uint8_t free[256];    /* freed entries below used */
+    uint32_t last_color;  /* drawing calls plot many pixels of one colour */
+    uint8_t last_index;
+} frame_palette_t;
+
+/* Frames start zeroed, so entry 0 is black */
+static inline void frame_palette_init(frame_palette_t *p) {
+    p->color[0] = 0;
+    p->used = 1;
+    p->free_count = 0;
+    p->last_color = 0;
+    p->last_index = 0;
+}
+
+static inline uint8_t frame_palette_index(frame_palette_t *p, uint32_t color) {
+    if (color == p->last_color) return p->last_index;
+
+    uint16_t index = p->used;
+    for (uint16_t i = 0; i < p->used; i++) {
+        if (p->color[i] == color) {
+            index = i;
+            break;
+        }
+    }
+    if (index == p->used) {
+        if (p->free_count > 0) {
+            index = p->free[--p->free_count];
+            p->color[index] = color;
+        } else if (p->used < 256) {
+            p->color[p->used++] = color;
+        } else {
+            /* Only reached with every entry taken, so none is FRAME_PALETTE_FREE */
+            uint32_t best = UINT32_MAX;
+            for (uint16_t i = 0; i < 256; i++) {
+                int32_t dr = (int32_t)((color >> 16) & 0xFF) - (int32_t)((p->color[i] >> 16) & 0xFF);
+                int32_t dg = (int32_t)((color >> 8) & 0xFF) - (int32_t)((p->color[i] >> 8) & 0xFF);
+                int32_t db = (int32_t)(color & 0xFF) - (int32_t)(p->color[i] & 0xFF);
+                uint32_t dist = (uint32_t)(dr * dr + dg * dg + db * db);
+                if (dist < best) {
+                    best = dist;
+                    index = i;
+                }
+            }
+        }
+    }
+    p->last_color = color;
+    p->last_index = (uint8_t)index;
+    return p->last_index;
+}
+
+/* Free the entries none of the count pixels (palette indices) uses */
+static inline void frame_palette_release(frame_palette_t *p, const uint8_t *pixels, size_t count) {
+    uint8_t live[256];
+    memset(live, 0, sizeof(live));
+    for (size_t i = 0; i < count; i++) live[pixels[i]] = 1;
+
+    uint16_t used = 0;
+    for (uint16_t i = 0; i < p->used; i++) {
+        if (live[i]) used = i + 1;
+    }
+    if (used == 0) used = 1;  /* keep entry 0 so the list is never empty */
+
+    p->free_count = 0;
+    for (uint16_t i = 0; i < used; i++) {
+        if (!live[i] && i != 0) {
+            p->color[i] = FRAME_PALETTE_FREE;
+            p->free[p->free_count++] = (uint8_t)i;
+        }
+    }
+    p->used = used;
+    p->last_color = p->color[0];
+    p->last_index = 0;
+}
+
+#endif /* _FRAME_PALETTE_H */
@@ -45,9 +45,19 @@ extern "C" {
 
 #define BITMAP_SIZE(width, height, depth) (width * (depth / 8) * height)
 
+/*
+Run of opaque pixels in a bitmap row: first column and width.
+*/
+typedef struct {
+    uint16_t x0;
+    uint16_t width;
+} hagl_span_t;
+
 /*
 Pitch is bytes per row. Depth is number of bits per pixel. Size is size
-in bytes.
+in bytes. Spans is an optional table of opaque runs for transparent blits,
+row y owning spans[span_rows[y]] up to spans[span_rows[y + 1]]; NULL when
+not built.
 */
 typedef struct {
     uint16_t width;
@@ -65,11 +75,24 @@ typedef struct {
     uint16_t pitch;
     uint32_t size;
     uint8_t *buffer;
+    hagl_span_t *spans;
+    uint32_t *span_rows;
 } hagl_bitmap_t;
 
 void
 hagl_bitmap_init(hagl_bitmap_t *bitmap, int16_t width, uint16_t height, uint8_t depth, void *buffer);
 
+/*
+Build the span table of a bitmap: runs of pixels other than the transparent
+color. A HAL blit given a table draws exactly those runs. Rebuild it after
+changing the pixels. Returns the number of runs, or -1 if out of memory.
+*/
+int32_t
+hagl_bitmap_build_spans(hagl_bitmap_t *bitmap, hagl_color_t transparent);
+
+void
+hagl_bitmap_free_spans(hagl_bitmap_t *bitmap);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -44,6 +44,8 @@ SPDX-License-Identifier: MIT
 extern "C" {
 #endif /* __cplusplus */
 
+#define HAGL_POLYGON_MAX_VERTICES 64
+
 /**
  * Draw a polygon
  *
@@ -80,6 +82,22 @@ hagl_draw_polygon(void const *surface, int16_t amount, int16_t *vertices, hagl_c
 void
 hagl_fill_polygon(void const *surface, int16_t amount, int16_t *vertices, hagl_color_t color);
 
+/**
+ * Draw a filled polygon with floating point edges
+ *
+ * The previous implementation of hagl_fill_polygon(), kept to compare
+ * against. hagl_fill_polygon() walks edges in integers and draws a
+ * triangle as one span per scanline; polygons of more than
+ * HAGL_POLYGON_MAX_VERTICES vertices fall back to this version.
+ *
+ * @param surface
+ * @param amount number of vertices
+ * @param vertices pointer to (an array) of vertices
+ * @param color
+ */
+void
+hagl_fill_polygon_float(void const *surface, int16_t amount, int16_t *vertices, hagl_color_t color);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -247,4 +247,66 @@ hagl_bitmap_init(hagl_bitmap_t *bitmap, int16_t width, uint16_t height, uint8_t
     bitmap->vline = vline;
     bitmap->blit = blit;
     bitmap->scale_blit = scale_blit;
+
+    bitmap->spans = NULL;
+    bitmap->span_rows = NULL;
+}
+
+/* Build the table of opaque runs used by transparent blits. */
+int32_t
+hagl_bitmap_build_spans(hagl_bitmap_t *bitmap, hagl_color_t transparent)
+{
+    hagl_color_t *ptr = (hagl_color_t *) bitmap->buffer;
+    uint32_t count = 0;
+
+    hagl_bitmap_free_spans(bitmap);
+
+    /* First pass counts the runs so the table is allocated once. */
+    for (uint16_t y = 0; y < bitmap->height; y++) {
+        hagl_color_t *row = ptr + y * bitmap->width;
+        for (uint16_t x = 0; x < bitmap->width; x++) {
+            if (row[x] != transparent && (0 == x || row[x - 1] == transparent)) {
+                count++;
+            }
+        }
+    }
+
+    bitmap->span_rows = calloc(bitmap->height + 1, sizeof(uint32_t));
+    bitmap->spans = calloc(count ? count : 1, sizeof(hagl_span_t));
+    if (NULL == bitmap->span_rows || NULL == bitmap->spans) {
+        hagl_bitmap_free_spans(bitmap);
+        return -1;
+    }
+
+    count = 0;
+    for (uint16_t y = 0; y < bitmap->height; y++) {
+        hagl_color_t *row = ptr + y * bitmap->width;
+        bitmap->span_rows[y] = count;
+        uint16_t x = 0;
+        while (x < bitmap->width) {
+            if (row[x] == transparent) {
+                x++;
+                continue;
+            }
+            uint16_t x0 = x;
+            while (x < bitmap->width && row[x] != transparent) {
+                x++;
+            }
+            bitmap->spans[count].x0 = x0;
+            bitmap->spans[count].width = x - x0;
+            count++;
+        }
+    }
+    bitmap->span_rows[bitmap->height] = count;
+
+    return count;
+}
+
+void
+hagl_bitmap_free_spans(hagl_bitmap_t *bitmap)
+{
+    free(bitmap->spans);
+    free(bitmap->span_rows);
+    bitmap->spans = NULL;
+    bitmap->span_rows = NULL;
 }
\ No newline at end of file
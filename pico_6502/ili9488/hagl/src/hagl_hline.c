@@ -51,7 +51,7 @@ hagl_draw_hline_xyw(void const *_surface, int16_t x0, int16_t y0, uint16_t w, ha
 
         /* x0 is left of clip window, ignore start part. */
         if (x0 < surface->clip.x0) {
-            width = width + x0;
+            width = width - (surface->clip.x0 - x0);
             x0 = surface->clip.x0;
         }
 
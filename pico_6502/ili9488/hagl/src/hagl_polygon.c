@@ -38,6 +38,7 @@ SPDX-License-Identifier: MIT
 #include "hagl/surface.h"
 #include "hagl/line.h"
 #include "hagl/hline.h"
+#include "hagl/polygon.h"
 
 void
 hagl_draw_polygon(void const *surface, int16_t amount, int16_t *vertices, hagl_color_t color)
@@ -63,9 +64,236 @@ hagl_draw_polygon(void const *surface, int16_t amount, int16_t *vertices, hagl_c
     );
 }
 
-/* Adapted from  http://alienryderflex.com/polygon_fill/ */
+/*
+Polygon edge walked one scanline at a time in integers. The edge runs
+from (x0, y0) down to (x1, y1) and x on scanline y is
+x0 + floor((y - y0) * (x1 - x0) / (y1 - y0)), kept as whole pixels plus
+a remainder over dy so no error accumulates.
+*/
+typedef struct {
+    int16_t x;
+    int16_t y_end;
+    int32_t step;
+    int32_t rem;
+    int32_t err;
+    int32_t dy;
+} edge_t;
+
+static inline int32_t
+floor_div(int64_t a, int32_t b)
+{
+    int64_t q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) {
+        q--;
+    }
+    return (int32_t) q;
+}
+
+/* Edge with y0 < y1, positioned on scanline y (y0 < y <= y1). */
+static void
+edge_init(edge_t *e, int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t y)
+{
+    int32_t dx = x1 - x0;
+    int64_t num = (int64_t)(y - y0) * dx;
+    int32_t q = floor_div(num, y1 - y0);
+
+    e->dy = y1 - y0;
+    e->step = floor_div(dx, e->dy);
+    e->rem = dx - e->step * e->dy;
+    e->x = x0 + q;
+    e->err = (int32_t)(num - (int64_t)q * e->dy);
+    e->y_end = y1;
+}
+
+static inline void
+edge_step(edge_t *e)
+{
+    e->x += e->step;
+    e->err += e->rem;
+    if (e->err >= e->dy) {
+        e->x++;
+        e->err -= e->dy;
+    }
+}
+
+/* Span between two x in either order. */
+static void
+span(void const *surface, int16_t xa, int16_t xb, int16_t y, hagl_color_t color)
+{
+    if (xa > xb) {
+        int16_t swap = xa;
+        xa = xb;
+        xb = swap;
+    }
+    hagl_draw_hline(surface, xa, y, xb - xa + 1, color);
+}
+
+/* Triangle: two edges at a time, one span per scanline. */
+static void
+fill_triangle(const hagl_surface_t *surface, int16_t *v, hagl_color_t color)
+{
+    int16_t x0 = v[0], y0 = v[1], x1 = v[2], y1 = v[3], x2 = v[4], y2 = v[5];
+    int16_t swap;
+    edge_t lng, sht;
+
+    /* Sort by y so (x0, y0) is the top and (x2, y2) the bottom. */
+    if (y0 > y1) {
+        swap = x0; x0 = x1; x1 = swap;
+        swap = y0; y0 = y1; y1 = swap;
+    }
+    if (y1 > y2) {
+        swap = x1; x1 = x2; x2 = swap;
+        swap = y1; y1 = y2; y2 = swap;
+    }
+    if (y0 > y1) {
+        swap = x0; x0 = x1; x1 = swap;
+        swap = y0; y0 = y1; y1 = swap;
+    }
+
+    if (y0 == y2) {
+        int16_t xmin = x0 < x1 ? x0 : x1;
+        int16_t xmax = x0 > x1 ? x0 : x1;
+        span(surface, xmin < x2 ? xmin : x2, xmax > x2 ? xmax : x2, y0, color);
+        return;
+    }
+    if (y0 == y1) {
+        span(surface, x0, x1, y0, color);
+    }
+    if (y1 == y2) {
+        span(surface, x1, x2, y1, color);
+    }
+
+    int16_t y = y0 + 1 > surface->clip.y0 ? y0 + 1 : surface->clip.y0;
+    int16_t y_last = y2 < surface->clip.y1 ? y2 : surface->clip.y1;
+    if (y > y_last) {
+        return;
+    }
+
+    edge_init(&lng, x0, y0, x2, y2, y);
+    if (y <= y1) {
+        edge_init(&sht, x0, y0, x1, y1, y);
+    } else {
+        edge_init(&sht, x1, y1, x2, y2, y);
+    }
+
+    for (; y <= y_last; y++) {
+        if (y == y1 + 1) {
+            edge_init(&sht, x1, y1, x2, y2, y);
+        }
+        span(surface, lng.x, sht.x, y, color);
+        edge_step(&lng);
+        edge_step(&sht);
+    }
+}
+
+/*
+Scanline fill with an edge table sorted by first scanline and an active
+edge list. Covers the same scanlines as the floating point version: those
+strictly below the top and down to the bottom, plus horizontal edges.
+*/
 void
 hagl_fill_polygon(void const *_surface, int16_t amount, int16_t *vertices, hagl_color_t color)
+{
+    const hagl_surface_t *surface = _surface;
+    edge_t edges[HAGL_POLYGON_MAX_VERTICES];
+    int16_t first[HAGL_POLYGON_MAX_VERTICES];
+    uint8_t order[HAGL_POLYGON_MAX_VERTICES];
+    uint8_t active[HAGL_POLYGON_MAX_VERTICES];
+    uint8_t count = 0;
+    uint8_t next = 0;
+    uint8_t live = 0;
+
+    if (amount < 3) {
+        hagl_fill_polygon_float(surface, amount, vertices, color);
+        return;
+    }
+    if (3 == amount) {
+        fill_triangle(surface, vertices, color);
+        return;
+    }
+    if (amount > HAGL_POLYGON_MAX_VERTICES) {
+        hagl_fill_polygon_float(surface, amount, vertices, color);
+        return;
+    }
+
+    int16_t miny = vertices[1];
+    int16_t maxy = vertices[1];
+    for (int16_t i = 1; i < amount; i++) {
+        int16_t vy = vertices[(i << 1) + 1];
+        miny = vy < miny ? vy : miny;
+        maxy = vy > maxy ? vy : maxy;
+    }
+    int16_t y_first = miny + 1 > surface->clip.y0 ? miny + 1 : surface->clip.y0;
+    int16_t y_last = maxy < surface->clip.y1 ? maxy : surface->clip.y1;
+
+    /* Build the edge table, drawing horizontal edges on the way. */
+    for (int16_t i = 0, j = amount - 1; i < amount; j = i++) {
+        int16_t xa = vertices[(i << 1) + 0];
+        int16_t ya = vertices[(i << 1) + 1];
+        int16_t xb = vertices[(j << 1) + 0];
+        int16_t yb = vertices[(j << 1) + 1];
+
+        if (ya == yb) {
+            span(surface, xa, xb, ya, color);
+            continue;
+        }
+        if (ya > yb) {
+            int16_t swap = xa; xa = xb; xb = swap;
+            swap = ya; ya = yb; yb = swap;
+        }
+        if (yb < y_first || ya >= y_last) {
+            continue;
+        }
+
+        int16_t y = ya + 1 > y_first ? ya + 1 : y_first;
+        edge_init(&edges[count], xa, ya, xb, yb, y);
+        first[count] = y;
+
+        /* Insertion sort by first scanline. */
+        uint8_t k = count;
+        while (k > 0 && first[order[k - 1]] > y) {
+            order[k] = order[k - 1];
+            k--;
+        }
+        order[k] = count;
+        count++;
+    }
+
+    for (int16_t y = y_first; y <= y_last; y++) {
+        /* Edges starting on this scanline become active. */
+        while (next < count && first[order[next]] == y) {
+            active[live++] = order[next++];
+        }
+
+        /* Edges that ended drop out; the rest stay nearly sorted by x. */
+        uint8_t kept = 0;
+        for (uint8_t i = 0; i < live; i++) {
+            uint8_t e = active[i];
+            if (edges[e].y_end < y) {
+                continue;
+            }
+            uint8_t k = kept++;
+            while (k > 0 && edges[active[k - 1]].x > edges[e].x) {
+                active[k] = active[k - 1];
+                k--;
+            }
+            active[k] = e;
+        }
+        live = kept;
+
+        for (uint8_t i = 0; i + 1 < live; i += 2) {
+            span(surface, edges[active[i]].x, edges[active[i + 1]].x, y, color);
+        }
+        for (uint8_t i = 0; i < live; i++) {
+            edge_step(&edges[active[i]]);
+        }
+    }
+}
+
+/* Previous floating point version, kept for comparison. */
+/* Adapted from  http://alienryderflex.com/polygon_fill/ */
+void
+hagl_fill_polygon_float(void const *_surface, int16_t amount, int16_t *vertices, hagl_color_t color)
 {
     const hagl_surface_t *surface = _surface;
     int16_t nodes[64];
@@ -51,7 +51,7 @@ hagl_draw_vline_xyh(void const *_surface, int16_t x0, int16_t y0, uint16_t h, ha
 
         /* y0 is top of clip window, ignore start part. */
         if (y0 < surface->clip.y0) {
-            height = height + y0;
+            height = height - (surface->clip.y0 - y0);
             y0 = surface->clip.y0;
         }
 
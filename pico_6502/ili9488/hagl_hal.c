@@ -6,9 +6,34 @@
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
 #include "hardware/dma.h"
+#include "hardware/sync.h"
 #include "hagl_hal.h"
 #include "hagl.h"
 #include "hagl/bitmap.h"
+#include "fontx.h"
+
+/*
+ * Transport: SPI1 with CS and DC driven by the CPU, or with HAGL_HAL_PIO a PIO
+ * state machine that takes command/data framing from the stream itself
+ * (ili9488_spi.pio), at up to half the system clock
+ */
+#ifndef HAGL_HAL_PIO
+#define HAGL_HAL_PIO 0
+#endif
+
+#if HAGL_HAL_BUFFERED
+#include "hardware/irq.h"
+#include "frame_palette.h"
+#endif
+
+#if HAGL_HAL_PIO
+#include "hardware/pio.h"
+#include "ili9488_spi.pio.h"
+
+#ifndef HAGL_HAL_PIO_HZ
+#define HAGL_HAL_PIO_HZ 50000000
+#endif
+#endif
 
 /* Pin definitions */
 #define SPI_INST   spi1
@@ -19,8 +44,74 @@
 #define PIN_RST    15  // header pin 29
 #define PIN_BL     12  // header pin 21
 
+static void fill_finish(void);
+static void blit_spans(int16_t x0, int16_t y0, const hagl_bitmap_t *bitmap);
+#if HAGL_HAL_BUFFERED
+static void buffer_fill(int16_t x1, int16_t y1, int16_t x2, int16_t y2, hagl_color_t color);
+static size_t buffer_flush(void);
+static void buffer_palette_release(void);
+#endif
+
+#if HAGL_HAL_PIO
+
+/*
+ * PIO packets: a header word (DC, RGB565 flag, payload bits - 1) and the
+ * payload MSB first, padded to a word. The CPU pushes words as values; packets
+ * DMA'd from memory are stored in wire byte order and read with byte swapping.
+ */
+#define PIO_DATA    (1u << 31)
+#define PIO_RGB565  (1u << 30)
+
+static PIO display_pio = pio0;
+static uint display_sm;
+
+static inline void pio_put(uint32_t word) {
+    pio_sm_put_blocking(display_pio, display_sm, word);
+}
+
+static void ili9488_send_cmd(uint8_t cmd) {
+    fill_finish();  /* a solid fill may still be feeding the FIFO */
+    pio_put(7);
+    pio_put((uint32_t)cmd << 24);
+}
+
+static void ili9488_send_data(uint8_t *data, size_t len) {
+    pio_put(PIO_DATA | (uint32_t)(len * 8 - 1));
+    for (size_t i = 0; i < len; i += 4) {
+        uint32_t word = 0;
+        for (size_t j = i; j < i + 4; j++) word = (word << 8) | (j < len ? data[j] : 0);
+        pio_put(word);
+    }
+}
+
+// CASET, RASET and RAMWR as packet words
+#define WINDOW_WORDS 10
+
+static void window_packets(uint32_t *w, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+    w[0] = 7;
+    w[1] = 0x2Au << 24;
+    w[2] = PIO_DATA | 31;
+    w[3] = ((uint32_t)x1 << 16) | x2;
+    w[4] = 7;
+    w[5] = 0x2Bu << 24;
+    w[6] = PIO_DATA | 31;
+    w[7] = ((uint32_t)y1 << 16) | y2;
+    w[8] = 7;
+    w[9] = 0x2Cu << 24;
+}
+
+static void set_addr_window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+    uint32_t w[WINDOW_WORDS];
+    fill_finish();
+    window_packets(w, x1, y1, x2, y2);
+    for (int i = 0; i < WINDOW_WORDS; i++) pio_put(w[i]);
+}
+
+#else
+
 /* Low-level SPI functions */
 static void ili9488_send_cmd(uint8_t cmd) {
+    fill_finish();  /* a solid fill may still be streaming */
     gpio_put(PIN_CS, 0);
     gpio_put(PIN_DC, 0);
     spi_write_blocking(SPI_INST, &cmd, 1);
@@ -48,10 +139,112 @@ static void set_addr_window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
     ili9488_send_cmd(0x2C);
 }
 
-/* HAL function: put a single pixel */
-static void hal_put_pixel(void *self, int16_t x, int16_t y, hagl_color_t color) {
-    if (x < 0 || x >= DISPLAY_WIDTH || y < 0 || y >= DISPLAY_HEIGHT) return;
+#endif
+
+#if HAGL_HAL_PIO
+
+/*
+ * Solid fills by DMA
+ * The PIO expands RGB565, so a fill is one RGB565 packet whose payload is a
+ * single word (the pixel twice) read over and over. Colours are rounded to
+ * RGB565. It returns as soon as the DMA starts; the next command waits for it.
+ */
+static uint32_t fill_word;
+static int fill_chan = -1;
+static dma_channel_config fill_cfg;
+static bool fill_pending = false;
 
+static void fill_finish(void) {
+    if (!fill_pending) return;
+    dma_channel_wait_for_finish_blocking(fill_chan);
+    fill_pending = false;
+}
+
+// Start filling the window (x1, y1)-(x2, y2) with one color; coordinates already clipped
+static void fill_window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, hagl_color_t color) {
+    if (fill_chan < 0) {
+        fill_chan = dma_claim_unused_channel(true);
+        fill_cfg = dma_channel_get_default_config(fill_chan);
+        channel_config_set_transfer_data_size(&fill_cfg, DMA_SIZE_32);
+        channel_config_set_dreq(&fill_cfg, pio_get_dreq(display_pio, display_sm, true));
+        channel_config_set_read_increment(&fill_cfg, false);
+        channel_config_set_write_increment(&fill_cfg, false);
+    }
+
+    set_addr_window(x1, y1, x2, y2);  // also finishes the previous fill
+
+    uint32_t rgb565 = ((color >> 8) & 0xF800) | ((color >> 5) & 0x07E0) | ((color >> 3) & 0x001F);
+    fill_word = (rgb565 << 16) | rgb565;
+
+    uint32_t pixels = (uint32_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+    pio_put(PIO_DATA | PIO_RGB565 | (pixels - 1));
+    dma_channel_configure(fill_chan, &fill_cfg,
+                          &display_pio->txf[display_sm],  // Write to PIO TX FIFO
+                          &fill_word,                     // Same word every time
+                          (pixels + 1) / 2,               // Two pixels per word
+                          true);                          // Start immediately
+    fill_pending = true;
+}
+
+#else
+
+/*
+ * Solid fills by DMA
+ * An RGB666 pixel is 3 bytes, which no power-of-two DMA ring can repeat, but
+ * it is exactly two 12-bit SPI frames. During a fill the SPI switches to
+ * 12-bit frames and one DMA transfer ring-reads a 2-halfword pattern for the
+ * whole window, so the fill runs at the full SPI rate. It returns as soon as
+ * the DMA starts; the next command waits for it and restores 8-bit frames.
+ */
+static uint16_t fill_pattern[2] __attribute__((aligned(4)));
+static int fill_chan = -1;
+static dma_channel_config fill_cfg;
+static bool fill_pending = false;
+
+static void fill_finish(void) {
+    if (!fill_pending) return;
+    dma_channel_wait_for_finish_blocking(fill_chan);
+    while (spi_is_busy(SPI_INST)) {
+        tight_loop_contents();
+    }
+    gpio_put(PIN_CS, 1);
+    spi_set_format(SPI_INST, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    fill_pending = false;
+}
+
+// Start filling the window (x1, y1)-(x2, y2) with one color; coordinates already clipped
+static void fill_window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, hagl_color_t color) {
+    if (fill_chan < 0) {
+        fill_chan = dma_claim_unused_channel(true);
+        fill_cfg = dma_channel_get_default_config(fill_chan);
+        channel_config_set_transfer_data_size(&fill_cfg, DMA_SIZE_16);
+        channel_config_set_dreq(&fill_cfg, spi_get_dreq(SPI_INST, true));
+        channel_config_set_read_increment(&fill_cfg, true);
+        channel_config_set_ring(&fill_cfg, false, 2);  // wrap reads every 4 bytes
+        channel_config_set_write_increment(&fill_cfg, false);
+    }
+
+    set_addr_window(x1, y1, x2, y2);  // also finishes the previous fill
+
+    fill_pattern[0] = (color >> 12) & 0x0FFF;  // R, high half of G
+    fill_pattern[1] = color & 0x0FFF;          // low half of G, B
+
+    spi_set_format(SPI_INST, 12, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    gpio_put(PIN_CS, 0);
+    gpio_put(PIN_DC, 1);
+    uint32_t pixels = (uint32_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+    dma_channel_configure(fill_chan, &fill_cfg,
+                          &spi_get_hw(SPI_INST)->dr,  // Write to SPI TX FIFO
+                          fill_pattern,               // Pattern, ring addressed
+                          pixels * 2,                 // Two frames per pixel
+                          true);                      // Start immediately
+    fill_pending = true;
+}
+
+#endif
+
+/* One pixel in its own address window */
+static void write_pixel(int16_t x, int16_t y, hagl_color_t color) {
     set_addr_window(x, y, x, y);
 
     uint8_t rgb[3] = {
@@ -62,6 +255,94 @@ static void hal_put_pixel(void *self, int16_t x, int16_t y, hagl_color_t color)
     ili9488_send_data(rgb, 3);
 }
 
+/*
+ * Pixel coalescing
+ * Lines and circles plot pixels one at a time, and each costs a full
+ * CASET/RASET/RAMWR sequence. put_pixel instead grows up to PIXEL_RUNS open
+ * runs (one per circle octant) of one color: a pixel next to either end of
+ * a run, horizontally or vertically, extends it. A run goes out as one window
+ * and one DMA fill when it can't grow, when the color changes, or before any
+ * other drawing, so the panel contents end up the same as pixel by pixel.
+ */
+#ifndef HAGL_HAL_COALESCE_PIXELS
+#define HAGL_HAL_COALESCE_PIXELS 1
+#endif
+
+#if HAGL_HAL_BUFFERED
+#undef HAGL_HAL_COALESCE_PIXELS
+#define HAGL_HAL_COALESCE_PIXELS 0  // pixels go straight into the back frame
+#endif
+
+#define PIXEL_RUNS 8
+
+typedef struct {
+    int16_t x0, y0, x1, y1;  // inclusive; x0 == x1 or y0 == y1
+} pixel_run_t;
+
+static pixel_run_t pixel_runs[PIXEL_RUNS];
+static uint8_t num_runs = 0;
+#if HAGL_HAL_COALESCE_PIXELS
+static uint8_t next_evict = 0;
+#endif
+static hagl_color_t run_color;
+
+static void run_write(const pixel_run_t *r) {
+    if (r->x0 == r->x1 && r->y0 == r->y1) {
+        write_pixel(r->x0, r->y0, run_color);
+    } else {
+        fill_window(r->x0, r->y0, r->x1, r->y1, run_color);
+    }
+}
+
+static void pixels_flush(void) {
+    uint8_t n = num_runs;
+    num_runs = 0;
+    for (uint8_t i = 0; i < n; i++) run_write(&pixel_runs[i]);
+}
+
+#if HAGL_HAL_COALESCE_PIXELS
+// Extend a run by (x, y) if it touches either end; true if covered
+static bool run_extend(pixel_run_t *r, int16_t x, int16_t y) {
+    if (r->y0 == r->y1 && y == r->y0) {
+        if (x >= r->x0 && x <= r->x1) return true;
+        if (x == r->x1 + 1) { r->x1 = x; return true; }
+        if (x == r->x0 - 1) { r->x0 = x; return true; }
+    }
+    if (r->x0 == r->x1 && x == r->x0) {
+        if (y >= r->y0 && y <= r->y1) return true;
+        if (y == r->y1 + 1) { r->y1 = y; return true; }
+        if (y == r->y0 - 1) { r->y0 = y; return true; }
+    }
+    return false;
+}
+#endif
+
+/* HAL function: put a single pixel */
+static void hal_put_pixel(void *self, int16_t x, int16_t y, hagl_color_t color) {
+    if (x < 0 || x >= DISPLAY_WIDTH || y < 0 || y >= DISPLAY_HEIGHT) return;
+
+#if HAGL_HAL_BUFFERED
+    buffer_fill(x, y, x, y, color);
+#elif HAGL_HAL_COALESCE_PIXELS
+    if (num_runs && color != run_color) pixels_flush();
+    run_color = color;
+    for (uint8_t i = 0; i < num_runs; i++) {
+        if (run_extend(&pixel_runs[i], x, y)) return;
+    }
+    if (num_runs == PIXEL_RUNS) {
+        // Full: write out one run and reuse its slot
+        uint8_t i = next_evict;
+        next_evict = (next_evict + 1) % PIXEL_RUNS;
+        run_write(&pixel_runs[i]);
+        pixel_runs[i] = (pixel_run_t){x, y, x, y};
+        return;
+    }
+    pixel_runs[num_runs++] = (pixel_run_t){x, y, x, y};
+#else
+    write_pixel(x, y, color);
+#endif
+}
+
 /* HAL function: convert RGB to color */
 static hagl_color_t hal_color(void *self, uint8_t r, uint8_t g, uint8_t b) {
     return ((hagl_color_t)(((uint32_t)r << 16) | ((uint32_t)g << 8) | b));
@@ -69,52 +350,68 @@ static hagl_color_t hal_color(void *self, uint8_t r, uint8_t g, uint8_t b) {
 
 /* HAL function: draw horizontal line (optimized) */
 static void hal_hline(void *self, int16_t x, int16_t y, uint16_t width, hagl_color_t color) {
+    pixels_flush();
     if (y < 0 || y >= DISPLAY_HEIGHT) return;
     if (x < 0) { width += x; x = 0; }
     if (x + width > DISPLAY_WIDTH) width = DISPLAY_WIDTH - x;
     if (width <= 0) return;
 
-    set_addr_window(x, y, x + width - 1, y);
-
-    uint8_t r = (color >> 16) & 0xFF;
-    uint8_t g = (color >> 8) & 0xFF;
-    uint8_t b = color & 0xFF;
-
-    gpio_put(PIN_CS, 0);
-    gpio_put(PIN_DC, 1);
-    for (uint16_t i = 0; i < width; i++) {
-        spi_write_blocking(SPI_INST, &r, 1);
-        spi_write_blocking(SPI_INST, &g, 1);
-        spi_write_blocking(SPI_INST, &b, 1);
-    }
-    gpio_put(PIN_CS, 1);
+#if HAGL_HAL_BUFFERED
+    buffer_fill(x, y, x + width - 1, y, color);
+#else
+    fill_window(x, y, x + width - 1, y, color);
+#endif
 }
 
 /* HAL function: draw vertical line (optimized) */
 static void hal_vline(void *self, int16_t x, int16_t y, uint16_t height, hagl_color_t color) {
+    pixels_flush();
     if (x < 0 || x >= DISPLAY_WIDTH) return;
     if (y < 0) { height += y; y = 0; }
     if (y + height > DISPLAY_HEIGHT) height = DISPLAY_HEIGHT - y;
     if (height <= 0) return;
 
-    set_addr_window(x, y, x, y + height - 1);
+#if HAGL_HAL_BUFFERED
+    buffer_fill(x, y, x, y + height - 1, color);
+#else
+    fill_window(x, y, x, y + height - 1, color);
+#endif
+}
 
-    uint8_t r = (color >> 16) & 0xFF;
-    uint8_t g = (color >> 8) & 0xFF;
-    uint8_t b = color & 0xFF;
+/* Solid rectangle in one window and one DMA transfer */
+void hagl_hal_fill_rect(int16_t x, int16_t y, uint16_t width, uint16_t height, hagl_color_t color) {
+    pixels_flush();
+    int32_t x1 = x < 0 ? 0 : x;
+    int32_t y1 = y < 0 ? 0 : y;
+    int32_t x2 = (int32_t)x + width - 1;
+    int32_t y2 = (int32_t)y + height - 1;
+    if (x2 >= DISPLAY_WIDTH) x2 = DISPLAY_WIDTH - 1;
+    if (y2 >= DISPLAY_HEIGHT) y2 = DISPLAY_HEIGHT - 1;
+    if (x1 > x2 || y1 > y2) return;
 
-    gpio_put(PIN_CS, 0);
-    gpio_put(PIN_DC, 1);
-    for (uint16_t i = 0; i < height; i++) {
-        spi_write_blocking(SPI_INST, &r, 1);
-        spi_write_blocking(SPI_INST, &g, 1);
-        spi_write_blocking(SPI_INST, &b, 1);
-    }
-    gpio_put(PIN_CS, 1);
+#if HAGL_HAL_BUFFERED
+    buffer_fill(x1, y1, x2, y2, color);
+#else
+    fill_window(x1, y1, x2, y2, color);
+#endif
 }
 
-/* HAL function: blit with transparency (skip black pixels) */
+void hagl_hal_palette_reset(void) {
+#if HAGL_HAL_BUFFERED
+    pixels_flush();
+    buffer_palette_release();
+#endif
+}
+
+/*
+ * HAL function: blit with transparency (skip black pixels), or with a span
+ * table (hagl_bitmap_build_spans) one window and DMA burst per opaque run
+ */
 static void hal_blit(void *self, int16_t x0, int16_t y0, hagl_bitmap_t *src) {
+    if (src->spans) {
+        blit_spans(x0, y0, src);
+        return;
+    }
     hagl_color_t *ptr = (hagl_color_t *)src->buffer;
 
     for (uint16_t y = 0; y < src->height; y++) {
@@ -127,125 +424,877 @@ static void hal_blit(void *self, int16_t x0, int16_t y0, hagl_bitmap_t *src) {
     }
 }
 
-/* HAL function: flush (no-op for direct drawing) */
+/*
+ * HAL function: flush coalesced pixels and wait for an outstanding DMA fill,
+ * or in buffered mode start sending the frame drawn since the last flush
+ */
 static size_t hal_flush(void *self) {
+#if HAGL_HAL_BUFFERED
+    return buffer_flush();
+#else
+    pixels_flush();
+    fill_finish();
     return 0;
+#endif
 }
 
 /*
- * Fast scaled framebuffer blit for 6502 emulator using DMA
- * Blits a 32x32 4-bit framebuffer scaled to 320x320 at (x0, y0)
- * palette is 16 RGB888 colors, fb is 1024 bytes (4-bit indices)
+ * Fast scaled framebuffer blits for the 6502 emulator using DMA
+ * Each source format supplies a scanline builder that converts one source line
+ * into scaled RGB666 bytes, and the DMA streams it to the panel scale_y
+ * times. Palette formats look pixels up in tables built once per blit: an
+ * RGB666 triplet per entry, and for palettes of up to 16 entries the whole
+ * horizontally scaled pixel, so a scaled pixel is one copy.
  *
- * Uses double buffering: builds scanline N+1 while DMA sends scanline N
+ * Uses double buffering: builds scanline N+1 while DMA sends scanline N.
+ * A control channel feeds the data channel from a descriptor list (one entry
+ * per panel line, each a byte count and a line buffer), so vertical scaling
+ * and the switch between buffers need no CPU. The list ends in an entry with
+ * a NULL address, which stops the chain; the CPU appends each line as it is
+ * built by turning that terminator into the line's first entry, and restarts
+ * the chain if it got there first. Over PIO the chain also carries the window
+ * setup, and each line is preceded by its data packet header.
  */
 
-// Double line buffer for DMA overlap (32 pixels * 10 scale * 3 bytes = 960 bytes each)
-static uint8_t line_buf[2][32 * 10 * 3];
+// Widest scaled line: the panel width
+#define LINE_BUF_PIXELS DISPLAY_WIDTH
+
+// Double line buffer for DMA overlap (480 pixels * 3 bytes = 1440 bytes each,
+// and room to shift a line so its first sent byte is word aligned for PIO)
+static uint8_t line_buf[2][LINE_BUF_PIXELS * 3 + 4] __attribute__((aligned(4)));
 static int dma_chan = -1;
 static dma_channel_config dma_cfg;
 
-// Build a scaled scanline into the specified buffer
-static inline void build_scanline(uint8_t *buf, uint16_t y,
-                                   const uint8_t *fb, const uint32_t *palette,
-                                   uint8_t scale) {
+#if HAGL_HAL_PIO
+#define DISPLAY_TX_FIFO (&display_pio->txf[display_sm])
+#define DESC_LEAD       1  // the window setup packets
+#define DESC_PER_SEND   2  // the data packet header, then the line padded to words
+
+// Wire-order packets at the head of a rectangle's chain
+static uint32_t window_stream[WINDOW_WORDS];
+static uint32_t line_header;
+#else
+#define DISPLAY_TX_FIFO (&spi_get_hw(SPI_INST)->dr)
+#define DESC_LEAD       0
+#define DESC_PER_SEND   1
+#endif
+
+// Descriptors as the control channel writes them to the data channel's
+// TRANS_COUNT and READ_ADDR_TRIG (alias 3)
+typedef struct {
+    uint32_t count;
+    uint32_t addr;  // 0 ends the chain
+} blit_desc_t;
+
+// Sends for every panel row and the terminator
+#define BLIT_DESC_MAX (DESC_LEAD + DISPLAY_HEIGHT * DESC_PER_SEND + 1)
+
+static volatile blit_desc_t blit_desc[BLIT_DESC_MAX];
+static int ctrl_chan = -1;
+static dma_channel_config ctrl_cfg;
+
+// Blit time and the part of it the CPU spent waiting on the DMA (hagl_hal_blit_time)
+static uint32_t blit_total_us = 0;
+static uint32_t blit_idle_us = 0;
+
+// Palette lookup tables for the blit in progress
+#define WIDE_PALETTE_ENTRIES 16
+static uint8_t pal_rgb[256][3];
+static uint8_t pal_wide[WIDE_PALETTE_ENTRIES][HAGL_HAL_BLIT_SCALE_MAX * 3];
+
+// Source framebuffer description passed to the scanline builders
+typedef struct {
+    const uint8_t *fb;
+    const uint32_t *palette;
+    uint16_t width;      // source pixels per line
+    uint16_t stride;     // bytes from one source line to the next
+    uint8_t bpp;         // 1, 2, 4, 8 (palette), 16 (RGB565) or 32 (hagl_color_t)
+    uint8_t index_mask;  // palette index bits in use
+    uint8_t scale_x;
+    uint8_t scale_y;
+} fb_source_t;
+
+typedef void (*scanline_builder_t)(uint8_t *buf, uint16_t y, const fb_source_t *src);
+
+// Write one RGB888 pixel 'scale' times
+static inline uint8_t *put_scaled(uint8_t *p, uint32_t rgb, uint8_t scale) {
+    uint8_t r = (rgb >> 16) & 0xFF;
+    uint8_t g = (rgb >> 8) & 0xFF;
+    uint8_t b = rgb & 0xFF;
+
+    for (uint8_t sx = 0; sx < scale; sx++) {
+        *p++ = r;
+        *p++ = g;
+        *p++ = b;
+    }
+    return p;
+}
+
+// Fill the lookup tables for the entries a source can index
+static void prepare_palette(const fb_source_t *src) {
+    uint16_t entries = (uint16_t)src->index_mask + 1;
+    for (uint16_t i = 0; i < entries; i++) {
+        uint32_t rgb = src->palette[i];
+        pal_rgb[i][0] = (rgb >> 16) & 0xFC;  // the panel takes the top 6 bits
+        pal_rgb[i][1] = (rgb >> 8) & 0xFC;
+        pal_rgb[i][2] = rgb & 0xFC;
+        if (entries <= WIDE_PALETTE_ENTRIES) {
+            put_scaled(pal_wide[i], (pal_rgb[i][0] << 16) | (pal_rgb[i][1] << 8) | pal_rgb[i][2], src->scale_x);
+        }
+    }
+}
+
+// Palette indices packed 1, 2, 4 or 8 bits per pixel, leftmost pixel in the high bits
+static void build_scanline_indexed(uint8_t *buf, uint16_t y, const fb_source_t *src) {
+    const uint8_t *row = src->fb + y * src->stride;
+    uint8_t bpp = src->bpp;
+    uint8_t mask = src->index_mask;
+    uint8_t scale = src->scale_x;
     uint8_t *p = buf;
-    for (uint16_t x = 0; x < 32; x++) {
-        uint8_t color_idx = fb[y * 32 + x] & 0x0F;
-        uint32_t rgb = palette[color_idx];
-        uint8_t r = (rgb >> 16) & 0xFF;
-        uint8_t g = (rgb >> 8) & 0xFF;
-        uint8_t b = rgb & 0xFF;
 
+    if (mask < WIDE_PALETTE_ENTRIES) {
+        size_t run = scale * 3;
+        uint16_t x = 0;
+        while (x < src->width) {
+            uint8_t v = *row++;
+            for (int shift = 8 - bpp; shift >= 0 && x < src->width; shift -= bpp, x++) {
+                memcpy(p, pal_wide[(v >> shift) & mask], run);
+                p += run;
+            }
+        }
+        return;
+    }
+
+    for (uint16_t x = 0; x < src->width; x++) {
+        const uint8_t *rgb = pal_rgb[row[x] & mask];  // only 8bpp has more than 16 entries
         for (uint8_t sx = 0; sx < scale; sx++) {
-            *p++ = r;
-            *p++ = g;
-            *p++ = b;
+            *p++ = rgb[0];
+            *p++ = rgb[1];
+            *p++ = rgb[2];
         }
     }
 }
 
-void hagl_hal_blit_fb32(int16_t x0, int16_t y0, uint8_t scale,
-                        const uint8_t *fb, const uint32_t *palette) {
-    uint16_t fb_width = 32;
-    uint16_t fb_height = 32;
-    uint16_t scaled_w = fb_width * scale;
-    uint16_t scaled_h = fb_height * scale;
-    uint16_t line_bytes = scaled_w * 3;
-
-    // Lazy init DMA channel
-    if (dma_chan < 0) {
-        dma_chan = dma_claim_unused_channel(true);
-        dma_cfg = dma_channel_get_default_config(dma_chan);
-        channel_config_set_transfer_data_size(&dma_cfg, DMA_SIZE_8);
-        channel_config_set_dreq(&dma_cfg, spi_get_dreq(SPI_INST, true));
-        channel_config_set_read_increment(&dma_cfg, true);
-        channel_config_set_write_increment(&dma_cfg, false);
-    }
-
-    // Set address window once for entire blit area
-    set_addr_window(x0, y0, x0 + scaled_w - 1, y0 + scaled_h - 1);
+// RGB565 little-endian, two bytes per pixel
+static void build_scanline_rgb565(uint8_t *buf, uint16_t y, const fb_source_t *src) {
+    const uint8_t *row = src->fb + y * src->stride;
+    uint8_t *p = buf;
+    for (uint16_t x = 0; x < src->width; x++) {
+        uint16_t c = row[2 * x] | (row[2 * x + 1] << 8);
+        uint32_t rgb = ((uint32_t)(c & 0xF800) << 8) | ((c & 0x07E0) << 5) | ((c & 0x001F) << 3);
+        p = put_scaled(p, rgb, src->scale_x);
+    }
+}
+
+#if !HAGL_HAL_BUFFERED
+// hagl_color_t RGB888, as HAGL bitmaps hold pixels
+static void build_scanline_rgb888(uint8_t *buf, uint16_t y, const fb_source_t *src) {
+    const hagl_color_t *row = (const hagl_color_t *)(src->fb + y * src->stride);
+    uint8_t *p = buf;
+    for (uint16_t x = 0; x < src->width; x++) {
+        p = put_scaled(p, row[x], src->scale_x);
+    }
+}
+#endif
+
+/*
+ * Apple II hires: 40 bytes per line, 7 pixels per byte (bit 0 leftmost), bit 7
+ * selects the colour group. Lines are interleaved in thirds of the 8K page.
+ * Artifact colour rules: adjacent lit pixels are white, an isolated lit pixel
+ * takes the colour of its column parity and group, and an unlit pixel between
+ * two lit ones is filled with their colour.
+ */
+#define HIRES_WIDTH   280
+#define HIRES_BLACK   0x000000
+#define HIRES_WHITE   0xFFFFFF
+
+static const uint32_t hires_colors[2][2] = {
+    {0xDD22DD, 0x11DD00},  // group 0: violet (even), green (odd)
+    {0x2222FF, 0xFF6600},  // group 1: blue (even), orange (odd)
+};
+
+static inline uint16_t hires_line_offset(uint16_t y) {
+    return ((y & 0x07) << 10) | (((y >> 3) & 0x07) << 7) | ((y >> 6) * 40);
+}
+
+static void build_scanline_hires(uint8_t *buf, uint16_t y, const fb_source_t *src) {
+    const uint8_t *row = src->fb + hires_line_offset(y);
+
+    // Unpack the line with a blank pixel of padding on each side
+    uint8_t lit[HIRES_WIDTH + 2];
+    uint8_t group[HIRES_WIDTH];
+    lit[0] = lit[HIRES_WIDTH + 1] = 0;
+    for (uint16_t b = 0; b < 40; b++) {
+        uint8_t v = row[b];
+        for (uint8_t bit = 0; bit < 7; bit++) {
+            uint16_t x = b * 7 + bit;
+            lit[x + 1] = (v >> bit) & 1;
+            group[x] = v >> 7;
+        }
+    }
+
+    uint8_t *p = buf;
+    for (uint16_t x = 0; x < HIRES_WIDTH; x++) {
+        uint8_t left = lit[x], self = lit[x + 1], right = lit[x + 2];
+        uint32_t rgb;
+        if (self) {
+            rgb = (left || right) ? HIRES_WHITE : hires_colors[group[x]][x & 1];
+        } else if (left && right) {
+            rgb = hires_colors[group[x + 1]][(x + 1) & 1];
+        } else {
+            rgb = HIRES_BLACK;
+        }
+        p = put_scaled(p, rgb, src->scale_x);
+    }
+}
+
+// Descriptors the control channel has fetched so far
+static inline uint32_t desc_fetched(void) {
+    return (dma_hw->ch[ctrl_chan].read_addr - (uint32_t)(uintptr_t)blit_desc) / sizeof(blit_desc_t);
+}
+
+// Restart the chain if it stopped on a terminator that has since become a line.
+// Only a terminator leaves the data channel with a NULL read address.
+static void chain_kick(void) {
+    if (dma_channel_is_busy(ctrl_chan) || dma_channel_is_busy(dma_chan)) return;
+    if (dma_hw->ch[dma_chan].read_addr != 0) return;
+    uint32_t last = desc_fetched() - 1;
+    if (blit_desc[last].addr) {
+        dma_channel_set_read_addr(ctrl_chan, &blit_desc[last], true);
+    }
+}
+
+// Queue 'repeats' sends of one line from descriptor 'first' (the current
+// terminator) on, with a new terminator after them
+static void publish_line(uint32_t first, const uint8_t *line, uint16_t bytes, uint8_t repeats) {
+    uint32_t count[DESC_PER_SEND], addr[DESC_PER_SEND];
+#if HAGL_HAL_PIO
+    count[0] = 1;
+    addr[0] = (uint32_t)(uintptr_t)&line_header;
+    count[1] = (bytes + 3) / 4;
+    addr[1] = (uint32_t)(uintptr_t)line;
+#else
+    count[0] = bytes;
+    addr[0] = (uint32_t)(uintptr_t)line;
+#endif
+
+    uint32_t n = (uint32_t)repeats * DESC_PER_SEND;
+    blit_desc[first + n].count = count[0];
+    blit_desc[first + n].addr = 0;
+    for (uint32_t i = 1; i < n; i++) {
+        blit_desc[first + i].count = count[i % DESC_PER_SEND];
+        blit_desc[first + i].addr = addr[i % DESC_PER_SEND];
+    }
+    blit_desc[first].count = count[0];
+    __dmb();  // the entries behind it are complete before the chain can run on
+    blit_desc[first].addr = addr[0];
+}
+
+// A source rectangle on its way to the panel: each line is built into the free
+// line buffer and queued once the chain has fetched the line before it
+typedef struct {
+    scanline_builder_t build;
+    const fb_source_t *src;
+    int16_t y;               // first source line
+    uint16_t lines;          // source lines in the rectangle
+    uint16_t built;          // lines built and queued so far
+    uint16_t line_bytes;     // bytes sent per line
+    uint16_t line_offset;    // offset of the rectangle's span in a built line
+    uint16_t line_shift;     // where lines start in the line buffers
+    uint32_t line_descs;     // descriptors per source line
+} rect_stream_t;
+
+// Set up the window, queue the first line and start the chain
+static void rect_start(rect_stream_t *s, int16_t x0, int16_t y0, const dirty_rect_t *r,
+                       scanline_builder_t build, const fb_source_t *src) {
+    uint8_t scale_x = src->scale_x, scale_y = src->scale_y;
+    uint16_t wx1 = x0 + r->x0 * scale_x, wy1 = y0 + r->y0 * scale_y;
+    uint16_t wx2 = x0 + (r->x1 + 1) * scale_x - 1, wy2 = y0 + (r->y1 + 1) * scale_y - 1;
+
+    s->build = build;
+    s->src = src;
+    s->y = r->y0;
+    s->lines = r->y1 - r->y0 + 1;
+    s->line_bytes = (r->x1 - r->x0 + 1) * scale_x * 3;
+    s->line_offset = r->x0 * scale_x * 3;
+    s->line_descs = (uint32_t)scale_y * DESC_PER_SEND;
+
+#if HAGL_HAL_PIO
+    // Window setup heads the chain; lines are built shifted so the sent span is word aligned
+    uint32_t w[WINDOW_WORDS];
+    fill_finish();
+    window_packets(w, wx1, wy1, wx2, wy2);
+    for (int i = 0; i < WINDOW_WORDS; i++) window_stream[i] = __builtin_bswap32(w[i]);
+    line_header = __builtin_bswap32(PIO_DATA | ((uint32_t)s->line_bytes * 8 - 1));
+    blit_desc[0].count = WINDOW_WORDS;
+    blit_desc[0].addr = (uint32_t)(uintptr_t)window_stream;
+    s->line_shift = -s->line_offset & 3;
+#else
+    // Set address window once for the rectangle
+    set_addr_window(wx1, wy1, wx2, wy2);
 
     // Stream all pixels - ILI9488 auto-increments address
     gpio_put(PIN_CS, 0);
     gpio_put(PIN_DC, 1);
+    s->line_shift = 0;
+#endif
 
-    int cur_buf = 0;
+    // Build the first scanline (whole lines; only the rectangle's span is sent) and start the chain
+    uint8_t *buf = line_buf[0] + s->line_shift;
+    build(buf, s->y, src);
+    publish_line(DESC_LEAD, buf + s->line_offset, s->line_bytes, scale_y);
+    s->built = 1;
+    dma_channel_set_read_addr(ctrl_chan, blit_desc, true);
+}
 
-    // Pre-build first scanline
-    build_scanline(line_buf[cur_buf], 0, fb, palette, scale);
+// The next line's buffer held the line before last, which is sent once the
+// chain has fetched the last one
+static inline bool rect_can_build(const rect_stream_t *s) {
+    return s->built < s->lines && desc_fetched() > DESC_LEAD + (uint32_t)(s->built - 1) * s->line_descs;
+}
 
-    for (uint16_t y = 0; y < fb_height; y++) {
-        int next_buf = 1 - cur_buf;
+static void rect_build(rect_stream_t *s) {
+    uint16_t i = s->built++;
+    uint8_t *buf = line_buf[i & 1] + s->line_shift;
+    s->build(buf, s->y + i, s->src);
+    publish_line(DESC_LEAD + (uint32_t)i * s->line_descs, buf + s->line_offset, s->line_bytes, s->src->scale_y);
+    chain_kick();
+}
 
-        // Send current scanline 'scale' times (vertical scaling)
-        for (uint8_t sy = 0; sy < scale; sy++) {
-            // Start DMA transfer
-            dma_channel_configure(dma_chan, &dma_cfg,
-                                  &spi_get_hw(SPI_INST)->dr,  // Write to SPI TX FIFO
-                                  line_buf[cur_buf],          // Read from line buffer
-                                  line_bytes,                 // Transfer count
-                                  true);                      // Start immediately
+// Every line queued and the chain stopped on the final terminator
+static bool rect_sent(const rect_stream_t *s) {
+    uint32_t end = DESC_LEAD + (uint32_t)s->lines * s->line_descs + 1;
+    return s->built == s->lines && desc_fetched() >= end &&
+           !dma_channel_is_busy(ctrl_chan) && !dma_channel_is_busy(dma_chan);
+}
 
-            // While DMA runs, build next scanline (only on first iteration)
-            if (sy == 0 && y + 1 < fb_height) {
-                build_scanline(line_buf[next_buf], y + 1, fb, palette, scale);
-            }
+static void rect_end(void) {
+#if !HAGL_HAL_PIO
+    // Let the SPI drain before releasing CS (the PIO raises CS itself)
+    while (spi_is_busy(SPI_INST)) {
+        tight_loop_contents();
+    }
+    gpio_put(PIN_CS, 1);
+#endif
+}
 
-            // Wait for DMA to complete
-            dma_channel_wait_for_finish_blocking(dma_chan);
+// Stream one source rectangle, scaled, into its window below (x0, y0)
+static void blit_rect(int16_t x0, int16_t y0, const dirty_rect_t *r,
+                      scanline_builder_t build, const fb_source_t *src) {
+    rect_stream_t s;
+    rect_start(&s, x0, y0, r, build, src);
+
+    while (s.built < s.lines) {
+        uint32_t wait_start = time_us_32();
+        while (!rect_can_build(&s)) {
+            chain_kick();
         }
+        blit_idle_us += time_us_32() - wait_start;
+        rect_build(&s);
+    }
 
-        cur_buf = next_buf;
+    uint32_t wait_start = time_us_32();
+    while (!rect_sent(&s)) {
+        chain_kick();
     }
+    rect_end();
+    blit_idle_us += time_us_32() - wait_start;
+}
 
-    // Wait for SPI to fully drain before releasing CS
-    while (spi_is_busy(SPI_INST)) {
+// Lazy init DMA channels: data into the TX FIFO, control reloading it from the descriptors
+static void blit_dma_init(void) {
+    if (dma_chan >= 0) return;
+    dma_chan = dma_claim_unused_channel(true);
+    ctrl_chan = dma_claim_unused_channel(true);
+
+    dma_cfg = dma_channel_get_default_config(dma_chan);
+#if HAGL_HAL_PIO
+    channel_config_set_transfer_data_size(&dma_cfg, DMA_SIZE_32);
+    channel_config_set_bswap(&dma_cfg, true);  // packets are stored in wire byte order
+    channel_config_set_dreq(&dma_cfg, pio_get_dreq(display_pio, display_sm, true));
+#else
+    channel_config_set_transfer_data_size(&dma_cfg, DMA_SIZE_8);
+    channel_config_set_dreq(&dma_cfg, spi_get_dreq(SPI_INST, true));
+#endif
+    channel_config_set_read_increment(&dma_cfg, true);
+    channel_config_set_write_increment(&dma_cfg, false);
+    channel_config_set_chain_to(&dma_cfg, ctrl_chan);
+    dma_channel_configure(dma_chan, &dma_cfg, DISPLAY_TX_FIFO, NULL, 0, false);
+
+    ctrl_cfg = dma_channel_get_default_config(ctrl_chan);
+    channel_config_set_transfer_data_size(&ctrl_cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&ctrl_cfg, true);
+    channel_config_set_write_increment(&ctrl_cfg, true);
+    channel_config_set_ring(&ctrl_cfg, true, 3);  // two words, then back to TRANS_COUNT
+    dma_channel_configure(ctrl_chan, &ctrl_cfg, &dma_hw->ch[dma_chan].al3_transfer_count,
+                          blit_desc, 2, false);
+}
+
+// Stream a width x height source, scaled, into the window at (x0, y0): the
+// damaged rectangles only, or all of it when damage is NULL
+static void blit_scanlines(int16_t x0, int16_t y0, uint16_t height,
+                           scanline_builder_t build, const fb_source_t *src,
+                           const dirty_rects_t *damage) {
+#if HAGL_HAL_BUFFERED
+    hagl_hal_flush_wait();  // the DMA channels and line buffers may be sending a frame
+#endif
+    blit_dma_init();
+    pixels_flush();
+    uint32_t start_us = time_us_32();
+    if (src->palette) prepare_palette(src);
+
+    dirty_rect_t whole = {0, 0, (int16_t)(src->width - 1), (int16_t)(height - 1)};
+    if (!damage) {
+        blit_rect(x0, y0, &whole, build, src);
+        blit_total_us += time_us_32() - start_us;
+        return;
+    }
+    for (uint8_t i = 0; i < damage->count; i++) {
+        // Clip to the source; damage recorded under another mode may not fit
+        const dirty_rect_t *d = &damage->rect[i];
+        dirty_rect_t r = {
+            d->x0 > 0 ? d->x0 : 0, d->y0 > 0 ? d->y0 : 0,
+            d->x1 < whole.x1 ? d->x1 : whole.x1, d->y1 < whole.y1 ? d->y1 : whole.y1,
+        };
+        if (r.x0 <= r.x1 && r.y0 <= r.y1) blit_rect(x0, y0, &r, build, src);
+    }
+    blit_total_us += time_us_32() - start_us;
+}
+
+#if HAGL_HAL_BUFFERED
+
+/*
+ * Buffered mode
+ * Drawing goes into the back one of two 8-bit palettized frames in SRAM (a
+ * pair of RGB565 frames would not fit beside the emulator). hagl_flush() sends
+ * the back frame's damaged rectangles in the background and swaps frames: a
+ * DMA interrupt on the flushing core builds each line once the chain frees a
+ * line buffer, so drawing goes on into the other frame meanwhile. The damage
+ * is first copied into the new back frame, keeping it a copy of the panel.
+ * Colours take entries in a frame_palette_t; hagl_hal_palette_reset() frees
+ * the ones the back frame no longer shows.
+ */
+#define BUFFER_MERGE_PIXELS 64
+
+static uint8_t frames[2][DISPLAY_WIDTH * DISPLAY_HEIGHT];
+static uint8_t back_frame = 0;
+static dirty_rects_t back_damage = {{{0}}, 0, BUFFER_MERGE_PIXELS};  // drawn since the last flush
+
+static frame_palette_t palette = {{0}, 1, 0, {0}, 0, 0};
+
+// The flush in progress, stepped by the DMA interrupt
+static dirty_rects_t flush_damage;
+static fb_source_t flush_src;
+static rect_stream_t flush_stream;
+static uint8_t flush_rect;
+static volatile bool flush_busy = false;
+static bool flush_irq_ready = false;
+static void (*flush_done)(void *arg) = NULL;
+static void *flush_done_arg;
+
+// Fill (x1, y1)-(x2, y2) of the back frame; coordinates already clipped
+static void buffer_fill(int16_t x1, int16_t y1, int16_t x2, int16_t y2, hagl_color_t color) {
+    uint8_t index = frame_palette_index(&palette, color);
+    uint8_t *row = frames[back_frame] + y1 * DISPLAY_WIDTH + x1;
+    for (int16_t y = y1; y <= y2; y++, row += DISPLAY_WIDTH) {
+        memset(row, index, x2 - x1 + 1);
+    }
+    dirty_rects_add(&back_damage, x1, y1, x2, y2);
+}
+
+// Entries freed here are only still on the front frame where the back frame
+// has been drawn over since, which the next flush copies across
+static void buffer_palette_release(void) {
+    frame_palette_release(&palette, frames[back_frame], sizeof(frames[back_frame]));
+}
+
+static hagl_color_t hal_get_pixel(void *self, int16_t x, int16_t y) {
+    if (x < 0 || x >= DISPLAY_WIDTH || y < 0 || y >= DISPLAY_HEIGHT) return 0;
+    return palette.color[frames[back_frame][y * DISPLAY_WIDTH + x]];
+}
+
+// Step the flush: queue the lines whose buffers are free, then move on to the
+// next rectangle. Both channels interrupt at the end of every descriptor, so
+// the chain stopping on a terminator always brings the CPU back here.
+static void flush_irq(void) {
+    dma_hw->ints0 = (1u << dma_chan) | (1u << ctrl_chan);
+
+    rect_stream_t *s = &flush_stream;
+    while (rect_can_build(s)) rect_build(s);
+    chain_kick();
+    if (!rect_sent(s)) return;
+    rect_end();
+
+    if (++flush_rect < flush_damage.count) {
+        rect_start(s, 0, 0, &flush_damage.rect[flush_rect], build_scanline_indexed, &flush_src);
+        return;
+    }
+    dma_channel_set_irq0_enabled(dma_chan, false);
+    dma_channel_set_irq0_enabled(ctrl_chan, false);
+    flush_busy = false;
+    if (flush_done) flush_done(flush_done_arg);
+}
+
+// Swap frames and start sending the old back frame; returns the bytes it sends
+static size_t buffer_flush(void) {
+    hagl_hal_flush_wait();  // the front frame is on the panel and free to draw into
+    if (back_damage.count == 0) return 0;
+
+    uint8_t front = back_frame;
+    back_frame ^= 1;
+    flush_damage = back_damage;
+    dirty_rects_clear(&back_damage);
+
+    // Bring the new back frame up to what is about to be on the panel
+    size_t bytes = 0;
+    for (uint8_t i = 0; i < flush_damage.count; i++) {
+        const dirty_rect_t *r = &flush_damage.rect[i];
+        size_t offset = r->y0 * DISPLAY_WIDTH + r->x0;
+        size_t width = r->x1 - r->x0 + 1;
+        for (int16_t y = r->y0; y <= r->y1; y++, offset += DISPLAY_WIDTH) {
+            memcpy(frames[back_frame] + offset, frames[front] + offset, width);
+        }
+        bytes += dirty_rect_area(r) * 3;
+    }
+
+    blit_dma_init();
+    if (!flush_irq_ready) {
+        flush_irq_ready = true;
+        irq_set_exclusive_handler(DMA_IRQ_0, flush_irq);
+        irq_set_enabled(DMA_IRQ_0, true);
+    }
+
+    // The flush sends a converted copy, so entries taken or reused from now on leave it alone
+    flush_src = (fb_source_t){frames[front], palette.color, DISPLAY_WIDTH, DISPLAY_WIDTH, 8, 0xFF, 1, 1};
+    prepare_palette(&flush_src);
+    flush_rect = 0;
+    flush_busy = true;
+
+    dma_hw->ints0 = (1u << dma_chan) | (1u << ctrl_chan);
+    dma_channel_set_irq0_enabled(dma_chan, true);
+    dma_channel_set_irq0_enabled(ctrl_chan, true);
+    uint32_t irq_state = save_and_disable_interrupts();  // the first interrupt must find the stream set up
+    rect_start(&flush_stream, 0, 0, &flush_damage.rect[0], build_scanline_indexed, &flush_src);
+    restore_interrupts(irq_state);
+    return bytes;
+}
+
+void hagl_hal_flush_wait(void) {
+    while (flush_busy) {
         tight_loop_contents();
     }
+}
 
-    gpio_put(PIN_CS, 1);
+void hagl_hal_flush_callback(void (*done)(void *arg), void *arg) {
+    flush_done = done;
+    flush_done_arg = arg;
+}
+
+#endif
+
+// Bitmap with a span table: each opaque run, clipped to the panel, is a one
+// line rectangle of its own (or in buffered mode, a row of the back frame)
+static void blit_spans(int16_t x0, int16_t y0, const hagl_bitmap_t *bitmap) {
+#if !HAGL_HAL_BUFFERED
+    blit_dma_init();
+    pixels_flush();
+    uint32_t start_us = time_us_32();
+#endif
+
+    const hagl_color_t *pixels = (const hagl_color_t *)bitmap->buffer;
+    for (uint16_t y = 0; y < bitmap->height; y++) {
+        int16_t py = y0 + y;
+        if (py < 0 || py >= DISPLAY_HEIGHT) continue;
+
+        for (uint32_t i = bitmap->span_rows[y]; i < bitmap->span_rows[y + 1]; i++) {
+            const hagl_span_t *span = &bitmap->spans[i];
+            int32_t px1 = x0 + span->x0;
+            int32_t px2 = px1 + span->width - 1;
+            if (px1 < 0) px1 = 0;
+            if (px2 >= DISPLAY_WIDTH) px2 = DISPLAY_WIDTH - 1;
+            if (px1 > px2) continue;
+
+#if HAGL_HAL_BUFFERED
+            for (int32_t x = px1; x <= px2; x++) {
+                buffer_fill(x, py, x, py, pixels[y * bitmap->width + (x - x0)]);
+            }
+#else
+            fb_source_t src = {(const uint8_t *)(pixels + y * bitmap->width + (px1 - x0)), NULL,
+                               (uint16_t)(px2 - px1 + 1), 0, 32, 0, 1, 1};
+            dirty_rect_t r = {0, 0, (int16_t)(px2 - px1), 0};
+            blit_rect(px1, py, &r, build_scanline_rgb888, &src);
+#endif
+        }
+    }
+#if !HAGL_HAL_BUFFERED
+    blit_total_us += time_us_32() - start_us;
+#endif
+}
+
+/*
+ * Text
+ * Glyphs are kept as panel-format pixels (3 bytes each, foreground and
+ * background) in a least recently used cache keyed by font, code and colours,
+ * so repeated text costs a lookup per character. A line of text is sent as
+ * one rectangle: its scanline builder lays the cached glyph rows side by
+ * side. A line that needs more glyphs than the cache holds goes out in parts.
+ */
+#define GLYPH_CACHE_ENTRIES 32
+#define GLYPH_BYTES_MAX     (10 * 20 * 3)  // font10x20, the largest bundled font
+#define TEXT_GLYPHS_MAX     GLYPH_CACHE_ENTRIES
+
+typedef struct {
+    const uint8_t *font;
+    wchar_t code;
+    hagl_color_t fg, bg;
+    uint8_t width, height;
+    uint32_t used;  // LRU stamp; 0 is an empty entry
+    uint8_t pixels[GLYPH_BYTES_MAX];
+} glyph_entry_t;
+
+static glyph_entry_t glyph_cache[GLYPH_CACHE_ENTRIES];
+static uint32_t glyph_clock = 0;
+
+// Glyphs of the text line in progress, with the first text_skip pixels cut off
+static const glyph_entry_t *text_glyphs[TEXT_GLYPHS_MAX];
+static uint8_t text_count;
+#if !HAGL_HAL_BUFFERED
+static uint16_t text_skip;
+#endif
+
+// Cached glyph for (font, code, fg, bg), rendering it on a miss. NULL if the
+// font has no such glyph, it is too large, or every entry is in use by
+// glyphs stamped at or after 'keep' (the line in progress).
+static glyph_entry_t *glyph_get(const uint8_t *font, wchar_t code, hagl_color_t fg, hagl_color_t bg,
+                                uint32_t keep, bool *full) {
+    glyph_entry_t *victim = &glyph_cache[0];
+    *full = false;
+    for (int i = 0; i < GLYPH_CACHE_ENTRIES; i++) {
+        glyph_entry_t *e = &glyph_cache[i];
+        if (e->used && e->code == code && e->font == font && e->fg == fg && e->bg == bg) {
+            e->used = ++glyph_clock;
+            return e;
+        }
+        if (e->used < victim->used) victim = e;
+    }
+
+    fontx_glyph_t glyph;
+    if (fontx_glyph(&glyph, code, font) != 0) return NULL;
+    if ((uint32_t)glyph.width * glyph.height * 3 > GLYPH_BYTES_MAX) return NULL;
+    if (victim->used && victim->used >= keep) {
+        *full = true;
+        return NULL;
+    }
+
+    uint8_t *p = victim->pixels;
+    for (uint8_t y = 0; y < glyph.height; y++, glyph.buffer += glyph.pitch) {
+        for (uint8_t x = 0; x < glyph.width; x++) {
+            p = put_scaled(p, (glyph.buffer[x / 8] & (0x80 >> (x % 8))) ? fg : bg, 1);
+        }
+    }
+    victim->font = font;
+    victim->code = code;
+    victim->fg = fg;
+    victim->bg = bg;
+    victim->width = glyph.width;
+    victim->height = glyph.height;
+    victim->used = ++glyph_clock;
+    return victim;
+}
+
+#if !HAGL_HAL_BUFFERED
+static void build_scanline_text(uint8_t *buf, uint16_t y, const fb_source_t *src) {
+    uint8_t *p = buf;
+    uint8_t *end = buf + src->width * 3;
+    uint32_t skip = text_skip * 3;
+    for (uint8_t i = 0; i < text_count && p < end; i++) {
+        const glyph_entry_t *g = text_glyphs[i];
+        uint32_t n = g->width * 3;
+        const uint8_t *row = g->pixels + y * n;
+        if (skip >= n) {
+            skip -= n;
+            continue;
+        }
+        row += skip;
+        n -= skip;
+        skip = 0;
+        if (n > (uint32_t)(end - p)) n = end - p;
+        memcpy(p, row, n);
+        p += n;
+    }
+}
+#endif
+
+// Send the glyphs collected for one line of text, 'width' pixels from x0,
+// clipped to the panel
+static void text_send(int16_t x0, int16_t y0, uint16_t width, uint8_t height) {
+    int32_t left = x0 < 0 ? -x0 : 0;
+    int32_t visible = (int32_t)width - left;
+    if (x0 + left + visible > DISPLAY_WIDTH) visible = DISPLAY_WIDTH - (x0 + left);
+    if (visible > 0 && y0 + height > 0 && y0 < DISPLAY_HEIGHT) {
+#if HAGL_HAL_BUFFERED
+        // Straight into the back frame, pixel by pixel
+        for (uint8_t y = 0; y < height; y++) {
+            int16_t py = y0 + y;
+            if (py < 0 || py >= DISPLAY_HEIGHT) continue;
+            int32_t x = 0;
+            for (uint8_t i = 0; i < text_count; i++) {
+                const glyph_entry_t *g = text_glyphs[i];
+                const uint8_t *p = g->pixels + y * g->width * 3;
+                for (uint8_t gx = 0; gx < g->width; gx++, x++, p += 3) {
+                    if (x >= left && x < left + visible) {
+                        buffer_fill(x0 + x, py, x0 + x, py, ((uint32_t)p[0] << 16) | (p[1] << 8) | p[2]);
+                    }
+                }
+            }
+        }
+#else
+        text_skip = left;
+        fb_source_t src = {NULL, NULL, (uint16_t)visible, 0, 24, 0, 1, 1};  // panel-format glyphs
+        dirty_rects_t rows = {{{0, 0, (int16_t)(visible - 1), (int16_t)(height - 1)}}, 1, 0};
+        if (y0 < 0) rows.rect[0].y0 = -y0;
+        if (y0 + height > DISPLAY_HEIGHT) rows.rect[0].y1 = DISPLAY_HEIGHT - 1 - y0;
+        blit_scanlines(x0 + left, y0, height, build_scanline_text, &src, &rows);
+#endif
+    }
+    text_count = 0;
+}
+
+uint16_t hagl_hal_put_text(const wchar_t *str, int16_t x0, int16_t y0,
+                           hagl_color_t fg, hagl_color_t bg, const uint8_t *font) {
+    fontx_meta_t meta;
+    if (fontx_meta(&meta, font) != 0) return 0;
+
+    int16_t x = x0, y = y0;       // where the glyphs collected so far go
+    uint16_t part = 0;            // and their width
+    uint16_t line = 0, widest = 0;
+    uint32_t keep = glyph_clock + 1;
+    text_count = 0;
+
+    for (;;) {
+        wchar_t code = *str;
+        if (code == 0 || code == 10 || code == 13) {
+            text_send(x, y, part, meta.height);
+            line += part;
+            if (line > widest) widest = line;
+            if (code == 0) break;
+
+            // CR and LF continue at x0 on the next line
+            x = x0;
+            y += meta.height;
+            part = line = 0;
+            keep = glyph_clock + 1;
+            str++;
+            continue;
+        }
+
+        bool full = text_count == TEXT_GLYPHS_MAX;
+        glyph_entry_t *g = full ? NULL : glyph_get(font, code, fg, bg, keep, &full);
+        if (full) {
+            // Every glyph in the cache is in this part of the line: send it and carry on
+            text_send(x, y, part, meta.height);
+            x += part;
+            line += part;
+            part = 0;
+            keep = glyph_clock + 1;
+            continue;
+        }
+        str++;
+        if (g) {
+            text_glyphs[text_count++] = g;
+            part += g->width;
+        }
+    }
+    return widest;
+}
+
+void hagl_hal_blit_time(uint32_t *total_us, uint32_t *idle_us) {
+    *total_us = blit_total_us;
+    *idle_us = blit_idle_us;
+    blit_total_us = 0;
+    blit_idle_us = 0;
+}
+
+// Palette source with the index masked to index_mask
+static void blit_indexed(int16_t x0, int16_t y0, uint16_t width, uint16_t height,
+                         uint8_t bpp, uint16_t stride, uint8_t scale_x, uint8_t scale_y, uint8_t index_mask,
+                         const uint8_t *fb, const uint32_t *palette, const dirty_rects_t *damage) {
+    fb_source_t src = {fb, palette, width, stride, bpp, index_mask, scale_x, scale_y};
+    blit_scanlines(x0, y0, height, build_scanline_indexed, &src, damage);
+}
+
+void hagl_hal_blit_fb(int16_t x0, int16_t y0, uint16_t width, uint16_t height,
+                      uint8_t bpp, uint16_t stride, uint8_t scale_x, uint8_t scale_y,
+                      const uint8_t *fb, const uint32_t *palette, const dirty_rects_t *damage) {
+    if (scale_x == 0 || scale_x > HAGL_HAL_BLIT_SCALE_MAX || scale_y == 0) return;
+    if ((uint32_t)width * scale_x > LINE_BUF_PIXELS) width = LINE_BUF_PIXELS / scale_x;
+    if ((uint32_t)height * scale_y > DISPLAY_HEIGHT) height = DISPLAY_HEIGHT / scale_y;
+    if (width == 0 || height == 0) return;
+
+    if (bpp == 16) {
+        fb_source_t src = {fb, NULL, width, stride, bpp, 0, scale_x, scale_y};
+        blit_scanlines(x0, y0, height, build_scanline_rgb565, &src, damage);
+    } else if (bpp == 1 || bpp == 2 || bpp == 4 || bpp == 8) {
+        blit_indexed(x0, y0, width, height, bpp, stride, scale_x, scale_y, (uint8_t)((1u << bpp) - 1),
+                     fb, palette, damage);
+    }
+}
+
+// The emulator modes index 16 colours; the 8bpp ones ignore the high nibble
+void hagl_hal_blit_fb32(int16_t x0, int16_t y0, uint8_t scale,
+                        const uint8_t *fb, const uint32_t *palette, const dirty_rects_t *damage) {
+    blit_indexed(x0, y0, 32, 32, 8, 32, scale, scale, 0x0F, fb, palette, damage);
+}
+
+void hagl_hal_blit_fb64(int16_t x0, int16_t y0, uint8_t scale,
+                        const uint8_t *fb, const uint32_t *palette, const dirty_rects_t *damage) {
+    blit_indexed(x0, y0, 64, 64, 8, 64, scale, scale, 0x0F, fb, palette, damage);
+}
+
+void hagl_hal_blit_fb128x96(int16_t x0, int16_t y0, uint8_t scale,
+                            const uint8_t *fb, const uint32_t *palette, const dirty_rects_t *damage) {
+    blit_indexed(x0, y0, 128, 96, 4, 64, scale, scale, 0x0F, fb, palette, damage);
+}
+
+void hagl_hal_blit_hires(int16_t x0, int16_t y0, const uint8_t *page, const dirty_rects_t *damage) {
+    fb_source_t src = {page, NULL, HIRES_WIDTH, 40, 1, 0, 1, 1};
+    blit_scanlines(x0, y0, 192, build_scanline_hires, &src, damage);
 }
 
 /* HAL function: close */
 static void hal_close(void *self) {
-    /* Nothing to clean up */
+#if HAGL_HAL_BUFFERED
+    hagl_hal_flush_wait();
+#endif
+    pixels_flush();
+    fill_finish();
 }
 
 /* Initialize display hardware */
 static void init_display_hw(void) {
+#if HAGL_HAL_PIO
+    // SCK, MOSI, CS and DC belong to the state machine
+    uint offset = pio_add_program(display_pio, &ili9488_spi_program);
+    display_sm = pio_claim_unused_sm(display_pio, true);
+    ili9488_spi_program_init(display_pio, display_sm, offset, PIN_SCK, PIN_MOSI, PIN_CS, HAGL_HAL_PIO_HZ);
+
+    uint pins[] = {PIN_RST, PIN_BL};
+#else
     spi_init(SPI_INST, 50 * 1000 * 1000);
     gpio_set_function(PIN_MOSI, GPIO_FUNC_SPI);
     gpio_set_function(PIN_SCK, GPIO_FUNC_SPI);
 
     uint pins[] = {PIN_CS, PIN_DC, PIN_RST, PIN_BL};
-    for (int i = 0; i < 4; i++) {
+#endif
+    for (size_t i = 0; i < sizeof(pins) / sizeof(pins[0]); i++) {
         gpio_init(pins[i]);
         gpio_set_dir(pins[i], GPIO_OUT);
     }
 
     gpio_put(PIN_BL, 1);
+#if !HAGL_HAL_PIO
     gpio_put(PIN_CS, 1);
+#endif
 
     gpio_put(PIN_RST, 0); sleep_ms(50);
     gpio_put(PIN_RST, 1); sleep_ms(50);
@@ -276,4 +1325,9 @@ void hagl_hal_init(hagl_backend_t *backend) {
     backend->blit = hal_blit;
     backend->flush = hal_flush;
     backend->close = hal_close;
+#if HAGL_HAL_BUFFERED
+    backend->get_pixel = hal_get_pixel;
+    backend->buffer = frames[0];
+    backend->buffer2 = frames[1];
+#endif
 }
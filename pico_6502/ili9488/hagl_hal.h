@@ -8,19 +8,68 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "hagl_hal_color.h"
+#include "dirty_rects.h"
 #include "hagl/backend.h"
 
 #define DISPLAY_WIDTH   480
 #define DISPLAY_HEIGHT  320
 #define DISPLAY_DEPTH   24
 
-/* HAL init function called by HAGL */
+/* hagl_put_char() glyph bitmaps hold hagl_color_t pixels, up to font10x20 */
+#define HAGL_CHAR_BUFFER_SIZE  (10 * 20 * sizeof(hagl_color_t))
+
+/*
+ * Buffered mode: drawing, hagl_hal_fill_rect() included, goes into the back of
+ * two 8-bit palettized frames in SRAM (about 300 KB in all), and hagl_flush()
+ * starts sending what changed in the background and swaps frames. The
+ * framebuffer blits below still go straight to the panel, after the flush in
+ * progress.
+ */
+#ifndef HAGL_HAL_BUFFERED
+#define HAGL_HAL_BUFFERED 0
+#endif
+
+/*
+ * HAL init function called by HAGL
+ * Single pixels (lines, circles, text) are held back and merged into runs;
+ * hagl_flush() or any other drawing call writes them to the panel.
+ */
 void hagl_hal_init(hagl_backend_t *backend);
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * Solid rectangle, clipped to the panel: one address window and one DMA
+ * transfer (hline/vline take the same path). Returns while the DMA runs.
+ * In buffered mode it fills the back frame instead.
+ */
+void hagl_hal_fill_rect(int16_t x, int16_t y, uint16_t width, uint16_t height, hagl_color_t color);
+
+/*
+ * Buffered mode: free the palette entries no pixel of the back frame uses, so
+ * colours drawn after a clear get exact entries again. Does nothing otherwise.
+ */
+void hagl_hal_palette_reset(void);
+
+/*
+ * Scaled framebuffer blit of any size and depth at (x0, y0)
+ * bpp: 1, 2, 4 or 8 bits of palette index per pixel, leftmost pixel in the
+ * high bits of a byte; or 16 for RGB565, little-endian (palette unused)
+ * stride: bytes from one source line to the next
+ * scale_x: 1 to HAGL_HAL_BLIT_SCALE_MAX; a source larger than the panel once
+ * scaled is cut at the panel width and height
+ * palette: 1 << bpp RGB888 colors
+ * damage: rectangles to send, in framebuffer pixels; NULL sends the whole
+ * frame (the same applies to the blits below)
+ */
+#define HAGL_HAL_BLIT_SCALE_MAX 16
+
+void hagl_hal_blit_fb(int16_t x0, int16_t y0, uint16_t width, uint16_t height,
+                      uint8_t bpp, uint16_t stride, uint8_t scale_x, uint8_t scale_y,
+                      const uint8_t *fb, const uint32_t *palette, const dirty_rects_t *damage);
+
 /*
  * Fast scaled framebuffer blit for 6502 emulator
  * Blits a 32x32 4-bit framebuffer scaled by 'scale' at position (x0, y0)
@@ -28,7 +77,55 @@ extern "C" {
  * palette: 16 RGB888 colors
  */
 void hagl_hal_blit_fb32(int16_t x0, int16_t y0, uint8_t scale,
-                        const uint8_t *fb, const uint32_t *palette);
+                        const uint8_t *fb, const uint32_t *palette, const dirty_rects_t *damage);
+
+/*
+ * 64x64 framebuffer, one byte per pixel (4-bit color indices 0-15)
+ * fb: 4096 bytes, scaled by 'scale' at position (x0, y0)
+ */
+void hagl_hal_blit_fb64(int16_t x0, int16_t y0, uint8_t scale,
+                        const uint8_t *fb, const uint32_t *palette, const dirty_rects_t *damage);
+
+/*
+ * 128x96 framebuffer, two pixels per byte (high nibble is the left pixel)
+ * fb: 6144 bytes, scaled by 'scale' at position (x0, y0)
+ */
+void hagl_hal_blit_fb128x96(int16_t x0, int16_t y0, uint8_t scale,
+                            const uint8_t *fb, const uint32_t *palette, const dirty_rects_t *damage);
+
+/*
+ * 280x192 Apple II hires page with colour artifacting, unscaled
+ * page: 8192 bytes in the Apple II interleaved line layout
+ */
+void hagl_hal_blit_hires(int16_t x0, int16_t y0, const uint8_t *page, const dirty_rects_t *damage);
+
+/*
+ * Text in fg on an opaque bg: each line (CR and LF continue at x0 on the
+ * next one) goes out as one address window and one DMA burst, clipped to the
+ * panel. Glyphs come from an LRU cache of panel-format bitmaps keyed by font,
+ * code and colours, up to 10x20 pixels. Returns the width of the widest line.
+ */
+uint16_t hagl_hal_put_text(const wchar_t *str, int16_t x0, int16_t y0,
+                           hagl_color_t fg, hagl_color_t bg, const uint8_t *font);
+
+/*
+ * Microseconds spent in framebuffer blits since the last call, and how many of
+ * them the CPU only waited for the DMA; both counters restart
+ */
+void hagl_hal_blit_time(uint32_t *total_us, uint32_t *idle_us);
+
+#if HAGL_HAL_BUFFERED
+/*
+ * Wait for the frame hagl_flush() is sending to reach the panel
+ */
+void hagl_hal_flush_wait(void);
+
+/*
+ * Call done(arg) each time a flush completes; it runs in the DMA interrupt
+ * on the core that called hagl_flush()
+ */
+void hagl_hal_flush_callback(void (*done)(void *arg), void *arg);
+#endif
 
 #ifdef __cplusplus
 }
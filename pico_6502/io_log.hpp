@@ -0,0 +1,255 @@
+//
+//  Deterministic I/O record and replay for the 6502 emulator
+//
+//  Copyright 2026, John Clark
+//
+//  Released under the GNU General Public License
+//  https://www.gnu.org/licenses/gpl.html
+//
+//  Everything the emulated program sees from outside the CPU and RAM goes
+//  through IoLog::read() (I/O register reads) or IoLog::line() (interrupt
+//  inputs). While recording, a value is logged only when it differs from the
+//  previous value of the same port, stamped with the CPU cycle of the access,
+//  so polling loops cost nothing. Replay hands back the logged values at the
+//  same cycles, which reproduces the run bit-exactly as long as the emulator
+//  itself is deterministic. $FE randomness comes from IoPrng, whose seed is
+//  part of the log instead of its output.
+//
+//  Each event is two 32-bit words:
+//    word 0   cycles since the previous event
+//    word 1   [15:0] port address or line id, [23:16] value, [31:24] kind
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define IO_LOG_MAX_PORTS 16
+
+enum IoEventKind : uint8_t { IO_EVENT_READ = 0, IO_EVENT_LINE, IO_EVENT_GAP };
+
+enum IoLine : uint16_t { IO_LINE_IRQ = 0 };
+
+// ============================================================================
+//  IoPrng - seedable stand-in for the ROSC random byte (xorshift32)
+// ============================================================================
+
+class IoPrng {
+public:
+    explicit IoPrng(uint32_t seed = 1) { seed_with(seed); }
+
+    void seed_with(uint32_t seed) { state_ = seed ? seed : 0x6502c0deu; }
+
+    // Generator position, for snapshots
+    uint32_t state() const { return state_; }
+    void set_state(uint32_t state) { state_ = state; }
+
+    uint8_t next_byte() {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return (uint8_t)(state_ >> 24);
+    }
+
+private:
+    uint32_t state_;
+};
+
+// ============================================================================
+//  IoLog - change-encoded event log over caller storage
+// ============================================================================
+
+class IoLog {
+    struct Port {
+        uint16_t addr;
+        uint8_t kind;
+        uint8_t value;
+    };
+
+public:
+    enum Mode : uint8_t { OFF, RECORD, REPLAY };
+
+    // Log position and current port values, for snapshots (see rewind.hpp)
+    struct Checkpoint {
+        size_t pos;
+        uint64_t last_cycle;
+        Port ports[IO_LOG_MAX_PORTS];
+        int num_ports;
+    };
+
+    // Record into words (capacity in 32-bit words); full logs stop recording
+    void record(uint32_t* words, size_t capacity) {
+        reset(RECORD);
+        rec_ = words;
+        words_ = words;
+        capacity_ = capacity & ~(size_t)1;
+        rec_capacity_ = capacity_;
+    }
+
+    // Replay count words captured by an earlier recording
+    void replay(const uint32_t* words, size_t count) {
+        reset(REPLAY);
+        words_ = words;
+        capacity_ = count & ~(size_t)1;
+    }
+
+    Mode mode() const { return mode_; }
+
+    Checkpoint checkpoint() const {
+        Checkpoint c{pos_, last_cycle_, {}, num_ports_};
+        for (int i = 0; i < num_ports_; i++) c.ports[i] = ports_[i];
+        return c;
+    }
+
+    // Move back to an earlier checkpoint. A recording replays what it already
+    // holds from there and goes back to recording once it reaches the end.
+    void rewind(const Checkpoint& c) {
+        if (mode_ == RECORD) {
+            resume_record_ = true;
+            capacity_ = pos_;
+            mode_ = REPLAY;
+        }
+        pos_ = c.pos;
+        last_cycle_ = c.last_cycle;
+        num_ports_ = c.num_ports;
+        for (int i = 0; i < num_ports_; i++) ports_[i] = c.ports[i];
+    }
+
+    // Drop recorded input after the current position and record from here on
+    // (after a debugger changed state, the rest of the log no longer applies)
+    void truncate() {
+        if (!resume_record_) return;
+        resume_record_ = false;
+        mode_ = RECORD;
+        capacity_ = rec_capacity_;
+    }
+
+    // Value an I/O read returns at cycle; live is what the device reports now
+    inline uint8_t read(uint16_t addr, uint64_t cycle, uint8_t live) {
+        if (mode_ == OFF) return live;
+        return (uint8_t)access(IO_EVENT_READ, addr, cycle, live);
+    }
+
+    // State of an interrupt input at cycle
+    inline bool line(IoLine id, uint64_t cycle, bool live) {
+        if (mode_ == OFF) return live;
+        return access(IO_EVENT_LINE, id, cycle, live) != 0;
+    }
+
+    // Words written (record) or consumed (replay)
+    size_t size() const { return pos_; }
+    const uint32_t* data() const { return words_; }
+
+    // Record: the log filled up and later changes were lost
+    bool overflowed() const { return overflowed_; }
+
+    // Replay: an event was not consumed at its cycle, so the run no longer
+    // matches the recording; diverged_cycle() is the cycle it was due
+    bool diverged() const { return diverged_; }
+    uint64_t diverged_cycle() const { return diverged_cycle_; }
+
+    // Replay: every logged event has been delivered
+    bool finished() const { return mode_ == REPLAY && pos_ >= capacity_; }
+
+private:
+    void reset(Mode mode) {
+        mode_ = mode;
+        resume_record_ = false;
+        pos_ = 0;
+        num_ports_ = 0;
+        last_cycle_ = 0;
+        overflowed_ = false;
+        diverged_ = false;
+        diverged_cycle_ = 0;
+    }
+
+    // Current value slot for a port (ports start at 0)
+    Port& port(uint8_t kind, uint16_t addr) {
+        for (int i = 0; i < num_ports_; i++) {
+            if (ports_[i].addr == addr && ports_[i].kind == kind) return ports_[i];
+        }
+        // Beyond IO_LOG_MAX_PORTS distinct ports the last slot is shared
+        if (num_ports_ < IO_LOG_MAX_PORTS) num_ports_++;
+        Port& p = ports_[num_ports_ - 1];
+        p = {addr, kind, 0};
+        return p;
+    }
+
+    uint8_t access(uint8_t kind, uint16_t addr, uint64_t cycle, uint8_t live) {
+        if (mode_ == RECORD) {
+            Port& p = port(kind, addr);
+            if (live != p.value) {
+                p.value = live;
+                put(kind, addr, cycle, live);
+            }
+            return live;
+        }
+
+        // Caught up with a rewound recording: record again
+        if (resume_record_ && pos_ >= capacity_) {
+            truncate();
+            return access(kind, addr, cycle, live);
+        }
+
+        // Replay: apply every event due by this cycle, then answer from the port table
+        while (pos_ + 2 <= capacity_) {
+            uint64_t due = last_cycle_ + words_[pos_];
+            if (due > cycle) break;
+            uint32_t w = words_[pos_ + 1];
+            uint8_t ev_kind = (uint8_t)(w >> 24);
+            uint16_t ev_addr = (uint16_t)w;
+            if (ev_kind != IO_EVENT_GAP) {
+                // An event is consumed by an access at the cycle it was recorded
+                // at; one still pending at a later cycle was never read
+                if (due < cycle && !diverged_) {
+                    diverged_ = true;
+                    diverged_cycle_ = due;
+                }
+                port(ev_kind, ev_addr).value = (uint8_t)(w >> 16);
+            }
+            last_cycle_ = due;
+            pos_ += 2;
+        }
+        return port(kind, addr).value;
+    }
+
+    void put(uint8_t kind, uint16_t addr, uint64_t cycle, uint8_t value) {
+        uint64_t delta = cycle - last_cycle_;
+        while (delta > UINT32_MAX && pos_ + 2 <= capacity_) {
+            rec_[pos_++] = UINT32_MAX;
+            rec_[pos_++] = (uint32_t)IO_EVENT_GAP << 24;
+            delta -= UINT32_MAX;
+        }
+        if (pos_ + 2 > capacity_) {
+            overflowed_ = true;
+            return;
+        }
+        rec_[pos_++] = (uint32_t)delta;
+        rec_[pos_++] = addr | ((uint32_t)value << 16) | ((uint32_t)kind << 24);
+        last_cycle_ = cycle;
+    }
+
+    Mode mode_ = OFF;
+    uint32_t* rec_ = nullptr;
+    const uint32_t* words_ = nullptr;
+    size_t capacity_ = 0;
+    size_t rec_capacity_ = 0;
+    bool resume_record_ = false;
+    size_t pos_ = 0;
+    uint64_t last_cycle_ = 0;
+    Port ports_[IO_LOG_MAX_PORTS];
+    int num_ports_ = 0;
+    bool overflowed_ = false;
+    bool diverged_ = false;
+    uint64_t diverged_cycle_ = 0;
+};
+
+// FNV-1a over emulated memory, printed with replay results so runs can be compared
+inline uint32_t io_log_ram_hash(const uint8_t* mem, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ mem[i]) * 16777619u;
+    }
+    return h;
+}
@@ -9,6 +9,7 @@
 //  Demonstrates the W65C02S emulator running on RP2350.
 //
 
+#include <wchar.h>
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
 #include "hardware/structs/rosc.h"
@@ -16,10 +17,17 @@
 #include "hardware/vreg.h"
 #include "w65c02s.hpp"
 #include "ram.hpp"
+#include "io_log.hpp"
+#include "gdb_stub.hpp"
+#include "blitter.hpp"
+#include "spsc_ring.hpp"
 #include "hagl.h"
 #include "hagl_hal.h"
+#include "font6x9.h"
 #include "palette.h"
 #include "usb_keyboard.h"
+#include "sound.h"
+#include "acia.h"
 
 #include "programs/adventure.h"
 //#include "programs/alive.h"
@@ -44,6 +52,22 @@
 #define PROGRAM_CLK_FREQ_KHZ 1000  // default: 1 MHz
 #endif
 
+#ifndef PROGRAM_CPU
+#define PROGRAM_CPU W65C02S  // NMOS6502, C65C02, R65C02 or W65C02S
+#endif
+
+#ifndef PROGRAM_VIDEO_MODE
+#define PROGRAM_VIDEO_MODE 0  // initial value of the video mode register
+#endif
+
+#ifndef PROGRAM_FRAME_RATE
+#define PROGRAM_FRAME_RATE 30  // initial value of the frame rate register (fps)
+#endif
+
+#ifndef PROGRAM_BLITTER_COST
+#define PROGRAM_BLITTER_COST 16  // initial blitter cost: CPU cycles per 16 bytes
+#endif
+
 // ============================================================================
 //  Display configuration
 // ============================================================================
@@ -51,7 +75,7 @@
 #define DISPLAY_HEIGHT 320
 static hagl_backend_t *display;
 
-// 32x32 pixel framebuffer
+// 32x32 pixel framebuffer (mode 0)
 static constexpr uint16_t VIDEO_BASE = PROGRAM_VIDEO_BASE;
 static constexpr uint16_t VIDEO_WIDTH = 32;
 static constexpr uint16_t VIDEO_HEIGHT = 32;
@@ -59,61 +83,521 @@ static constexpr uint16_t VIDEO_SIZE = VIDEO_WIDTH * VIDEO_HEIGHT;  // 1024 byte
 static constexpr uint16_t PIXEL_SCALE = 10;     // Each pixel = 10x10 on display
 static constexpr uint16_t VIEWPORT_X = 80;      // Center 320x320 in 480x320
 static constexpr uint16_t VIEWPORT_Y = 0;
-
-// Shadow framebuffer for batched display updates (shared between cores)
-static volatile uint8_t framebuffer[VIDEO_SIZE];
-static volatile bool fb_dirty = false;
+static constexpr uint16_t VIEWPORT_SIZE = 320;
+
+// Higher resolution modes share an 8K page at $2000
+static constexpr uint16_t HIRES_BASE = 0x2000;
+static constexpr uint16_t HIRES_SIZE = 0x2000;
+
+// Video modes, selected by writing the mode register ($D300)
+// Scale factors keep every mode under ~66K panel pixels, i.e. 30 fps at 50 MHz SPI
+enum VideoMode : uint8_t {
+    VIDEO_MODE_32X32  = 0,  // 32x32, byte per pixel at PROGRAM_VIDEO_BASE, 10x (320x320)
+    VIDEO_MODE_64X64  = 1,  // 64x64, byte per pixel at $2000, 4x (256x256)
+    VIDEO_MODE_128X96 = 2,  // 128x96 4bpp, high nibble left, at $2000, 2x (256x192)
+    VIDEO_MODE_HIRES  = 3,  // 280x192 Apple II hires layout at $2000, 1x
+    VIDEO_MODE_COUNT
+};
+
+struct VideoModeInfo {
+    uint16_t base;           // first framebuffer byte
+    uint16_t size;           // framebuffer bytes
+    uint16_t width, height;  // source pixels
+    uint16_t x0, y0;         // top-left of the scaled image on the panel
+};
+
+static const VideoModeInfo video_modes[VIDEO_MODE_COUNT] = {
+    {VIDEO_BASE, VIDEO_SIZE,   32,  32, VIEWPORT_X,                VIEWPORT_Y},
+    {HIRES_BASE, 64 * 64,      64,  64, (DISPLAY_WIDTH - 256) / 2, (DISPLAY_HEIGHT - 256) / 2},
+    {HIRES_BASE, 128 * 96 / 2, 128, 96, (DISPLAY_WIDTH - 256) / 2, (DISPLAY_HEIGHT - 192) / 2},
+    {HIRES_BASE, HIRES_SIZE,   280, 192, (DISPLAY_WIDTH - 280) / 2, (DISPLAY_HEIGHT - 192) / 2},
+};
+
+// Display state shared between cores; core 1 reads the framebuffer from emulated RAM
+static volatile uint8_t video_mode = PROGRAM_VIDEO_MODE;
+static volatile bool video_mode_changed = true;
 static volatile bool cpu_running = true;
 
+// Framebuffer damage in source pixels: core 0 records what each write can
+// change and hands the rectangles over once per slice; core 1 merges them and
+// redraws only those areas (writes late in a slice show one frame later)
+static constexpr uint32_t DAMAGE_MERGE_PIXELS = 16;  // waste accepted to save a window
+static constexpr size_t DAMAGE_QUEUE_SIZE = 32;
+static dirty_rects_t fb_damage = {{}, 0, DAMAGE_MERGE_PIXELS};  // core 0, since the last hand-over
+static SpscRing<dirty_rect_t, DAMAGE_QUEUE_SIZE> damage_queue;
+
+// Memory-mapped I/O devices
+static constexpr uint16_t VIDEO_REG_BASE = 0xD300;  // video mode, vblank and frame rate registers
+static constexpr uint16_t SOUND_BASE = 0xD400;  // AY-style tone/noise generator
+static constexpr uint16_t ACIA_BASE  = 0xD500;  // 6551 ACIA (serial console)
+static constexpr uint16_t BLITTER_BASE = 0xD600;  // fill/copy engine (see blitter.hpp)
+
+// Video register page
+//   $D300  mode (see VideoMode)
+//   $D301  vblank: read bit 7 = a frame finished since the last read (reading
+//          clears it and the IRQ), bit 0 = IRQ enable (write 1 to enable)
+//   $D302  frame rate in fps, 1-60 (out of range selects PROGRAM_FRAME_RATE)
+//   $D303  frame counter, +1 per vblank (read only)
+static constexpr uint8_t VIDEO_REG_VBLANK = 0x01;
+static constexpr uint8_t VIDEO_REG_FPS = 0x02;
+static constexpr uint8_t VIDEO_REG_FRAME = 0x03;
+static constexpr uint8_t VBLANK_FLAG = 0x80;
+static constexpr uint8_t VBLANK_IRQ_ENABLE = 0x01;
+static constexpr uint8_t FRAME_RATE_MAX = 60;
+
 // Emulated CPU frequency (in Hz)
 // 1000 = 1 kHz, 1000000 = 1 MHz, 3000000 = 3 MHz, etc.
 static constexpr uint32_t CPU_FREQ_HZ = PROGRAM_CLK_FREQ_KHZ * 1000;
 
+// ============================================================================
+//  Speed control (F1-F6 on the USB keyboard)
+// ============================================================================
+// Emulated clock as num/den of CPU_FREQ_HZ; num == 0 runs unthrottled
+struct SpeedSetting {
+    const wchar_t* label;
+    uint32_t num;
+    uint32_t den;
+};
+
+static const SpeedSetting speed_settings[] = {
+    {L"1/4x", 1, 4},  // F1: slow motion
+    {L"1/2x", 1, 2},  // F2
+    {L"1x",   1, 1},  // F3: real time (default)
+    {L"2x",   2, 1},  // F4
+    {L"4x",   4, 1},  // F5
+    {L"max",  0, 1},  // F6: as fast as the core runs
+};
+static constexpr int SPEED_COUNT = sizeof(speed_settings) / sizeof(speed_settings[0]);
+static constexpr int SPEED_DEFAULT = 2;
+static volatile int speed_index = SPEED_DEFAULT;
+
+// Live emulated clock in kHz, measured on core 0 and drawn by core 1
+static constexpr uint64_t CLOCK_SAMPLE_US = 500000;
+static volatile uint32_t emu_clock_khz = 0;
+static volatile bool status_dirty = true;
+
+// Display frames are paced by wall-clock time, not emulated cycles, so turbo
+// speeds drop intermediate frames instead of queueing more SPI traffic.
+// The 32x32 mode's 320x320 blit is ~300 KB and tops out near 20 fps; the
+// higher resolution modes are sized to reach 30 fps.
+static volatile uint8_t frame_rate = PROGRAM_FRAME_RATE;
+
+// Vblank: core 1 counts finished frames, core 0 turns a new count into the
+// status flag and IRQ at its next slice boundary
+static volatile uint32_t frames_shown = 0;
+static uint32_t frames_seen = 0;
+static uint8_t frame_counter = 0;
+static bool vblank_flag = false;
+static bool vblank_irq_enabled = false;
+
+// ============================================================================
+//  Timing diagnostics
+// ============================================================================
+// Core 0 does its housekeeping once per slice and records how far behind
+// schedule each paced slice finished. USB host polling runs on core 1 unless
+// built with PICO_6502_USB_ON_CORE0, which restores the inline poll so the
+// two histograms can be compared.
+static constexpr uint32_t SLICE_CYCLES = 1024;
+static constexpr int OVERRUN_BUCKETS = 7;
+static const uint32_t overrun_limit_us[OVERRUN_BUCKETS - 1] = {1, 10, 50, 100, 500, 1000};
+static volatile uint32_t overrun_histogram[OVERRUN_BUCKETS];
+static constexpr uint64_t OVERRUN_REPORT_US = 10000000;  // print every 10 s
+
+// Emulation loop and I/O hooks follow the CPU core placement (PICO_6502_CORE_IN_RAM)
+#if W65C02S_CORE_IN_RAM
+#define CORE0_FUNC(name) __not_in_flash_func(name)
+#else
+#define CORE0_FUNC(name) name
+#endif
+
+#ifndef USB_ON_CORE0
+#define USB_ON_CORE0 0
+#endif
+
+#ifndef PICO_6502_TRACE
+#define PICO_6502_TRACE 0
+#endif
+
+// I/O log: 0 off, 1 record (dumped on halt or F11), 2 replay PICO_6502_IO_REPLAY_HEADER
+#ifndef PICO_6502_IO_LOG
+#define PICO_6502_IO_LOG 0
+#endif
+
+// Nonzero seeds the $FE random byte from IoPrng instead of the ROSC
+#ifndef PICO_6502_RANDOM_SEED
+#define PICO_6502_RANDOM_SEED 0
+#endif
+
+// GDB remote protocol on the serial console; the program starts stopped
+#ifndef PICO_6502_GDB
+#define PICO_6502_GDB 0
+#endif
+
+#if PICO_6502_IO_LOG == 2
+#include PICO_6502_IO_REPLAY_HEADER  // io_replay_seed, io_replay_end_cycle, io_replay_words[]
+#endif
+
 // Use hooked RAM to intercept writes to I/O address
 static HookedRam ram;
-static W65C02S cpu;
+static PROGRAM_CPU cpu;
+static Blitter blitter(ram.data(), BLITTER_BASE);
+
+#if PICO_6502_TRACE
+// Execution trace of the most recent instructions, dumped on halt or F12
+// (decode on the host with tools/trace_decode)
+static constexpr uint32_t TRACE_RECORDS = 16384;  // 64 KB
+static uint32_t trace_storage[TRACE_RECORDS];
+static TraceBuffer trace(trace_storage, TRACE_RECORDS);
+
+static void trace_dump() {
+    printf("TRACE BEGIN %s %lu\n", PROGRAM_CPU::Variant::name, (unsigned long)trace.size());
+    for (size_t i = 0; i < trace.size(); i++) {
+        printf("%08lx%c", (unsigned long)trace.at(i), (i % 8 == 7) ? '\n' : ' ');
+    }
+    printf("\nTRACE END\n");
+}
+#endif
+
+// Asynchronous inputs (keyboard, ACIA, IRQ line, sound status) pass through
+// the I/O log so a recorded run can be replayed cycle for cycle
+static IoLog io_log;
+static IoPrng prng;
+static bool prng_enabled = PICO_6502_RANDOM_SEED != 0;
+static uint32_t random_seed = PICO_6502_RANDOM_SEED;
+
+#if PICO_6502_IO_LOG == 1
+static constexpr uint32_t IO_LOG_WORDS = 8192;  // 32 KB, 4096 input changes
+static uint32_t io_log_storage[IO_LOG_WORDS];
+
+static void io_log_dump() {
+    printf("IOLOG BEGIN %lu %lu %llu\n", (unsigned long)random_seed, (unsigned long)io_log.size(),
+           (unsigned long long)cpu.cycles);
+    for (size_t i = 0; i < io_log.size(); i++) {
+        printf("%08lx%c", (unsigned long)io_log.data()[i], (i % 8 == 7) ? '\n' : ' ');
+    }
+    printf("\nIOLOG END%s\n", io_log.overflowed() ? " (overflowed)" : "");
+}
+#endif
+
+#if PICO_6502_GDB
+// The stdio console carries the protocol, so nothing else may print on it:
+// the reports, dumps and halt message are all left out of this build
+static int gdb_read_char() {
+    int c = getchar_timeout_us(0);
+    return c == PICO_ERROR_TIMEOUT ? -1 : c;
+}
+
+static void gdb_write(const char* data, size_t len) {
+    for (size_t i = 0; i < len; i++) putchar_raw(data[i]);
+    stdio_flush();
+}
+
+static GdbStub<PROGRAM_CPU> gdb(cpu, ram.data(), gdb_read_char, gdb_write);
+#endif
+
+// 8 random bits from the ROSC
+static uint8_t rosc_random_byte() {
+    uint8_t val = 0;
+    for (int i = 0; i < 8; i++) {
+        val = (val << 1) | (rosc_hw->randombit & 1);
+    }
+    return val;
+}
 
 // Read hook for page 0: keyboard input ($FF) and random byte ($FE)
 // $FF: Returns next character from keyboard buffer (0 if empty)
-// $FE: Returns random byte from ROSC
-static uint8_t page0_read_hook(uint16_t addr) {
+// $FE: Returns random byte from the seeded PRNG, or the ROSC when unseeded
+static uint8_t CORE0_FUNC(page0_read_hook)(uint16_t addr, void*) {
     if (addr == 0x00FF) {
         // Keyboard input - return next character from buffer
-        return usb_keyboard_getchar();
+        return io_log.read(addr, cpu.cycles, usb_keyboard_getchar());
     }
     if (addr == 0x00FE) {
-        // Generate 8-bit random value from ROSC random bits
-        uint8_t val = 0;
-        for (int i = 0; i < 8; i++) {
-            val = (val << 1) | (rosc_hw->randombit & 1);
+        return prng_enabled ? prng.next_byte() : rosc_random_byte();
+    }
+    return ram[addr];
+}
+
+// Record the pixels a change to framebuffer bytes [first, last] (offsets) can affect
+static void CORE0_FUNC(damage_bytes)(uint8_t mode, uint16_t first, uint16_t last) {
+    const VideoModeInfo& m = video_modes[mode];
+    if (mode == VIDEO_MODE_HIRES) {
+        // One byte is 7 pixels of one line; artifact colour reaches a pixel either side
+        uint16_t col = first & 0x7F;
+        if (first != last) {
+            dirty_rects_add(&fb_damage, 0, 0, m.width - 1, m.height - 1);
+        } else if (col < 120) {  // the last 8 bytes of each 128 are not displayed
+            int16_t y = ((first >> 10) & 0x07) | (((first >> 7) & 0x07) << 3) | ((col / 40) << 6);
+            int16_t x = (col % 40) * 7;
+            dirty_rects_add(&fb_damage, x > 0 ? x - 1 : 0, y, x + 7 < m.width ? x + 7 : m.width - 1, y);
         }
-        return val;
+        return;
+    }
+
+    uint8_t per_byte = mode == VIDEO_MODE_128X96 ? 2 : 1;
+    uint16_t row_bytes = m.width / per_byte;
+    int16_t y0 = first / row_bytes, y1 = last / row_bytes;
+    if (y0 == y1) {
+        dirty_rects_add(&fb_damage, (first % row_bytes) * per_byte, y0, (last % row_bytes) * per_byte + per_byte - 1, y1);
+    } else {
+        dirty_rects_add(&fb_damage, 0, y0, m.width - 1, y1);
     }
+}
+
+// Hand this slice's damage to core 1; what doesn't fit waits for the next slice
+static void CORE0_FUNC(publish_damage)() {
+    if (fb_damage.count == 0) return;
+    size_t sent = damage_queue.push(fb_damage.rect, fb_damage.count);
+    for (size_t i = sent; i < fb_damage.count; i++) {
+        fb_damage.rect[i - sent] = fb_damage.rect[i];
+    }
+    fb_damage.count -= sent;
+}
+
+// Write hook: record the damage when the active framebuffer changes (don't draw immediately)
+static void CORE0_FUNC(video_write_hook)(uint16_t addr, uint8_t val, void*) {
+    (void)val;
+    uint8_t mode = video_mode;
+    uint16_t offset = addr - video_modes[mode].base;
+    if (offset < video_modes[mode].size) {
+        damage_bytes(mode, offset, offset);
+    }
+}
+
+static void update_irq_line();
+
+// Video register page: $D300 selects the mode (reads back the active mode),
+// $D301 enables the vblank IRQ, $D302 sets the frame rate
+static void video_reg_write_hook(uint16_t addr, uint8_t val, void*) {
+    switch (addr & 0xFF) {
+        case 0: {
+            uint8_t mode = val < VIDEO_MODE_COUNT ? val : (uint8_t)VIDEO_MODE_32X32;
+            ram[addr] = mode;
+            if (mode != video_mode) {
+                video_mode = mode;
+                video_mode_changed = true;
+            }
+            break;
+        }
+        case VIDEO_REG_VBLANK:
+            vblank_irq_enabled = (val & VBLANK_IRQ_ENABLE) != 0;
+            update_irq_line();
+            break;
+        case VIDEO_REG_FPS:
+            ram[addr] = (val >= 1 && val <= FRAME_RATE_MAX) ? val : (uint8_t)PROGRAM_FRAME_RATE;
+            frame_rate = ram[addr];
+            break;
+    }
+}
+
+// Vblank status and frame counter depend on display timing, so both are logged
+static uint8_t video_reg_read_hook(uint16_t addr, void*) {
+    switch (addr & 0xFF) {
+        case VIDEO_REG_VBLANK: {
+            uint8_t status = (vblank_flag ? VBLANK_FLAG : 0) | (vblank_irq_enabled ? VBLANK_IRQ_ENABLE : 0);
+            vblank_flag = false;
+            update_irq_line();
+            return io_log.read(addr, cpu.cycles, status);
+        }
+        case VIDEO_REG_FRAME:
+            return io_log.read(addr, cpu.cycles, frame_counter);
+        default:
+            return ram[addr];
+    }
+}
+
+// Latch frames finished by core 1 since the last slice
+static void vblank_sync() {
+    uint32_t shown = frames_shown;
+    if (shown == frames_seen) return;
+    frame_counter += (uint8_t)(shown - frames_seen);
+    frames_seen = shown;
+    vblank_flag = true;
+}
+
+// Sound page: registers are queued with the current cycle for core 1 to render
+static void sound_write_hook(uint16_t addr, uint8_t val, void*) {
+    uint8_t reg = addr & 0xFF;
+    if (reg < SOUND_NUM_REGS) {
+        sound_write(reg, val, (uint32_t)cpu.cycles);
+    }
+}
+
+// Sound page reads: underrun counter, otherwise last written register value
+static uint8_t sound_read_hook(uint16_t addr, void*) {
+    uint8_t reg = addr & 0xFF;
+    if (reg == SOUND_REG_UNDERRUN) return io_log.read(addr, cpu.cycles, sound_get_underruns() & 0xFF);
+    if (reg == SOUND_REG_UNDERRUN + 1) return io_log.read(addr, cpu.cycles, (sound_get_underruns() >> 8) & 0xFF);
     return ram[addr];
 }
 
-// Write hook: buffer pixel writes (don't draw immediately)
-static void video_write_hook(uint16_t addr, uint8_t val) {
-    uint16_t offset = addr - VIDEO_BASE;
-    if (offset >= VIDEO_SIZE) return;
-    framebuffer[offset] = val & 0x0F;
-    fb_dirty = true;
+// Drive the CPU IRQ input from the device interrupt outputs
+static void update_irq_line() {
+    bool vblank_irq = vblank_flag && vblank_irq_enabled;
+    if (io_log.line(IO_LINE_IRQ, cpu.cycles, acia_irq_asserted() || vblank_irq)) {
+        cpu.trigger_irq();
+    } else {
+        cpu.clear_irq();
+    }
+}
+
+// ACIA page: 6551 registers mirrored every 4 bytes
+static uint8_t acia_read_hook(uint16_t addr, void*) {
+    uint8_t val = io_log.read(ACIA_BASE | (addr & 0x03), cpu.cycles, acia_read(addr & 0x03));
+    update_irq_line();
+    return val;
+}
+
+static void acia_write_hook(uint16_t addr, uint8_t val, void*) {
+    acia_write(addr & 0x03, val);
+    update_irq_line();
+}
+
+// Blitter page: writing the command register runs the transfer at once and
+// charges its cost to the CPU, so pacing sees the time it is modelled to take
+static void CORE0_FUNC(blitter_write_hook)(uint16_t addr, uint8_t val, void*) {
+    if ((addr & 0xFF) != BLIT_COMMAND) return;
+    cpu.cycles += blitter.run(val);
+    uint8_t mode = video_mode;
+    const VideoModeInfo& m = video_modes[mode];
+    if (blitter.dirtied(m.base, m.size)) {
+        // The written span relative to the framebuffer; it may enter by wrapping past 64K
+        uint16_t offset = blitter.dirty_begin() - m.base;
+        uint32_t end = offset + blitter.dirty_len();
+        if (offset >= m.size) {
+            damage_bytes(mode, 0, (end - 0x10000 < m.size ? end - 0x10000 : m.size) - 1);
+        } else if (end <= 0x10000) {
+            damage_bytes(mode, offset, (end < m.size ? end : m.size) - 1);
+        } else {
+            damage_bytes(mode, 0, m.size - 1);  // covers both ends
+        }
+    }
 }
 
-// Refresh display from framebuffer (fast path using direct SPI blit)
-static void refresh_display() {
-    // Use optimized HAL function - single window setup, streamed pixels
-    // Cast away volatile for the blit function (safe: core1 is the only reader)
-    hagl_hal_blit_fb32(VIEWPORT_X, VIEWPORT_Y, PIXEL_SCALE,
-                       (const uint8_t*)framebuffer, PROGRAM_PALETTE);
+// Refresh display from the active framebuffer in emulated RAM (fast path using direct SPI blit);
+// only the damaged rectangles, or everything when damage is null
+static void refresh_display(uint8_t mode, const dirty_rects_t* damage) {
+    const VideoModeInfo& m = video_modes[mode];
+    const uint8_t* fb = ram.data() + m.base;
+
+    // Use optimized HAL functions - single window setup, streamed pixels
+    switch (mode) {
+        case VIDEO_MODE_64X64:
+            hagl_hal_blit_fb64(m.x0, m.y0, 4, fb, PROGRAM_PALETTE, damage);
+            break;
+        case VIDEO_MODE_128X96:
+            hagl_hal_blit_fb128x96(m.x0, m.y0, 2, fb, PROGRAM_PALETTE, damage);
+            break;
+        case VIDEO_MODE_HIRES:
+            hagl_hal_blit_hires(m.x0, m.y0, fb, damage);
+            break;
+        default:
+            hagl_hal_blit_fb32(m.x0, m.y0, PIXEL_SCALE, fb, PROGRAM_PALETTE, damage);
+            break;
+    }
 }
 
-// Core 1: Dedicated display refresh loop
+// Clear the viewport when switching modes (smaller modes leave a black border)
+static void clear_viewport() {
+    hagl_color_t black = hagl_color(display, 0, 0, 0);
+    hagl_hal_fill_rect(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_SIZE, VIEWPORT_SIZE, black);
+    hagl_hal_palette_reset();  // colours only the old mode drew are free again
+    hagl_flush(display);  // a buffered display sends it before the blit over it
+}
+
+// Draw speed setting and measured clock in the left border
+static void draw_status() {
+    hagl_color_t black = hagl_color(display, 0, 0, 0);
+    hagl_color_t grey = hagl_color(display, 160, 160, 160);
+    hagl_hal_fill_rect(0, 0, VIEWPORT_X, 22, black);
+
+    wchar_t line[16];
+    swprintf(line, 16, L"speed %ls", speed_settings[speed_index].label);
+    hagl_hal_put_text(line, 2, 2, grey, black, font6x9);
+
+    uint32_t khz = emu_clock_khz;
+    swprintf(line, 16, L"%lu.%02lu MHz", (unsigned long)(khz / 1000), (unsigned long)(khz % 1000 / 10));
+    hagl_hal_put_text(line, 2, 12, grey, black, font6x9);
+    hagl_flush(display);  // a buffered display sends the frame
+}
+
+// Print the per-slice overrun histogram on the serial console
+static void print_overrun_histogram() {
+    printf("slice overruns (%lu cycles, usb on core %d):",
+           (unsigned long)SLICE_CYCLES, USB_ON_CORE0 ? 0 : 1);
+    for (int i = 0; i < OVERRUN_BUCKETS; i++) {
+        if (i < OVERRUN_BUCKETS - 1) {
+            printf(" <%luus:%lu", (unsigned long)overrun_limit_us[i], (unsigned long)overrun_histogram[i]);
+        } else {
+            printf(" >=%luus:%lu\n", (unsigned long)overrun_limit_us[i - 1], (unsigned long)overrun_histogram[i]);
+        }
+    }
+}
+
+// Print the framebuffer blit time per frame since the last report, and the part
+// of it core 1 only waited for the DMA
+static void print_display_time(uint32_t frames) {
+    uint32_t blit_us, idle_us;
+    hagl_hal_blit_time(&blit_us, &idle_us);
+    if (frames == 0) return;
+    printf("display: %lu frames of %lu us, blit %lu us/frame, dma wait %lu us/frame (%lu%% of the blit)\n",
+           (unsigned long)frames, (unsigned long)(1000000 / frame_rate),
+           (unsigned long)(blit_us / frames), (unsigned long)(idle_us / frames),
+           (unsigned long)(blit_us ? (uint64_t)idle_us * 100 / blit_us : 0));
+}
+
+// Core 1: Dedicated display refresh loop (also owns USB host, audio and serial interrupts)
 void core1_entry() {
+    // Audio DMA interrupts are serviced here, away from the emulation loop
+    sound_init(CPU_FREQ_HZ);
+    acia_init();
+
+#if !USB_ON_CORE0
+    // USB host IRQs and tuh_task() stay on this core; keys reach core 0 through the ring
+    usb_keyboard_init();
+#endif
+
+    dirty_rects_t screen_damage = {{}, 0, DAMAGE_MERGE_PIXELS};
+    uint64_t next_frame_us = time_us_64();
+    uint64_t next_report_us = next_frame_us + OVERRUN_REPORT_US;
+    uint32_t report_frames = 0;
     while (cpu_running) {
-        if (fb_dirty) {
-            fb_dirty = false;
-            refresh_display();
+#if !USB_ON_CORE0
+        usb_keyboard_task();
+#endif
+        sound_task();
+        acia_task();
+
+        // At most one refresh per frame; only the latest framebuffer is shown
+        uint64_t now = time_us_64();
+        if (now >= next_frame_us) {
+            uint64_t frame_us = 1000000 / frame_rate;
+            next_frame_us += frame_us;
+            if (next_frame_us < now) next_frame_us = now + frame_us;  // don't chase missed frames
+
+            dirty_rect_t r;
+            while (damage_queue.pop(r)) {
+                dirty_rects_add(&screen_damage, r.x0, r.y0, r.x1, r.y1);
+            }
+            if (video_mode_changed) {
+                video_mode_changed = false;
+                clear_viewport();
+                refresh_display(video_mode, nullptr);
+            } else if (screen_damage.count) {
+                refresh_display(video_mode, &screen_damage);
+            }
+            dirty_rects_clear(&screen_damage);
+            if (status_dirty) {
+                status_dirty = false;
+                draw_status();
+            }
+            frames_shown = frames_shown + 1;  // blit done: vblank for core 0
+        }
+        if (!PICO_6502_GDB && now >= next_report_us) {  // the console carries gdb packets
+            next_report_us = now + OVERRUN_REPORT_US;
+            print_overrun_histogram();
+            print_display_time(frames_shown - report_frames);
+            report_frames = frames_shown;
         }
         // Small yield to avoid hammering the flag
         tight_loop_contents();
@@ -125,7 +609,137 @@ void init_display() {
 
     // Clear entire screen to black
     hagl_color_t black = hagl_color(display, 0, 0, 0);
-    hagl_fill_rectangle_xyxy(display, 0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1, black);
+    hagl_hal_fill_rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, black);
+    hagl_hal_palette_reset();
+    hagl_flush(display);
+}
+
+// Wall-clock time by which the cycles since the last speed change are due
+static inline uint64_t CORE0_FUNC(pace_deadline_us)(uint64_t pace_time_us, uint64_t cycles, const SpeedSetting& s) {
+    return pace_time_us + (cycles * 1000000ULL * s.den / ((uint64_t)CPU_FREQ_HZ * s.num));
+}
+
+// Count a finished slice in the overrun histogram
+static inline void CORE0_FUNC(record_overrun)(uint64_t late_us) {
+    int bucket = 0;
+    while (bucket < OVERRUN_BUCKETS - 1 && late_us >= overrun_limit_us[bucket]) bucket++;
+    overrun_histogram[bucket] = overrun_histogram[bucket] + 1;
+}
+
+// Core 0: Cycle-accurate CPU emulation
+// Track total cycles executed and compare against wall-clock time
+static void CORE0_FUNC(run_cpu)() {
+    uint64_t total_cycles = 0;
+    uint64_t slice_end_cycles = SLICE_CYCLES;
+
+    // Pacing restarts from the point of the last speed change
+    int speed = speed_index;
+    uint64_t pace_cycles = 0;
+    uint64_t pace_time_us = time_us_64();
+
+    // Window for the live clock measurement
+    uint64_t sample_cycles = 0;
+    uint64_t sample_time_us = pace_time_us;
+
+#if PICO_6502_IO_LOG == 2
+    uint64_t replay_start_us = pace_time_us;
+    bool replay_reported = false;
+#endif
+
+    while (!cpu.halted) {
+        // Execute one instruction and get cycle count
+#if PICO_6502_GDB
+        if ((gdb.active() ? gdb.step() : cpu.step()) == 0) {
+            // Stopped in the debugger: pacing resumes from the current time
+            pace_cycles = total_cycles;
+            pace_time_us = time_us_64();
+            continue;
+        }
+#else
+        cpu.step();
+#endif
+        total_cycles = cpu.cycles;  // includes blitter time charged by the write hook
+
+        // Per-slice housekeeping (every ~1000 cycles)
+        if (total_cycles >= slice_end_cycles) {
+            slice_end_cycles = (total_cycles / SLICE_CYCLES + 1) * SLICE_CYCLES;  // a blit can span slices
+            uint64_t now = time_us_64();
+
+#if USB_ON_CORE0
+            usb_keyboard_task();
+#endif
+            sound_sync((uint32_t)total_cycles);
+            vblank_sync();
+            publish_damage();
+            update_irq_line();  // ACIA receive data and vblank arrive asynchronously
+#if PICO_6502_GDB
+            gdb.poll();  // Ctrl-C and breakpoint changes while running
+#endif
+
+            // F1-F6 select the emulation speed, F11 dumps the I/O log, F12 the trace
+            uint8_t fkey = usb_keyboard_get_fkey();
+#if PICO_6502_IO_LOG == 1
+            if (!PICO_6502_GDB && fkey == 11) {
+                io_log_dump();
+                now = time_us_64();
+                pace_cycles = total_cycles;
+                pace_time_us = now;
+            }
+#endif
+#if PICO_6502_TRACE
+            if (!PICO_6502_GDB && fkey == 12) {
+                trace_dump();
+                now = time_us_64();
+                pace_cycles = total_cycles;  // don't race to catch up after the dump
+                pace_time_us = now;
+            }
+#endif
+            if (fkey >= 1 && fkey <= SPEED_COUNT && fkey - 1 != speed) {
+                speed = fkey - 1;
+                speed_index = speed;
+                pace_cycles = total_cycles;
+                pace_time_us = now;
+                status_dirty = true;
+            }
+
+            if (now - sample_time_us >= CLOCK_SAMPLE_US) {
+                emu_clock_khz = (uint32_t)((total_cycles - sample_cycles) * 1000 / (now - sample_time_us));
+                sample_cycles = total_cycles;
+                sample_time_us = now;
+                status_dirty = true;
+            }
+
+#if PICO_6502_IO_LOG == 2
+            // Replay benchmark: report once the recorded run length is reached
+            if (!PICO_6502_GDB && !replay_reported && total_cycles >= io_replay_end_cycle) {
+                replay_reported = true;
+                printf("replay: %llu cycles in %llu us, ram %08lx, %s\n",
+                       (unsigned long long)total_cycles, (unsigned long long)(now - replay_start_us),
+                       (unsigned long)io_log_ram_hash(ram.data(), 0x10000),
+                       io_log.diverged() ? "diverged" : "matched");
+            }
+#endif
+
+            // Lateness of this slice including the housekeeping above
+            if (speed_settings[speed].num != 0) {
+                uint64_t done = time_us_64();
+                uint64_t deadline = pace_deadline_us(pace_time_us, total_cycles - pace_cycles, speed_settings[speed]);
+                record_overrun(done > deadline ? done - deadline : 0);
+            }
+        }
+
+        // Unthrottled: never wait
+        const SpeedSetting& s = speed_settings[speed];
+        if (s.num == 0) continue;
+
+        // Calculate when these cycles should complete at the selected frequency
+        uint64_t target_time_us = pace_deadline_us(pace_time_us, total_cycles - pace_cycles, s);
+
+        // Wait for cycle timing (only if we're ahead)
+        while (time_us_64() < target_time_us) {
+            tight_loop_contents();
+        }
+    }
 }
 
 int main() {
@@ -141,15 +755,28 @@ int main() {
                     200 * 1000 * 1000,
                     200 * 1000 * 1000);
 
+    // Serial console for diagnostics (after clock setup so the baud rate is right)
+    stdio_init_all();
+
     init_display();
 
-    // Initialize USB keyboard
+#if USB_ON_CORE0
+    // Initialize USB keyboard (otherwise done by core 1)
     usb_keyboard_init();
+#endif
 
     // Set up RAM with hooks
     HookedRam::set_instance(&ram);
     ram.set_write_hook(VIDEO_BASE, VIDEO_BASE + VIDEO_SIZE - 1, video_write_hook);
+    ram.set_write_hook(HIRES_BASE, HIRES_BASE + HIRES_SIZE - 1, video_write_hook);
+    ram.set_write_hook(VIDEO_REG_BASE >> 8, video_reg_write_hook);
+    ram.set_read_hook(VIDEO_REG_BASE >> 8, video_reg_read_hook);
     ram.set_read_hook(0x00, page0_read_hook);  // $FE=random, $FF=keyboard (page 0)
+    ram.set_write_hook(SOUND_BASE >> 8, sound_write_hook);
+    ram.set_read_hook(SOUND_BASE >> 8, sound_read_hook);
+    ram.set_write_hook(ACIA_BASE >> 8, acia_write_hook);
+    ram.set_read_hook(ACIA_BASE >> 8, acia_read_hook);
+    ram.set_write_hook(BLITTER_BASE >> 8, blitter_write_hook);
 
     // Connect CPU to RAM
     cpu.ram_read = &HookedRam::static_read;
@@ -163,44 +790,71 @@ int main() {
     ram.load(sine_table_addr, sine_table, sizeof(sine_table));
 #endif
 
+    // Initial video mode and frame rate (programs change both through the registers)
+    ram[VIDEO_REG_BASE] = video_mode;
+    ram[VIDEO_REG_BASE + VIDEO_REG_FPS] = frame_rate;
+    ram[BLITTER_BASE + BLIT_COST] = PROGRAM_BLITTER_COST;
+
     // Set reset vector to point to program start
     ram[0xFFFC] = program_load_addr & 0xFF;         // Low byte
     ram[0xFFFD] = (program_load_addr >> 8) & 0xFF;  // High byte
 
+    // Input source: a recording always uses the PRNG so its seed replaces the random bytes
+#if PICO_6502_IO_LOG == 1
+    if (!prng_enabled) random_seed = ((uint32_t)rosc_random_byte() << 24) | ((uint32_t)rosc_random_byte() << 16) |
+                                     ((uint32_t)rosc_random_byte() << 8) | rosc_random_byte();
+    prng_enabled = true;
+    io_log.record(io_log_storage, IO_LOG_WORDS);
+#elif PICO_6502_IO_LOG == 2
+    random_seed = io_replay_seed;
+    prng_enabled = true;
+    io_log.replay(io_replay_words, sizeof(io_replay_words) / sizeof(io_replay_words[0]));
+#endif
+    prng.seed_with(random_seed);
+
     // Reset CPU (reads reset vector into PC)
     cpu.reset();
     cpu.reg.pc = ram.read_word(0xFFFC);
 
+#if PICO_6502_TRACE
+    trace.start(cpu.reg.pc, cpu.reg.sp);
+    cpu.trace = &trace;
+#endif
+
     // Launch Core 1 for display refresh
     multicore_launch_core1(core1_entry);
 
-    // Core 0: Cycle-accurate CPU emulation
-    // Track total cycles executed and compare against wall-clock time
-    uint64_t total_cycles = 0;
-    uint64_t start_time_us = time_us_64();
-
-    while (!cpu.halted) {
-        // Execute one instruction and get cycle count
-        int cycles = cpu.step();
-        total_cycles += cycles;
-
-        // Poll USB keyboard periodically (every ~1000 cycles)
-        if ((total_cycles & 0x3FF) == 0) {
-            usb_keyboard_task();
-        }
-
-        // Calculate when these cycles should complete at target frequency
-        uint64_t target_time_us = start_time_us + (total_cycles * 1000000ULL / CPU_FREQ_HZ);
-
-        // Wait for cycle timing (only if we're ahead)
-        while (time_us_64() < target_time_us) {
-            tight_loop_contents();
-        }
-    }
+    // Core 0: Cycle-accurate CPU emulation (returns when the CPU halts)
+    run_cpu();
 
     // CPU halted (STP instruction) - signal Core 1 to stop
     cpu_running = false;
+#if !PICO_6502_GDB
+    printf("%s halted at $%04X after %llu cycles (audio underruns: %lu, dropped writes: %lu)\n",
+           PROGRAM_CPU::Variant::name, cpu.reg.pc, (unsigned long long)cpu.cycles,
+           (unsigned long)sound_get_underruns(), (unsigned long)sound_get_overflows());
+    print_overrun_histogram();
+#if PICO_6502_IO_LOG == 1
+    io_log_dump();
+#elif PICO_6502_IO_LOG == 2
+    if (io_log.diverged()) {
+        printf("replay diverged at cycle %llu\n", (unsigned long long)io_log.diverged_cycle());
+    }
+#endif
+#if PICO_6502_TRACE
+    trace_dump();
+#endif
+#endif
+#if PICO_6502_GDB
+    // Memory and registers stay inspectable after the halt
+    gdb.report_halt();
+    while (true) {
+        gdb.poll();
+        sleep_ms(1);
+    }
+#else
     while (true) {
         sleep_ms(1000);
     }
+#endif
 }
@@ -2,6 +2,9 @@
 // 6502 Program: Cycle through all 16 colors
 //
 // Fills the 32x32 video RAM with each color in sequence (0-15), then wraps.
+// Each fill waits for vblank ($D301 bit 7), so every displayed frame shows one
+// whole color instead of a torn mix of two. The fill itself is one blitter
+// command ($D600): 1024 bytes for ~1K cycles instead of ~10K with STA,X loops.
 //
 // Entry point: 0x0600
 //
@@ -19,28 +22,30 @@
 inline constexpr uint16_t program_load_addr = 0x0600;
 
 inline constexpr uint8_t program[] = {
-    0xA9, 0x00,             // LDA #$00       ; color = 0
-    0x85, 0x00,             // STA $00
+    0xA9, 0x00,             // $0600  LDA #$00       ; color = 0
+    0x85, 0x00,             // $0602  STA $00
+    // Blitter destination $0200, 1024 bytes (height and strides stay 0: linear)
+    0xA9, 0x00,             // $0604  LDA #$00
+    0x8D, 0x02, 0xD6,       // $0606  STA $D602      ; dst lo
+    0xA9, 0x02,             // $0609  LDA #$02
+    0x8D, 0x03, 0xD6,       // $060B  STA $D603      ; dst hi
+    0xA9, 0x00,             // $060E  LDA #$00
+    0x8D, 0x04, 0xD6,       // $0610  STA $D604      ; width lo
+    0xA9, 0x04,             // $0613  LDA #$04
+    0x8D, 0x05, 0xD6,       // $0615  STA $D605      ; width hi
+    // vsync:
+    0xAD, 0x01, 0xD3,       // $0618  LDA $D301      ; vblank status (reading clears it)
+    0x10, 0xFB,             // $061B  BPL vsync      ; wait for bit 7
     // fill:
-    0xA5, 0x00,             // LDA $00        ; load color
-    0xA2, 0x00,             // LDX #$00
-    0x9D, 0x00, 0x02,       // STA $0200,X
-    0xE8,                   // INX
-    0xD0, 0xFA,             // BNE -6
-    0x9D, 0x00, 0x03,       // STA $0300,X
-    0xE8,                   // INX
-    0xD0, 0xFA,             // BNE -6
-    0x9D, 0x00, 0x04,       // STA $0400,X
-    0xE8,                   // INX
-    0xD0, 0xFA,             // BNE -6
-    0x9D, 0x00, 0x05,       // STA $0500,X
-    0xE8,                   // INX
-    0xD0, 0xFA,             // BNE -6
-    0xE6, 0x00,             // INC $00        ; color++
-    0xA5, 0x00,             // LDA $00
-    0x29, 0x0F,             // AND #$0F       ; wrap 0-15
-    0x85, 0x00,             // STA $00
-    0x4C, 0x04, 0x06        // JMP $0604      ; loop
+    0xA5, 0x00,             // $061D  LDA $00        ; load color
+    0x8D, 0x09, 0xD6,       // $061F  STA $D609      ; fill value
+    0xA9, 0x01,             // $0622  LDA #$01
+    0x8D, 0x0F, 0xD6,       // $0624  STA $D60F      ; command: fill
+    0xE6, 0x00,             // $0627  INC $00        ; color++
+    0xA5, 0x00,             // $0629  LDA $00
+    0x29, 0x0F,             // $062B  AND #$0F       ; wrap 0-15
+    0x85, 0x00,             // $062D  STA $00
+    0x4C, 0x18, 0x06        // $062F  JMP $0618      ; next frame
 };
 
 inline constexpr size_t program_size = sizeof(program);
@@ -13,20 +13,32 @@
 #include <array>
 #include <cstdint>
 #include <cstdio>
-#include <functional>
 #include <string>
 #include <type_traits>
 
+// Memory accesses sit on the emulator hot path - see W65C02S_CORE_IN_RAM
+#if W65C02S_CORE_IN_RAM
+#define RAM_HOT __attribute__((section(".time_critical.ram")))
+#else
+#define RAM_HOT
+#endif
+
 // ============================================================================
 //  Hook types and storage
 // ============================================================================
 
-using ReadHook = std::function<uint8_t(uint16_t addr)>;
-using WriteHook = std::function<void(uint16_t addr, uint8_t val)>;
+// Plain function pointers, like the CPU's ram_read/ram_write: Ram::read and
+// Ram::write call them on every access to a hooked page, and a std::function
+// thunk would stay in flash when the core runs from SRAM. ctx is whatever
+// pointer was passed when the hook was set.
+using ReadHook = uint8_t (*)(uint16_t addr, void* ctx);
+using WriteHook = void (*)(uint16_t addr, uint8_t val, void* ctx);
 
 struct PageHandler {
-    ReadHook read;
-    WriteHook write;
+    ReadHook read = nullptr;
+    WriteHook write = nullptr;
+    void* read_ctx = nullptr;
+    void* write_ctx = nullptr;
 };
 
 namespace detail {
@@ -66,19 +78,19 @@ public:
     //  Core read/write operations
     // ========================================================================
 
-    uint8_t read(uint16_t addr) const {
+    RAM_HOT uint8_t read(uint16_t addr) const {
         if constexpr (HasHooks) {
             const auto& page = this->pages_[addr >> 8];
-            if (page.read) return page.read(addr);
+            if (page.read) return page.read(addr, page.read_ctx);
         }
         return mem_[addr];
     }
 
-    void write(uint16_t addr, uint8_t val) {
+    RAM_HOT void write(uint16_t addr, uint8_t val) {
         mem_[addr] = val;
         if constexpr (HasHooks) {
             const auto& page = this->pages_[addr >> 8];
-            if (page.write) page.write(addr, val);
+            if (page.write) page.write(addr, val, page.write_ctx);
         }
     }
 
@@ -105,54 +117,59 @@ public:
 
     // Set read hook for address range (applies to all pages in range)
     template<bool H = HasHooks, typename = std::enable_if_t<H>>
-    void set_read_hook(uint16_t addr_begin, uint16_t addr_end, ReadHook hook) {
+    void set_read_hook(uint16_t addr_begin, uint16_t addr_end, ReadHook hook, void* ctx = nullptr) {
         uint8_t page_begin = addr_begin >> 8;
         uint8_t page_end = addr_end >> 8;
         for (unsigned page = page_begin; page <= page_end; ++page) {
             this->pages_[page].read = hook;
+            this->pages_[page].read_ctx = ctx;
         }
     }
 
     // Set write hook for address range (applies to all pages in range)
     template<bool H = HasHooks, typename = std::enable_if_t<H>>
-    void set_write_hook(uint16_t addr_begin, uint16_t addr_end, WriteHook hook) {
+    void set_write_hook(uint16_t addr_begin, uint16_t addr_end, WriteHook hook, void* ctx = nullptr) {
         uint8_t page_begin = addr_begin >> 8;
         uint8_t page_end = addr_end >> 8;
         for (unsigned page = page_begin; page <= page_end; ++page) {
             this->pages_[page].write = hook;
+            this->pages_[page].write_ctx = ctx;
         }
     }
 
     // Set read hook for a single page
     template<bool H = HasHooks, typename = std::enable_if_t<H>>
-    void set_read_hook(uint8_t page, ReadHook hook) {
-        this->pages_[page].read = std::move(hook);
+    void set_read_hook(uint8_t page, ReadHook hook, void* ctx = nullptr) {
+        this->pages_[page].read = hook;
+        this->pages_[page].read_ctx = ctx;
     }
 
     // Set write hook for a single page
     template<bool H = HasHooks, typename = std::enable_if_t<H>>
-    void set_write_hook(uint8_t page, WriteHook hook) {
-        this->pages_[page].write = std::move(hook);
+    void set_write_hook(uint8_t page, WriteHook hook, void* ctx = nullptr) {
+        this->pages_[page].write = hook;
+        this->pages_[page].write_ctx = ctx;
     }
 
     // Clear read hook for a single page
     template<bool H = HasHooks, typename = std::enable_if_t<H>>
     void clear_read_hook(uint8_t page) {
         this->pages_[page].read = nullptr;
+        this->pages_[page].read_ctx = nullptr;
     }
 
     // Clear write hook for a single page
     template<bool H = HasHooks, typename = std::enable_if_t<H>>
     void clear_write_hook(uint8_t page) {
         this->pages_[page].write = nullptr;
+        this->pages_[page].write_ctx = nullptr;
     }
 
     // Clear all hooks
     template<bool H = HasHooks, typename = std::enable_if_t<H>>
     void clear_hooks() {
         for (auto& page : this->pages_) {
-            page.read = nullptr;
-            page.write = nullptr;
+            page = PageHandler{};
         }
     }
 
@@ -241,11 +258,11 @@ public:
 
     static void set_instance(Ram* ram) { instance_ = ram; }
 
-    static uint8_t static_read(uint16_t addr) {
+    RAM_HOT static uint8_t static_read(uint16_t addr) {
         return instance_ ? instance_->read(addr) : 0;
     }
 
-    static void static_write(uint16_t addr, uint8_t val) {
+    RAM_HOT static void static_write(uint16_t addr, uint8_t val) {
         if (instance_) instance_->write(addr, val);
     }
 
@@ -0,0 +1,237 @@
+//
+//  Reverse execution for the 6502 emulator
+//
+//  Copyright 2026, John Clark
+//
+//  Released under the GNU General Public License
+//  https://www.gnu.org/licenses/gpl.html
+//
+//  Rewinder drives the CPU one step at a time and takes a snapshot every
+//  interval_cycles: registers, interrupt lines, the I/O log position, the PRNG
+//  state and the RAM pages that changed since the previous snapshot. Pages are
+//  found by comparing against a copy of memory at the newest snapshot, so the
+//  Ram read/write path is untouched.
+//
+//  Snapshots hold undo pages (the page contents at that snapshot for pages the
+//  next interval modified). Restoring starts from the newest snapshot's memory
+//  and walks back, so the cost grows with the distance from the newest
+//  snapshot, not with the length of the run. Going back to an instruction
+//  restores the nearest earlier snapshot and replays forward with the recorded
+//  input, which reproduces the original run exactly. When the snapshots exceed
+//  budget_bytes the oldest are dropped, which limits how far back you can go.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "io_log.hpp"
+
+template<typename Cpu>
+class Rewinder {
+public:
+    // Called after every step with the cycle count before it; drives anything
+    // outside the CPU that must replay identically (e.g. per-slice IRQ sampling)
+    using StepHook = std::function<void(uint64_t cycles_before)>;
+
+    struct Config {
+        uint64_t interval_cycles = 100000;  // cycles between snapshots
+        size_t budget_bytes = 64u << 20;    // snapshot memory, including two 64K images
+    };
+
+    // mem is the 64K the CPU runs on; io and prng may be null when not used
+    Rewinder(Cpu& cpu, uint8_t* mem, IoLog* io, IoPrng* prng, Config config = Config())
+        : cpu_(cpu), mem_(mem), io_(io), prng_(prng), config_(config), newest_(MEM_SIZE) {}
+
+    void set_step_hook(StepHook hook) { step_hook_ = std::move(hook); }
+
+    // Forget the history and take the first snapshot of the current state
+    void start() {
+        snaps_.clear();
+        bytes_ = 2 * MEM_SIZE;
+        index_ = 0;
+        memcpy(newest_.data(), mem_, MEM_SIZE);
+        push_snapshot();
+    }
+
+    // Execute one CPU step (instruction or interrupt entry), snapshotting as due
+    int step() {
+        uint64_t before = cpu_.cycles;
+        int cycles = cpu_.step();
+        index_++;
+        if (step_hook_) step_hook_(before);
+        if (index_ > snaps_.back().index && cpu_.cycles - snaps_.back().cpu.cycles >= config_.interval_cycles) {
+            take_snapshot();
+        }
+        return cycles;
+    }
+
+    // Steps executed since start(); the position step_back() and seek() work in
+    uint64_t position() const { return index_; }
+
+    // Earliest position that can still be reached
+    uint64_t oldest() const { return snaps_.front().index; }
+
+    // Go to an earlier position (or a later one already executed at least once
+    // since the history was last cut); false if it is out of reach
+    bool seek(uint64_t target) {
+        if (target < oldest()) return false;
+        if (target < index_) restore(latest_at_or_before(target));
+        while (index_ < target && !cpu_.halted) step();
+        return index_ == target;
+    }
+
+    bool step_back(uint64_t n = 1) {
+        return n <= index_ && seek(index_ - n);
+    }
+
+    // Go back to the most recent earlier position where stop(cpu) holds,
+    // checking one snapshot interval at a time. Ends at oldest() and returns
+    // false when there is none.
+    template<typename Pred>
+    bool run_back(Pred stop) {
+        uint64_t end = index_;
+        size_t k = latest_at_or_before(end ? end - 1 : 0);
+        while (true) {
+            restore(k);
+            uint64_t found = UINT64_MAX;
+            while (index_ < end) {
+                if (stop(cpu_)) found = index_;
+                step();
+            }
+            if (found != UINT64_MAX) return seek(found);
+            end = snaps_[k].index;
+            if (k == 0) {
+                restore(0);
+                return false;
+            }
+            k--;
+        }
+    }
+
+    // Drop snapshots after the current position, e.g. after a debugger wrote
+    // registers or memory, and record input from here on
+    void cut_future() {
+        size_t k = latest_at_or_before(index_);
+        if (k + 1 < snaps_.size()) {
+            rebuild_newest(k);
+            while (snaps_.size() > k + 1) pop_back();
+            Snapshot& s = snaps_.back();
+            bytes_ -= s.undo.size() + s.pages.size();
+            s.pages.clear();
+            s.undo.clear();
+        }
+        if (io_) io_->truncate();
+    }
+
+    size_t snapshot_count() const { return snaps_.size(); }
+    size_t memory_bytes() const { return bytes_; }
+
+private:
+    static constexpr size_t MEM_SIZE = 0x10000;
+    static constexpr size_t PAGE = 256;
+
+    struct CpuState {
+        decltype(Cpu::reg) reg;
+        uint64_t cycles;
+        bool halted, waiting, irq_pending, nmi_pending;
+    };
+
+    struct Snapshot {
+        uint64_t index;
+        CpuState cpu;
+        IoLog::Checkpoint io;
+        uint32_t prng;
+        std::vector<uint8_t> pages;  // pages the following interval changed
+        std::vector<uint8_t> undo;   // their contents at this snapshot
+    };
+
+    void push_snapshot() {
+        Snapshot s{};
+        s.index = index_;
+        s.cpu = {cpu_.reg, cpu_.cycles, cpu_.halted, cpu_.waiting, cpu_.irq_pending, cpu_.nmi_pending};
+        if (io_) s.io = io_->checkpoint();
+        if (prng_) s.prng = prng_->state();
+        snaps_.push_back(std::move(s));
+        bytes_ += sizeof(Snapshot);
+    }
+
+    void pop_back() {
+        bytes_ -= sizeof(Snapshot) + snaps_.back().pages.size() + snaps_.back().undo.size();
+        snaps_.pop_back();
+    }
+
+    void take_snapshot() {
+        // The newest snapshot keeps the old contents of every page that changed
+        Snapshot& prev = snaps_.back();
+        for (size_t page = 0; page < MEM_SIZE / PAGE; page++) {
+            uint8_t* old = newest_.data() + page * PAGE;
+            const uint8_t* cur = mem_ + page * PAGE;
+            if (memcmp(old, cur, PAGE) != 0) {
+                prev.pages.push_back((uint8_t)page);
+                prev.undo.insert(prev.undo.end(), old, old + PAGE);
+                memcpy(old, cur, PAGE);
+                bytes_ += PAGE + 1;
+            }
+        }
+        push_snapshot();
+
+        while (bytes_ > config_.budget_bytes && snaps_.size() > 2) {
+            Snapshot& s = snaps_.front();
+            bytes_ -= sizeof(Snapshot) + s.pages.size() + s.undo.size();
+            snaps_.pop_front();
+        }
+    }
+
+    // Undo pages of snapshot k into image
+    void apply_undo(size_t k, uint8_t* image) const {
+        const Snapshot& s = snaps_[k];
+        for (size_t i = 0; i < s.pages.size(); i++) {
+            memcpy(image + s.pages[i] * PAGE, s.undo.data() + i * PAGE, PAGE);
+        }
+    }
+
+    // Reset newest_ to the memory at snapshot k (before the later ones are dropped)
+    void rebuild_newest(size_t k) {
+        for (size_t i = snaps_.size() - 1; i-- > k;) apply_undo(i, newest_.data());
+    }
+
+    size_t latest_at_or_before(uint64_t index) const {
+        size_t lo = 0, hi = snaps_.size() - 1;
+        while (lo < hi) {
+            size_t mid = (lo + hi + 1) / 2;
+            if (snaps_[mid].index <= index) lo = mid; else hi = mid - 1;
+        }
+        return lo;
+    }
+
+    void restore(size_t k) {
+        memcpy(mem_, newest_.data(), MEM_SIZE);
+        for (size_t i = snaps_.size() - 1; i-- > k;) apply_undo(i, mem_);
+
+        const Snapshot& s = snaps_[k];
+        cpu_.reg = s.cpu.reg;
+        cpu_.cycles = s.cpu.cycles;
+        cpu_.halted = s.cpu.halted;
+        cpu_.waiting = s.cpu.waiting;
+        cpu_.irq_pending = s.cpu.irq_pending;
+        cpu_.nmi_pending = s.cpu.nmi_pending;
+        if (io_) io_->rewind(s.io);
+        if (prng_) prng_->set_state(s.prng);
+        index_ = s.index;
+    }
+
+    Cpu& cpu_;
+    uint8_t* mem_;
+    IoLog* io_;
+    IoPrng* prng_;
+    Config config_;
+    StepHook step_hook_;
+    std::vector<uint8_t> newest_;  // memory at snaps_.back()
+    std::deque<Snapshot> snaps_;
+    size_t bytes_ = 0;
+    uint64_t index_ = 0;
+};
@@ -0,0 +1,278 @@
+//
+// AY-style sound generator for the 6502 machine (PWM + DMA output)
+//
+// Copyright 2026, John Clark
+//
+
+#include "sound.h"
+#include "spsc_ring.hpp"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+
+// Output configuration
+#define SOUND_PIN             18      // header pin 12 (PWM 1A)
+#define SOUND_SAMPLE_RATE     22050   // target sample rate (Hz)
+#define SOUND_BUFFER_SAMPLES  512     // per buffer (~23 ms, longer than a full display blit)
+#define SOUND_PWM_WRAP        1023    // 10-bit PWM, ~195 kHz carrier at 200 MHz
+#define SOUND_PSG_CLOCK_HZ    1000000 // emulated PSG master clock
+
+// Event queue (core 0 -> core 1)
+#define SOUND_EVENT_QUEUE_SIZE 256
+
+struct SoundEvent {
+    uint32_t cycle;
+    uint8_t reg;
+    uint8_t val;
+};
+
+static SpscRing<SoundEvent, SOUND_EVENT_QUEUE_SIZE> event_queue;
+static volatile uint32_t event_overflows = 0;
+
+// Latest emulated cycle published by core 0
+static volatile uint32_t cpu_cycle_now = 0;
+static volatile bool cpu_cycle_valid = false;
+
+// DMA ping-pong sample buffers
+static uint16_t sample_buf[2][SOUND_BUFFER_SAMPLES];
+static volatile bool buf_ready[2] = {false, false};
+static volatile uint32_t underruns = 0;
+static int dma_chan[2] = {-1, -1};
+
+// Logarithmic amplitude table (~3 dB per step)
+static const uint8_t volume_table[16] = {
+    0, 2, 3, 4, 6, 8, 11, 16, 23, 32, 45, 64, 90, 128, 180, 255
+};
+
+// PSG state (owned by core 1)
+static uint8_t regs[SOUND_NUM_REGS];
+static uint32_t tone_count[3];
+static uint8_t tone_out[3];
+static uint32_t noise_count = 0;
+static uint32_t noise_lfsr = 1;
+static uint8_t noise_out = 0;
+static uint32_t env_count = 0;
+static uint8_t env_step = 0;
+static bool env_attack = false;
+static bool env_holding = false;
+static uint8_t env_hold_level = 0;
+
+// Timing (16.16 fixed point)
+static uint32_t sample_rate = SOUND_SAMPLE_RATE;
+static uint32_t tone_tick_fp = 0;       // tone/noise ticks per sample
+static uint32_t env_tick_fp = 0;        // envelope ticks per sample
+static uint32_t cycles_per_sample_fp = 0;
+static uint32_t audio_cycle = 0;        // emulated cycle of the next sample
+static uint32_t audio_cycle_frac = 0;
+
+// Add an event to the queue (drop and count on overflow)
+static void event_put(uint32_t cycle, uint8_t reg, uint8_t val) {
+    if (!event_queue.push({cycle, reg, val})) {
+        event_overflows++;
+    }
+}
+
+// Apply a register write to the PSG state
+static void psg_write(uint8_t reg, uint8_t val) {
+    if (reg >= SOUND_NUM_REGS) return;
+    regs[reg] = val;
+    if (reg == 0x0D) {
+        // Restart envelope on shape write
+        env_step = 0;
+        env_count = 0;
+        env_attack = (val & 0x04) != 0;
+        env_holding = false;
+    }
+}
+
+static inline uint8_t env_level(void) {
+    if (env_holding) return env_hold_level;
+    return env_attack ? env_step : 15 - env_step;
+}
+
+static void env_advance(void) {
+    if (env_holding) return;
+    if (++env_step < 16) return;
+
+    uint8_t shape = regs[0x0D];
+    if (!(shape & 0x08)) {
+        // Single ramp, then silence
+        env_holding = true;
+        env_hold_level = 0;
+    } else if (shape & 0x01) {
+        // Hold at the end of the ramp (optionally alternated)
+        env_holding = true;
+        env_hold_level = (env_attack != ((shape & 0x02) != 0)) ? 15 : 0;
+    } else {
+        // Repeat, optionally alternating direction
+        if (shape & 0x02) env_attack = !env_attack;
+        env_step = 0;
+    }
+}
+
+// Generate one output sample (PWM level)
+static uint16_t psg_sample(void) {
+    // Tone generators
+    for (int ch = 0; ch < 3; ch++) {
+        uint32_t period = regs[ch * 2] | ((regs[ch * 2 + 1] & 0x0F) << 8);
+        uint32_t period_fp = (period ? period : 1) << 16;
+        tone_count[ch] += tone_tick_fp;
+        while (tone_count[ch] >= period_fp) {
+            tone_count[ch] -= period_fp;
+            tone_out[ch] ^= 1;
+        }
+    }
+
+    // Noise generator (17-bit LFSR)
+    uint32_t noise_period = regs[0x06] & 0x1F;
+    uint32_t noise_period_fp = (noise_period ? noise_period : 1) << 16;
+    noise_count += tone_tick_fp;
+    while (noise_count >= noise_period_fp) {
+        noise_count -= noise_period_fp;
+        uint32_t bit = (noise_lfsr ^ (noise_lfsr >> 3)) & 1;
+        noise_lfsr = (noise_lfsr >> 1) | (bit << 16);
+        noise_out = noise_lfsr & 1;
+    }
+
+    // Envelope generator (16 steps per ramp)
+    uint32_t env_period = regs[0x0B] | (regs[0x0C] << 8);
+    uint32_t env_period_fp = (env_period ? env_period : 1) << 16;
+    env_count += env_tick_fp;
+    while (env_count >= env_period_fp) {
+        env_count -= env_period_fp;
+        env_advance();
+    }
+
+    // Mixer
+    uint8_t mixer = regs[0x07];
+    uint32_t sum = 0;
+    for (int ch = 0; ch < 3; ch++) {
+        bool tone_on = tone_out[ch] || (mixer & (1 << ch));
+        bool noise_on = noise_out || (mixer & (8 << ch));
+        if (tone_on && noise_on) {
+            uint8_t amp = regs[0x08 + ch];
+            uint8_t level = (amp & 0x10) ? env_level() : (amp & 0x0F);
+            sum += volume_table[level];
+        }
+    }
+    return (uint16_t)((sum * SOUND_PWM_WRAP) / (3 * 255));
+}
+
+// Render a full buffer, replaying queued register writes at their cycle
+static void render_buffer(uint16_t *buf) {
+    uint32_t buffer_cycles = (uint32_t)(((uint64_t)cycles_per_sample_fp * SOUND_BUFFER_SAMPLES) >> 16);
+
+    // Track the CPU clock: stay one buffer behind the emulation, resync on large drift
+    if (cpu_cycle_valid) {
+        uint32_t target = cpu_cycle_now - buffer_cycles;
+        int32_t drift = (int32_t)(target - audio_cycle);
+        if (drift > (int32_t)(buffer_cycles * 2) || drift < -(int32_t)(buffer_cycles * 2)) {
+            audio_cycle = target;
+            audio_cycle_frac = 0;
+        }
+    }
+
+    for (int i = 0; i < SOUND_BUFFER_SAMPLES; i++) {
+        // Apply all writes that happened at or before this sample
+        while (const SoundEvent *ev = event_queue.peek()) {
+            if ((int32_t)(ev->cycle - audio_cycle) > 0) break;
+            psg_write(ev->reg, ev->val);
+            event_queue.drop();
+        }
+
+        buf[i] = psg_sample();
+
+        audio_cycle_frac += cycles_per_sample_fp;
+        audio_cycle += audio_cycle_frac >> 16;
+        audio_cycle_frac &= 0xFFFF;
+    }
+}
+
+// DMA completion: the chained channel is now playing the other buffer
+static void sound_dma_irq(void) {
+    for (int i = 0; i < 2; i++) {
+        if (dma_channel_get_irq1_status(dma_chan[i])) {
+            dma_channel_acknowledge_irq1(dma_chan[i]);
+            if (!buf_ready[i ^ 1]) underruns++;
+            buf_ready[i] = false;
+            dma_channel_set_read_addr(dma_chan[i], sample_buf[i], false);
+        }
+    }
+}
+
+void sound_init(uint32_t cpu_freq_hz) {
+    // PWM carrier
+    gpio_set_function(SOUND_PIN, GPIO_FUNC_PWM);
+    uint slice = pwm_gpio_to_slice_num(SOUND_PIN);
+    pwm_config cfg = pwm_get_default_config();
+    pwm_config_set_wrap(&cfg, SOUND_PWM_WRAP);
+    pwm_init(slice, &cfg, true);
+    pwm_set_gpio_level(SOUND_PIN, 0);
+
+    // DMA pacing timer at the sample rate
+    int timer = dma_claim_unused_timer(true);
+    uint32_t divisor = clock_get_hz(clk_sys) / SOUND_SAMPLE_RATE;
+    dma_timer_set_fraction(timer, 1, divisor);
+    sample_rate = clock_get_hz(clk_sys) / divisor;
+
+    // Synthesis rates (16.16 fixed point)
+    tone_tick_fp = (uint32_t)(((uint64_t)(SOUND_PSG_CLOCK_HZ / 16) << 16) / sample_rate);
+    env_tick_fp = (uint32_t)(((uint64_t)(SOUND_PSG_CLOCK_HZ / 256) << 16) / sample_rate);
+    cycles_per_sample_fp = (uint32_t)(((uint64_t)cpu_freq_hz << 16) / sample_rate);
+    regs[0x07] = 0x3F;  // all channels off
+
+    // Two chained channels, each playing one buffer then triggering the other
+    dma_chan[0] = dma_claim_unused_channel(true);
+    dma_chan[1] = dma_claim_unused_channel(true);
+    for (int i = 0; i < 2; i++) {
+        dma_channel_config c = dma_channel_get_default_config(dma_chan[i]);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_dreq(&c, dma_get_timer_dreq(timer));
+        channel_config_set_chain_to(&c, dma_chan[i ^ 1]);
+        dma_channel_configure(dma_chan[i], &c,
+                              &pwm_hw->slice[slice].cc,  // 16-bit writes replicate to A and B
+                              sample_buf[i],
+                              SOUND_BUFFER_SAMPLES,
+                              false);
+        dma_channel_set_irq1_enabled(dma_chan[i], true);
+    }
+    irq_set_exclusive_handler(DMA_IRQ_1, sound_dma_irq);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    // Prime both buffers and start playback
+    for (int i = 0; i < 2; i++) {
+        render_buffer(sample_buf[i]);
+        buf_ready[i] = true;
+    }
+    dma_channel_start(dma_chan[0]);
+}
+
+void sound_task(void) {
+    for (int i = 0; i < 2; i++) {
+        if (!buf_ready[i] && !dma_channel_is_busy(dma_chan[i])) {
+            render_buffer(sample_buf[i]);
+            buf_ready[i] = true;
+        }
+    }
+}
+
+void sound_write(uint8_t reg, uint8_t val, uint32_t cycle) {
+    event_put(cycle, reg, val);
+}
+
+void sound_sync(uint32_t cycle) {
+    cpu_cycle_now = cycle;
+    cpu_cycle_valid = true;
+}
+
+uint32_t sound_get_underruns(void) {
+    return underruns;
+}
+
+uint32_t sound_get_overflows(void) {
+    return event_overflows;
+}
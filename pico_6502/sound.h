@@ -0,0 +1,57 @@
+//
+// AY-style sound generator for the 6502 machine (PWM + DMA output)
+//
+// Copyright 2026, John Clark
+//
+// Register writes from the emulated CPU (core 0) are queued with their cycle
+// timestamp. Core 1 replays them into a double-buffered PWM sample stream fed
+// by DMA, so synthesis never steals cycles from the emulation loop.
+//
+// Register map (offset from SOUND_BASE):
+//   $00/$01  tone A period (12 bits, lo/hi)
+//   $02/$03  tone B period
+//   $04/$05  tone C period
+//   $06      noise period (5 bits)
+//   $07      mixer: bits 0-2 tone A/B/C off, bits 3-5 noise A/B/C off
+//   $08-$0A  amplitude A/B/C (bits 0-3 level, bit 4 = use envelope)
+//   $0B/$0C  envelope period (16 bits, lo/hi)
+//   $0D      envelope shape (CONT/ATT/ALT/HOLD)
+//   $10/$11  underrun count (read only, lo/hi)
+//
+
+#ifndef _SOUND_H_
+#define _SOUND_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SOUND_NUM_REGS      16
+#define SOUND_REG_UNDERRUN  0x10
+
+// Initialize PWM/DMA output - must be called from the core that renders (core 1)
+void sound_init(uint32_t cpu_freq_hz);
+
+// Render any free sample buffers - call regularly from the core 1 loop
+void sound_task(void);
+
+// Queue a register write at the given emulated cycle (core 0)
+void sound_write(uint8_t reg, uint8_t val, uint32_t cycle);
+
+// Publish the current emulated cycle so core 1 can track the CPU clock (core 0)
+void sound_sync(uint32_t cycle);
+
+// Number of times the DMA started a buffer that was not rendered in time
+uint32_t sound_get_underruns(void);
+
+// Number of register writes dropped because the event queue was full
+uint32_t sound_get_overflows(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SOUND_H_
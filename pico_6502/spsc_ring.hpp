@@ -0,0 +1,122 @@
+//
+//  Lock-free single-producer/single-consumer ring for cross-core queues
+//
+//  Copyright 2026, John Clark
+//
+//  Released under the GNU General Public License
+//  https://www.gnu.org/licenses/gpl.html
+//
+//  One core (or IRQ handler) pushes, one other pops. The producer publishes
+//  the head with release ordering after writing the slot, and the consumer
+//  acquires it before reading, so a popped element is always fully written;
+//  the tail works the same way in the other direction. Indices run freely and
+//  are masked on access, which lets all N slots be used.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Head and tail live on separate lines so producer and consumer do not share
+// one (RP2350 SRAM is uncached, but the host tests run on cached machines)
+#ifndef SPSC_CACHE_LINE
+#define SPSC_CACHE_LINE 64
+#endif
+
+template<typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+    static_assert(N <= (1u << 31), "SpscRing size must fit the 32-bit index space");
+    static constexpr uint32_t MASK = N - 1;
+
+public:
+    static constexpr size_t capacity() { return N; }
+
+    // ---------- Producer side ----------
+
+    // Append one element; false (and nothing written) when full
+    bool push(const T& item) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == N) return false;
+        buf_[head & MASK] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Append up to count elements, publishing them together; returns the number written
+    size_t push(const T* items, size_t count) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        size_t space = N - (head - tail_.load(std::memory_order_acquire));
+        if (count > space) count = space;
+        for (size_t i = 0; i < count; i++) {
+            buf_[(head + i) & MASK] = items[i];
+        }
+        head_.store(head + (uint32_t)count, std::memory_order_release);
+        return count;
+    }
+
+    bool full() const {
+        return head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire) == N;
+    }
+
+    // ---------- Consumer side ----------
+
+    // Remove one element into item; false when empty
+    bool pop(T& item) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (head_.load(std::memory_order_acquire) == tail) return false;
+        item = buf_[tail & MASK];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Remove up to count elements into items; returns the number read
+    size_t pop(T* items, size_t count) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        size_t avail = head_.load(std::memory_order_acquire) - tail;
+        if (count > avail) count = avail;
+        for (size_t i = 0; i < count; i++) {
+            items[i] = buf_[(tail + i) & MASK];
+        }
+        tail_.store(tail + (uint32_t)count, std::memory_order_release);
+        return count;
+    }
+
+    // Oldest element without removing it (nullptr when empty); valid until drop()
+    const T* peek() const {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (head_.load(std::memory_order_acquire) == tail) return nullptr;
+        return &buf_[tail & MASK];
+    }
+
+    // Discard the oldest element (after peek)
+    void drop() {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (head_.load(std::memory_order_acquire) != tail) {
+            tail_.store(tail + 1, std::memory_order_release);
+        }
+    }
+
+    // Discard everything currently queued
+    void clear() {
+        tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_relaxed);
+    }
+
+    // ---------- Either side ----------
+
+    // Snapshot of the element count (exact only on the producer or consumer)
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> head_{0};  // written by the producer
+    alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> tail_{0};  // written by the consumer
+    alignas(SPSC_CACHE_LINE) T buf_[N];
+};
@@ -0,0 +1,267 @@
+//
+// Blitter tests
+//
+// Copyright 2026, John Clark
+//
+// Checks fill, copy and masked copy against byte-at-a-time references,
+// including rectangles with strides, overlapping copies in both directions,
+// 64K wraparound, the cycle cost and the dirty span. Then runs a 6502 program
+// that clears the screen through the $D600 registers and compares its cycle
+// count with the same clear done by a CPU loop.
+//
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "w65c02s.hpp"
+#include "ram.hpp"
+#include "blitter.hpp"
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+static constexpr uint16_t BASE = 0xD600;
+
+static std::vector<uint8_t> mem(0x10000);
+
+static void set_regs(uint16_t src, uint16_t dst, uint16_t width, uint8_t height = 0,
+                     uint8_t src_stride = 0, uint8_t dst_stride = 0, uint8_t value = 0, uint8_t cost = 16) {
+    mem[BASE + BLIT_SRC] = src & 0xff;
+    mem[BASE + BLIT_SRC + 1] = src >> 8;
+    mem[BASE + BLIT_DST] = dst & 0xff;
+    mem[BASE + BLIT_DST + 1] = dst >> 8;
+    mem[BASE + BLIT_WIDTH] = width & 0xff;
+    mem[BASE + BLIT_WIDTH + 1] = width >> 8;
+    mem[BASE + BLIT_HEIGHT] = height;
+    mem[BASE + BLIT_SRC_STRIDE] = src_stride;
+    mem[BASE + BLIT_DST_STRIDE] = dst_stride;
+    mem[BASE + BLIT_VALUE] = value;
+    mem[BASE + BLIT_COST] = cost;
+}
+
+static void pattern() {
+    for (size_t i = 0; i < mem.size(); i++) mem[i] = (uint8_t)(i * 7 + (i >> 8));
+}
+
+// Byte-at-a-time rectangle copy through a temporary (overlap-safe by construction)
+static std::vector<uint8_t> reference_copy(uint16_t src, uint16_t dst, int w, int h, int ss, int ds,
+                                           bool masked = false, uint8_t key = 0) {
+    std::vector<uint8_t> out = mem;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            uint8_t b = mem[(uint16_t)(src + y * ss + x)];
+            if (!masked || b != key) out[(uint16_t)(dst + y * ds + x)] = b;
+        }
+    }
+    return out;
+}
+
+static void test_fill() {
+    printf("fill:\n");
+    Blitter blit(mem.data(), BASE);
+    pattern();
+    set_regs(0, 0x0200, 1024, 0, 0, 0, 0x05);
+    uint32_t cycles = blit.run(BLIT_FILL);
+    bool ok = mem[0x01ff] != 0x05 && mem[0x0600] != 0x05;
+    for (int i = 0x200; i < 0x600; i++) ok &= mem[i] == 0x05;
+    TEST_ASSERT("linear fill", ok);
+    TEST_ASSERT("cost is one cycle per byte at 16", cycles == 1024);
+
+    pattern();
+    std::vector<uint8_t> before = mem;
+    set_regs(0, 0x2000 + 3 * 64 + 5, 10, 4, 0, 64, 0xaa, 4);
+    cycles = blit.run(BLIT_FILL);
+    ok = true;
+    for (int i = 0x2000; i < 0x3000; i++) {
+        int x = (i - 0x2000) % 64, y = (i - 0x2000) / 64;
+        bool inside = x >= 5 && x < 15 && y >= 3 && y < 7;
+        ok &= mem[i] == (inside ? 0xaa : before[i]);
+    }
+    TEST_ASSERT("rectangle fill with stride", ok);
+    TEST_ASSERT("cost rounds up per 16 bytes", cycles == (40 * 4 + 15) / 16);
+
+    set_regs(0, 0x0200, 0, 0, 0, 0, 0x11);
+    before = mem;
+    TEST_ASSERT("zero width does nothing", blit.run(BLIT_FILL) == 0 && mem == before);
+    set_regs(0, 0x0200, 16);
+    before = mem;
+    TEST_ASSERT("unknown command does nothing", blit.run(9) == 0 && mem == before);
+}
+
+static void test_copy() {
+    printf("copy:\n");
+    Blitter blit(mem.data(), BASE);
+
+    pattern();
+    set_regs(0x1000, 0x3000, 700);
+    auto expect = reference_copy(0x1000, 0x3000, 700, 1, 700, 700);
+    blit.run(BLIT_COPY);
+    TEST_ASSERT("linear copy", mem == expect);
+
+    // Scroll the 32x32 screen up one row, then down one row (overlapping both ways)
+    pattern();
+    set_regs(0x0220, 0x0200, 32 * 31);
+    expect = reference_copy(0x0220, 0x0200, 32 * 31, 1, 0, 0);
+    blit.run(BLIT_COPY);
+    TEST_ASSERT("overlapping copy down in memory", mem == expect);
+
+    pattern();
+    set_regs(0x0200, 0x0220, 32 * 31);
+    expect = reference_copy(0x0200, 0x0220, 32 * 31, 1, 0, 0);
+    blit.run(BLIT_COPY);
+    TEST_ASSERT("overlapping copy up in memory", mem == expect);
+
+    // 8x8 sprite box moved one row down and one column right inside a 64-wide screen
+    pattern();
+    set_regs(0x2000 + 10 * 64 + 10, 0x2000 + 11 * 64 + 11, 8, 8, 64, 64);
+    expect = reference_copy(0x2000 + 10 * 64 + 10, 0x2000 + 11 * 64 + 11, 8, 8, 64, 64);
+    blit.run(BLIT_COPY);
+    TEST_ASSERT("overlapping rectangle copy", mem == expect);
+
+    pattern();
+    set_regs(0x2000 + 11 * 64 + 11, 0x2000 + 10 * 64 + 10, 8, 8, 64, 64);
+    expect = reference_copy(0x2000 + 11 * 64 + 11, 0x2000 + 10 * 64 + 10, 8, 8, 64, 64);
+    blit.run(BLIT_COPY);
+    TEST_ASSERT("overlapping rectangle copy back", mem == expect);
+
+    // Sprite sheet with a different stride than the screen
+    pattern();
+    set_regs(0x4000, 0x0200 + 5 * 32 + 3, 6, 5, 16, 32);
+    expect = reference_copy(0x4000, 0x0200 + 5 * 32 + 3, 6, 5, 16, 32);
+    blit.run(BLIT_COPY);
+    TEST_ASSERT("copy between strides", mem == expect);
+
+    pattern();
+    set_regs(0xfff0, 0x0000, 40, 0, 0, 0, 0, 0);
+    expect = reference_copy(0xfff0, 0x0000, 40, 1, 40, 40);
+    TEST_ASSERT("copy wraps at 64K and cost 0 is free", blit.run(BLIT_COPY) == 0 && mem == expect);
+}
+
+static void test_masked() {
+    printf("masked copy:\n");
+    Blitter blit(mem.data(), BASE);
+    pattern();
+    for (int i = 0; i < 64; i++) mem[0x4000 + i] = (i % 3) ? (uint8_t)(i + 1) : 0;  // 0 = transparent
+    set_regs(0x4000, 0x0200 + 32 * 4, 8, 8, 8, 32, 0);
+    auto expect = reference_copy(0x4000, 0x0200 + 32 * 4, 8, 8, 8, 32, true, 0);
+    blit.run(BLIT_COPY_MASKED);
+    TEST_ASSERT("transparent bytes keep the destination", mem == expect);
+
+    pattern();
+    set_regs(0x0300, 0x0301, 200, 0, 0, 0, 0x15);
+    expect = reference_copy(0x0300, 0x0301, 200, 1, 200, 200, true, 0x15);
+    blit.run(BLIT_COPY_MASKED);
+    TEST_ASSERT("overlapping masked copy", mem == expect);
+}
+
+static void test_dirty() {
+    printf("dirty span:\n");
+    Blitter blit(mem.data(), BASE);
+    set_regs(0, 0x0300, 8, 4, 0, 32, 1);
+    blit.run(BLIT_FILL);
+    TEST_ASSERT("span covers the rectangle", blit.dirty_begin() == 0x0300 && blit.dirty_len() == 3 * 32 + 8);
+    TEST_ASSERT("overlaps the 32x32 screen", blit.dirtied(0x0200, 1024));
+    TEST_ASSERT("misses the hires page", !blit.dirtied(0x2000, 0x2000));
+
+    set_regs(0x1000, 0xfff8, 16);
+    blit.run(BLIT_COPY);
+    TEST_ASSERT("wrapped span touches page 0", blit.dirtied(0x0000, 16) && blit.dirtied(0xfff0, 16));
+    TEST_ASSERT("wrapped span misses the screen", !blit.dirtied(0x0200, 1024));
+}
+
+// ---------- Program ----------
+
+// Clear the 32x32 screen to color 6 with a CPU loop, then with the blitter
+static const uint16_t load_addr = 0x0600;
+static const uint8_t cpu_clear[] = {
+    0xa9, 0x06,             // $0600  lda #$06
+    0xa2, 0x00,             // $0602  ldx #$00
+    0x9d, 0x00, 0x02,       // $0604  sta $0200,x
+    0x9d, 0x00, 0x03,       // $0607  sta $0300,x
+    0x9d, 0x00, 0x04,       // $060a  sta $0400,x
+    0x9d, 0x00, 0x05,       // $060d  sta $0500,x
+    0xe8,                   // $0610  inx
+    0xd0, 0xf1,             // $0611  bne $0604
+    0xdb,                   // $0613  stp
+};
+static const uint8_t blit_clear[] = {
+    0xa9, 0x00,             // $0600  lda #$00
+    0x8d, 0x02, 0xd6,       // $0602  sta $d602
+    0x8d, 0x04, 0xd6,       // $0605  sta $d604
+    0xa9, 0x02,             // $0608  lda #$02
+    0x8d, 0x03, 0xd6,       // $060a  sta $d603
+    0xa9, 0x04,             // $060d  lda #$04
+    0x8d, 0x05, 0xd6,       // $060f  sta $d605
+    0xa9, 0x06,             // $0612  lda #$06
+    0x8d, 0x09, 0xd6,       // $0614  sta $d609
+    0xa9, 0x01,             // $0617  lda #$01
+    0x8d, 0x0f, 0xd6,       // $0619  sta $d60f
+    0xdb,                   // $061c  stp
+};
+
+static HookedRam ram;
+static W65C02S cpu;
+static Blitter ram_blitter(ram.data(), BASE);
+
+static void blitter_write_hook(uint16_t addr, uint8_t val, void*) {
+    if ((addr & 0xff) == BLIT_COMMAND) cpu.cycles += ram_blitter.run(val);
+}
+
+static uint64_t run_clear(const uint8_t* code, size_t size, uint8_t cost) {
+    ram.reset();
+    ram.load(load_addr, code, size);
+    ram[BASE + BLIT_COST] = cost;
+    ram.set_write_hook(BASE >> 8, blitter_write_hook);
+    HookedRam::set_instance(&ram);
+    cpu.ram_read = &HookedRam::static_read;
+    cpu.ram_write = &HookedRam::static_write;
+    cpu.reset();
+    cpu.reg.pc = load_addr;
+    while (!cpu.halted) cpu.step();
+    return cpu.cycles;
+}
+
+static bool screen_is(uint8_t color) {
+    for (int i = 0x200; i < 0x600; i++) {
+        if (ram[i] != color) return false;
+    }
+    return ram[0x1ff] == 0;  // program code follows at $0600
+}
+
+static void test_program() {
+    printf("program:\n");
+    uint64_t loop = run_clear(cpu_clear, sizeof(cpu_clear), 16);
+    bool loop_ok = screen_is(6);
+    uint64_t blit = run_clear(blit_clear, sizeof(blit_clear), 16);
+    bool blit_ok = screen_is(6);
+    uint64_t free_blit = run_clear(blit_clear, sizeof(blit_clear), 0);
+    printf("  clear 1024 bytes: cpu loop %llu cycles, blitter %llu cycles (%llu at cost 0)\n",
+           (unsigned long long)loop, (unsigned long long)blit, (unsigned long long)free_blit);
+    TEST_ASSERT("both clear the screen", loop_ok && blit_ok);
+    TEST_ASSERT("blit cost charged to the CPU", blit == free_blit + 1024);
+    TEST_ASSERT("blitter beats the loop", blit * 4 < loop);
+}
+
+int main() {
+    printf("Blitter tests\n\n");
+
+    test_fill();
+    test_copy();
+    test_masked();
+    test_dirty();
+    test_program();
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,296 @@
+//
+// Per-opcode test vectors for the compile-time CPU variants
+//
+// Copyright 2026, John Clark
+//
+// Each vector loads registers and memory, executes one instruction and checks
+// the resulting registers, memory and cycle count. The same opcode is run
+// against every variant where their behavior differs.
+//
+
+#include <cstdio>
+#include <vector>
+#include "w65c02s.hpp"
+#include "ram.hpp"
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+// ---------- Test vectors ----------
+
+// Status flag bits
+enum : uint8_t { N = 0x80, V = 0x40, U = 0x20, B = 0x10, D = 0x08, I = 0x04, Z = 0x02, C = 0x01 };
+
+struct Regs {
+    uint16_t pc;
+    uint8_t a, x, y, sp, p;
+};
+
+struct MemByte {
+    uint16_t addr;
+    uint8_t val;
+};
+
+struct OpcodeVector {
+    const char* name;
+    Regs initial;
+    std::vector<MemByte> ram_in;
+    Regs final;
+    std::vector<MemByte> ram_out;
+    int cycles;
+    bool halted = false;
+};
+
+static SimpleRam ram;
+
+template<typename Cpu>
+static bool run_vector(const OpcodeVector& v) {
+    Cpu cpu;
+    ram.reset();
+    SimpleRam::set_instance(&ram);
+    cpu.ram_read = &SimpleRam::static_read;
+    cpu.ram_write = &SimpleRam::static_write;
+
+    cpu.reset();
+    cpu.reg.pc = v.initial.pc;
+    cpu.reg.a = v.initial.a;
+    cpu.reg.x = v.initial.x;
+    cpu.reg.y = v.initial.y;
+    cpu.reg.sp = v.initial.sp;
+    cpu.reg.flag.set_value(v.initial.p);
+    for (const auto& m : v.ram_in) ram[m.addr] = m.val;
+
+    int cycles = cpu.step();
+
+    bool ok = true;
+    const Regs& f = v.final;
+    if (cpu.reg.pc != f.pc || cpu.reg.a != f.a || cpu.reg.x != f.x || cpu.reg.y != f.y ||
+        cpu.reg.sp != f.sp || cpu.reg.flag.value() != f.p) {
+        printf("    regs: pc=%04X a=%02X x=%02X y=%02X sp=%02X p=%02X, expected pc=%04X a=%02X x=%02X y=%02X sp=%02X p=%02X\n",
+               cpu.reg.pc, cpu.reg.a, cpu.reg.x, cpu.reg.y, cpu.reg.sp, cpu.reg.flag.value(),
+               f.pc, f.a, f.x, f.y, f.sp, f.p);
+        ok = false;
+    }
+    for (const auto& m : v.ram_out) {
+        if (ram[m.addr] != m.val) {
+            printf("    ram[$%04X]=%02X, expected %02X\n", m.addr, ram[m.addr], m.val);
+            ok = false;
+        }
+    }
+    if (cycles != v.cycles) {
+        printf("    cycles=%d, expected %d\n", cycles, v.cycles);
+        ok = false;
+    }
+    if (cpu.halted != v.halted) {
+        printf("    halted=%d, expected %d\n", cpu.halted, v.halted);
+        ok = false;
+    }
+    return ok;
+}
+
+template<typename Cpu>
+static void run_vectors(const std::vector<OpcodeVector>& vectors) {
+    for (const auto& v : vectors) {
+        char name[96];
+        snprintf(name, sizeof(name), "%s: %s", Cpu::Variant::name, v.name);
+        TEST_ASSERT(name, run_vector<Cpu>(v));
+    }
+}
+
+// Behavior shared by every variant
+static const std::vector<OpcodeVector> common_vectors = {
+    {"sta abs,x always takes the index cycle",
+     {0x0400, 0x77, 0x01, 0x00, 0xff, U}, {{0x0400, 0x9d}, {0x0401, 0x00}, {0x0402, 0x20}},
+     {0x0403, 0x77, 0x01, 0x00, 0xff, U}, {{0x2001, 0x77}}, 5},
+    {"sta (zp),y always takes the index cycle",
+     {0x0400, 0x77, 0x00, 0x01, 0xff, U}, {{0x0400, 0x91}, {0x0401, 0x10}, {0x0010, 0x00}, {0x0011, 0x20}},
+     {0x0402, 0x77, 0x00, 0x01, 0xff, U}, {{0x2001, 0x77}}, 6},
+    {"inc abs,x",
+     {0x0400, 0x00, 0x01, 0x00, 0xff, U}, {{0x0400, 0xfe}, {0x0401, 0x00}, {0x0402, 0x20}, {0x2001, 0x7f}},
+     {0x0403, 0x00, 0x01, 0x00, 0xff, U | N}, {{0x2001, 0x80}}, 7},
+    {"pha",
+     {0x0400, 0x5a, 0x00, 0x00, 0xff, U}, {{0x0400, 0x48}},
+     {0x0401, 0x5a, 0x00, 0x00, 0xfe, U}, {{0x01ff, 0x5a}}, 3},
+    {"lda abs,y page cross",
+     {0x0400, 0x00, 0x00, 0x01, 0xff, U}, {{0x0400, 0xb9}, {0x0401, 0xff}, {0x0402, 0x20}, {0x2100, 0x42}},
+     {0x0403, 0x42, 0x00, 0x01, 0xff, U}, {}, 5},
+    {"adc binary overflow",
+     {0x0400, 0x7f, 0x00, 0x00, 0xff, U}, {{0x0400, 0x69}, {0x0401, 0x01}},
+     {0x0402, 0x80, 0x00, 0x00, 0xff, U | N | V}, {}, 2},
+};
+
+// NMOS 6502
+static const std::vector<OpcodeVector> nmos_vectors = {
+    {"jmp ($10ff) wraps within the page",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0x6c}, {0x0401, 0xff}, {0x0402, 0x10}, {0x10ff, 0x34}, {0x1000, 0x12}, {0x1100, 0x56}},
+     {0x1234, 0x00, 0x00, 0x00, 0xff, U}, {}, 5},
+    {"adc decimal: n/v intermediate, z binary",
+     {0x0400, 0x99, 0x00, 0x00, 0xff, U | D}, {{0x0400, 0x69}, {0x0401, 0x01}},
+     {0x0402, 0x00, 0x00, 0x00, 0xff, U | D | N | C}, {}, 2},
+    {"sbc decimal: flags from binary result",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U | D | C}, {{0x0400, 0xe9}, {0x0401, 0x01}},
+     {0x0402, 0x99, 0x00, 0x00, 0xff, U | D | N}, {}, 2},
+    {"brk leaves d set",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U | D}, {{0x0400, 0x00}, {0xfffe, 0x00}, {0xffff, 0x30}},
+     {0x3000, 0x00, 0x00, 0x00, 0xfc, U | D | I}, {{0x01ff, 0x04}, {0x01fe, 0x02}, {0x01fd, U | D | B}}, 7},
+    {"asl abs,x always 7",
+     {0x0400, 0x00, 0x01, 0x00, 0xff, U}, {{0x0400, 0x1e}, {0x0401, 0x00}, {0x0402, 0x20}, {0x2001, 0x01}},
+     {0x0403, 0x00, 0x01, 0x00, 0xff, U}, {{0x2001, 0x02}}, 7},
+    {"lax zp",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0xa7}, {0x0401, 0x10}, {0x0010, 0x84}},
+     {0x0402, 0x84, 0x84, 0x00, 0xff, U | N}, {{0x0010, 0x84}}, 3},
+    {"sax zp,y",
+     {0x0400, 0xf0, 0x3c, 0x01, 0xff, U}, {{0x0400, 0x97}, {0x0401, 0x10}},
+     {0x0402, 0xf0, 0x3c, 0x01, 0xff, U}, {{0x0011, 0x30}}, 4},
+    {"dcp abs,x",
+     {0x0400, 0x42, 0x01, 0x00, 0xff, U}, {{0x0400, 0xdf}, {0x0401, 0x00}, {0x0402, 0x20}, {0x2001, 0x43}},
+     {0x0403, 0x42, 0x01, 0x00, 0xff, U | Z | C}, {{0x2001, 0x42}}, 7},
+    {"isc zp",
+     {0x0400, 0x10, 0x00, 0x00, 0xff, U | C}, {{0x0400, 0xe7}, {0x0401, 0x10}, {0x0010, 0x0f}},
+     {0x0402, 0x00, 0x00, 0x00, 0xff, U | Z | C}, {{0x0010, 0x10}}, 5},
+    {"slo (zp),y",
+     {0x0400, 0x02, 0x00, 0x01, 0xff, U}, {{0x0400, 0x13}, {0x0401, 0x10}, {0x0010, 0xff}, {0x0011, 0x20}, {0x2100, 0x81}},
+     {0x0402, 0x02, 0x00, 0x01, 0xff, U | C}, {{0x2100, 0x02}}, 8},
+    {"rla (zp,x)",
+     {0x0400, 0xff, 0x02, 0x00, 0xff, U | C}, {{0x0400, 0x23}, {0x0401, 0x10}, {0x0012, 0x00}, {0x0013, 0x30}, {0x3000, 0x40}},
+     {0x0402, 0x81, 0x02, 0x00, 0xff, U | N}, {{0x3000, 0x81}}, 8},
+    {"sre abs",
+     {0x0400, 0x01, 0x00, 0x00, 0xff, U}, {{0x0400, 0x4f}, {0x0401, 0x00}, {0x0402, 0x30}, {0x3000, 0x03}},
+     {0x0403, 0x00, 0x00, 0x00, 0xff, U | Z | C}, {{0x3000, 0x01}}, 6},
+    {"rra abs,y",
+     {0x0400, 0x01, 0x00, 0x01, 0xff, U}, {{0x0400, 0x7b}, {0x0401, 0x00}, {0x0402, 0x30}, {0x3001, 0x02}},
+     {0x0403, 0x02, 0x00, 0x01, 0xff, U}, {{0x3001, 0x01}}, 7},
+    {"anc #imm",
+     {0x0400, 0xf0, 0x00, 0x00, 0xff, U}, {{0x0400, 0x0b}, {0x0401, 0x80}},
+     {0x0402, 0x80, 0x00, 0x00, 0xff, U | N | C}, {}, 2},
+    {"alr #imm",
+     {0x0400, 0x03, 0x00, 0x00, 0xff, U}, {{0x0400, 0x4b}, {0x0401, 0xff}},
+     {0x0402, 0x01, 0x00, 0x00, 0xff, U | C}, {}, 2},
+    {"arr #imm",
+     {0x0400, 0xff, 0x00, 0x00, 0xff, U | C}, {{0x0400, 0x6b}, {0x0401, 0xff}},
+     {0x0402, 0xff, 0x00, 0x00, 0xff, U | N | C}, {}, 2},
+    {"sbx #imm",
+     {0x0400, 0x0f, 0xfc, 0x00, 0xff, U}, {{0x0400, 0xcb}, {0x0401, 0x02}},
+     {0x0402, 0x0f, 0x0a, 0x00, 0xff, U | C}, {}, 2},
+    {"las abs,y",
+     {0x0400, 0x00, 0x00, 0x00, 0xf3, U}, {{0x0400, 0xbb}, {0x0401, 0x00}, {0x0402, 0x30}, {0x3000, 0x3f}},
+     {0x0403, 0x33, 0x33, 0x00, 0x33, U}, {}, 4},
+    {"shx abs,y page cross replaces the high byte",
+     {0x0400, 0x00, 0xff, 0x01, 0xff, U}, {{0x0400, 0x9e}, {0x0401, 0xff}, {0x0402, 0x20}},
+     {0x0403, 0x00, 0xff, 0x01, 0xff, U}, {{0x2100, 0x21}}, 5},
+    {"nop zp,x",
+     {0x0400, 0x00, 0x01, 0x00, 0xff, U}, {{0x0400, 0x74}, {0x0401, 0x10}, {0x0011, 0x55}},
+     {0x0402, 0x00, 0x01, 0x00, 0xff, U}, {{0x0011, 0x55}}, 4},
+    {"nop #imm",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0x80}, {0x0401, 0x02}},
+     {0x0402, 0x00, 0x00, 0x00, 0xff, U}, {}, 2},
+    {"nop abs,x page cross",
+     {0x0400, 0x00, 0x01, 0x00, 0xff, U}, {{0x0400, 0x1c}, {0x0401, 0xff}, {0x0402, 0x20}},
+     {0x0403, 0x00, 0x01, 0x00, 0xff, U}, {}, 5},
+    {"jam",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0x02}},
+     {0x0401, 0x00, 0x00, 0x00, 0xff, U}, {}, 2, true},
+};
+
+// Behavior shared by every CMOS variant
+static const std::vector<OpcodeVector> cmos_vectors = {
+    {"jmp ($10ff) crosses the page",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0x6c}, {0x0401, 0xff}, {0x0402, 0x10}, {0x10ff, 0x34}, {0x1000, 0x12}, {0x1100, 0x56}},
+     {0x5634, 0x00, 0x00, 0x00, 0xff, U}, {}, 6},
+    {"adc decimal: valid n/z, extra cycle",
+     {0x0400, 0x99, 0x00, 0x00, 0xff, U | D}, {{0x0400, 0x69}, {0x0401, 0x01}},
+     {0x0402, 0x00, 0x00, 0x00, 0xff, U | D | Z | C}, {}, 3},
+    {"sbc decimal: valid n/z, extra cycle",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U | D | C}, {{0x0400, 0xe9}, {0x0401, 0x01}},
+     {0x0402, 0x99, 0x00, 0x00, 0xff, U | D | N}, {}, 3},
+    {"brk clears d",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U | D}, {{0x0400, 0x00}, {0xfffe, 0x00}, {0xffff, 0x30}},
+     {0x3000, 0x00, 0x00, 0x00, 0xfc, U | I}, {{0x01ff, 0x04}, {0x01fe, 0x02}, {0x01fd, U | D | B}}, 7},
+    {"asl abs,x no page cross",
+     {0x0400, 0x00, 0x01, 0x00, 0xff, U}, {{0x0400, 0x1e}, {0x0401, 0x00}, {0x0402, 0x20}, {0x2001, 0x01}},
+     {0x0403, 0x00, 0x01, 0x00, 0xff, U}, {{0x2001, 0x02}}, 6},
+    {"asl abs,x page cross",
+     {0x0400, 0x00, 0x01, 0x00, 0xff, U}, {{0x0400, 0x1e}, {0x0401, 0xff}, {0x0402, 0x20}, {0x2100, 0x01}},
+     {0x0403, 0x00, 0x01, 0x00, 0xff, U}, {{0x2100, 0x02}}, 7},
+    {"stz zp,x",
+     {0x0400, 0x00, 0x01, 0x00, 0xff, U}, {{0x0400, 0x74}, {0x0401, 0x10}, {0x0011, 0x55}},
+     {0x0402, 0x00, 0x01, 0x00, 0xff, U}, {{0x0011, 0x00}}, 4},
+    {"bra",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0x80}, {0x0401, 0x02}},
+     {0x0404, 0x00, 0x00, 0x00, 0xff, U}, {}, 3},
+    {"undefined $02 is a 2-byte nop",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0x02}},
+     {0x0402, 0x00, 0x00, 0x00, 0xff, U}, {}, 2},
+    {"undefined $0b is a 1-byte nop",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0x0b}},
+     {0x0401, 0x00, 0x00, 0x00, 0xff, U}, {}, 1},
+};
+
+// RMB/SMB/BBR/BBS present (Rockwell and WDC)
+static const std::vector<OpcodeVector> bit_op_vectors = {
+    {"smb2 zp",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0xa7}, {0x0401, 0x10}, {0x0010, 0x80}},
+     {0x0402, 0x00, 0x00, 0x00, 0xff, U}, {{0x0010, 0x84}}, 5},
+    {"rmb2 zp",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0x27}, {0x0401, 0x10}, {0x0010, 0x84}},
+     {0x0402, 0x00, 0x00, 0x00, 0xff, U}, {{0x0010, 0x80}}, 5},
+    {"bbs7 zp taken",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0xff}, {0x0401, 0x10}, {0x0402, 0x04}, {0x0010, 0x80}},
+     {0x0407, 0x00, 0x00, 0x00, 0xff, U}, {}, 6},
+};
+
+// RMB/SMB/BBR/BBS absent (original 65C02)
+static const std::vector<OpcodeVector> no_bit_op_vectors = {
+    {"$a7 is a 1-byte nop",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0xa7}, {0x0401, 0x10}, {0x0010, 0x80}},
+     {0x0401, 0x00, 0x00, 0x00, 0xff, U}, {{0x0010, 0x80}}, 1},
+};
+
+// WAI/STP present (WDC)
+static const std::vector<OpcodeVector> wai_stp_vectors = {
+    {"stp",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0xdb}},
+     {0x0401, 0x00, 0x00, 0x00, 0xff, U}, {}, 3, true},
+};
+
+// WAI/STP absent (65C02 and Rockwell)
+static const std::vector<OpcodeVector> no_wai_stp_vectors = {
+    {"$db is a 1-byte nop",
+     {0x0400, 0x00, 0x00, 0x00, 0xff, U}, {{0x0400, 0xdb}},
+     {0x0401, 0x00, 0x00, 0x00, 0xff, U}, {}, 1},
+};
+
+template<typename Cpu>
+static void run_variant() {
+    using V = typename Cpu::Variant;
+    printf("\n[%s]\n", V::name);
+    run_vectors<Cpu>(common_vectors);
+    run_vectors<Cpu>(V::cmos ? cmos_vectors : nmos_vectors);
+    if (V::cmos) {
+        run_vectors<Cpu>(V::bit_ops ? bit_op_vectors : no_bit_op_vectors);
+        run_vectors<Cpu>(V::wai_stp ? wai_stp_vectors : no_wai_stp_vectors);
+    }
+}
+
+int main() {
+    printf("CPU variant test vectors\n");
+
+    run_variant<NMOS6502>();
+    run_variant<C65C02>();
+    run_variant<R65C02>();
+    run_variant<W65C02S>();
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
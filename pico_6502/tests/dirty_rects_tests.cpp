@@ -0,0 +1,162 @@
+//
+// Dirty rectangle tracker tests
+//
+// Copyright 2026, John Clark
+//
+// Feeds dirty_rects_add the kinds of damage the emulator produces (single
+// pixels, runs, rows, scattered sprites) and checks that every damaged pixel
+// stays covered, the slot limit holds, and merging only happens when it is
+// cheap or forced.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "ili9488/dirty_rects.h"
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+// ---------- Reference ----------
+
+// Pixels damaged so far, to check the rectangles cover all of them
+static const int W = 128, H = 96;
+static bool damaged[H][W];
+
+static void add(dirty_rects_t* d, int x0, int y0, int x1, int y1) {
+    for (int y = y0; y <= y1; y++)
+        for (int x = x0; x <= x1; x++) damaged[y][x] = true;
+    dirty_rects_add(d, x0, y0, x1, y1);
+}
+
+static void reset(dirty_rects_t* d, uint32_t merge_cost) {
+    memset(damaged, 0, sizeof(damaged));
+    dirty_rects_init(d, merge_cost);
+}
+
+static bool covered(const dirty_rects_t* d) {
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (!damaged[y][x]) continue;
+            bool in = false;
+            for (int i = 0; i < d->count && !in; i++) {
+                const dirty_rect_t& r = d->rect[i];
+                in = x >= r.x0 && x <= r.x1 && y >= r.y0 && y <= r.y1;
+            }
+            if (!in) return false;
+        }
+    }
+    return true;
+}
+
+static bool is_rect(const dirty_rect_t& r, int x0, int y0, int x1, int y1) {
+    return r.x0 == x0 && r.y0 == y0 && r.x1 == x1 && r.y1 == y1;
+}
+
+// ---------- Tests ----------
+
+static void test_merging() {
+    printf("merging:\n");
+    dirty_rects_t d;
+
+    reset(&d, 0);
+    TEST_ASSERT("starts empty", d.count == 0 && dirty_rects_area(&d) == 0);
+    add(&d, 5, 5, 5, 5);
+    TEST_ASSERT("one pixel", d.count == 1 && is_rect(d.rect[0], 5, 5, 5, 5));
+    add(&d, 5, 5, 5, 5);
+    TEST_ASSERT("covered damage is ignored", d.count == 1 && dirty_rects_area(&d) == 1);
+
+    for (int x = 6; x < 16; x++) add(&d, x, 5, x, 5);
+    TEST_ASSERT("a run grows one rectangle", d.count == 1 && is_rect(d.rect[0], 5, 5, 15, 5));
+    add(&d, 5, 6, 15, 6);
+    TEST_ASSERT("the next row joins it", d.count == 1 && is_rect(d.rect[0], 5, 5, 15, 6));
+    add(&d, 10, 4, 20, 6);
+    TEST_ASSERT("overlap merges even at zero cost", d.count == 1 && covered(&d));
+
+    add(&d, 100, 80, 101, 81);
+    TEST_ASSERT("distant damage stays separate", d.count == 2 && dirty_rects_area(&d) == 16 * 3 + 4);
+
+    reset(&d, 0);
+    add(&d, 0, 0, 3, 3);
+    add(&d, 5, 0, 8, 3);
+    TEST_ASSERT("a gap costs pixels", d.count == 2);
+    add(&d, 4, 0, 4, 3);
+    TEST_ASSERT("filling the gap bridges both", d.count == 1 && is_rect(d.rect[0], 0, 0, 8, 3));
+
+    reset(&d, 8);
+    add(&d, 0, 0, 3, 3);
+    add(&d, 5, 0, 8, 3);
+    TEST_ASSERT("merge within the cost threshold", d.count == 1 && dirty_rects_area(&d) == 36 && covered(&d));
+    add(&d, 20, 0, 23, 3);
+    TEST_ASSERT("beyond the threshold stays separate", d.count == 2);
+}
+
+static void test_limit() {
+    printf("slot limit:\n");
+    dirty_rects_t d;
+
+    reset(&d, 0);
+    for (int i = 0; i < DIRTY_RECTS_MAX; i++) add(&d, i * 12, i * 10, i * 12 + 1, i * 10 + 1);
+    TEST_ASSERT("fills every slot", d.count == DIRTY_RECTS_MAX && dirty_rects_area(&d) == 4 * DIRTY_RECTS_MAX);
+    add(&d, 120, 90, 121, 91);
+    TEST_ASSERT("one more still fits the limit", d.count == DIRTY_RECTS_MAX && covered(&d));
+    // The last diagonal step (84,70) is the cheapest partner for (120,90)
+    TEST_ASSERT("forced merge joins the cheapest", dirty_rects_area(&d) == 4 * (DIRTY_RECTS_MAX - 1) + 38 * 22);
+
+    dirty_rects_clear(&d);
+    TEST_ASSERT("clear empties", d.count == 0 && d.merge_cost == 0);
+}
+
+static void test_random() {
+    printf("random damage:\n");
+    dirty_rects_t d;
+    srand(6502);
+
+    bool all_covered = true, within_limit = true, smaller = true;
+    for (int round = 0; round < 200; round++) {
+        reset(&d, 16);
+        int n = 1 + rand() % 40;
+        for (int i = 0; i < n; i++) {
+            int x0 = rand() % W, y0 = rand() % H;
+            int x1 = x0 + rand() % 8, y1 = y0 + rand() % 8;
+            add(&d, x0, y0, x1 < W ? x1 : W - 1, y1 < H ? y1 : H - 1);
+            within_limit &= d.count <= DIRTY_RECTS_MAX;
+        }
+        all_covered &= covered(&d);
+        if (n <= 3) smaller &= dirty_rects_area(&d) < (uint32_t)(W * H);
+    }
+    TEST_ASSERT("every damaged pixel covered", all_covered);
+    TEST_ASSERT("never more than the slot limit", within_limit);
+    TEST_ASSERT("a few small updates stay small", smaller);
+
+    // Sprite-like damage: a few 8x8 areas moving a pixel per frame stay a few rectangles
+    reset(&d, 16);
+    for (int frame = 0; frame < 16; frame++) {
+        add(&d, 10 + frame, 10, 17 + frame, 17);
+        add(&d, 90, 60 + frame, 97, 67 + frame);
+    }
+    TEST_ASSERT("moving sprites keep one rectangle each", d.count == 2 && covered(&d) &&
+                dirty_rects_area(&d) == 23 * 8 * 2);
+}
+
+int main() {
+    printf("Dirty rectangle tests\n\n");
+
+    test_merging();
+    test_limit();
+    test_random();
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
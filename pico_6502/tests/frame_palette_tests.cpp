@@ -0,0 +1,166 @@
+//
+// Buffered display palette tests
+//
+// Draws into a mock 8-bit frame through frame_palette_index the way the
+// buffered HAL does: exact entries until all 256 are taken, nearest colours
+// after that, and frame_palette_release after a clear freeing the entries the
+// frame no longer shows while the ones still on it keep their index.
+//
+
+#include <cstdio>
+#include <cstring>
+#include "ili9488/frame_palette.h"
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+// ---------- Mock frame ----------
+
+static const int W = 64, H = 48;
+static uint8_t frame[W * H];
+static frame_palette_t palette;
+
+static void fill(int x0, int y0, int x1, int y1, uint32_t color) {
+    uint8_t index = frame_palette_index(&palette, color);
+    for (int y = y0; y <= y1; y++) memset(frame + y * W + x0, index, x1 - x0 + 1);
+}
+
+static uint32_t pixel(int x, int y) {
+    return palette.color[frame[y * W + x]];
+}
+
+static void reset() {
+    memset(frame, 0, sizeof(frame));
+    frame_palette_init(&palette);
+}
+
+static void release() {
+    frame_palette_release(&palette, frame, sizeof(frame));
+}
+
+// Distinct RGB888 colours (0x010203 is odd, so n -> colour is one to one)
+static uint32_t color_n(int n) {
+    return (0x010203u * (uint32_t)(n + 1) & 0xFFFFFF) ^ 0x400000u;
+}
+
+// One pixel per colour, left to right and down
+static void draw_colors(int first, int count) {
+    for (int i = 0; i < count; i++) {
+        int x = (first + i) % W, y = (first + i) / W;
+        fill(x, y, x, y, color_n(first + i));
+    }
+}
+
+// ---------- Tests ----------
+
+static void test_fill_up() {
+    printf("filling the palette:\n");
+    reset();
+    TEST_ASSERT("zeroed frame is black", pixel(0, 0) == 0 && palette.used == 1);
+
+    draw_colors(0, 255);
+    bool exact = true;
+    for (int i = 0; i < 255; i++) exact &= pixel(i % W, i / W) == color_n(i);
+    TEST_ASSERT("255 colours beside black are exact", exact && palette.used == 256);
+
+    uint8_t index = frame_palette_index(&palette, color_n(10));
+    TEST_ASSERT("a known colour finds its entry", palette.color[index] == color_n(10));
+
+    uint32_t extra = color_n(300);
+    fill(0, 40, 0, 40, extra);
+    TEST_ASSERT("the 257th colour draws as an existing one",
+                pixel(0, 40) != extra && palette.used == 256);
+}
+
+static void test_clear() {
+    printf("after a clear:\n");
+    reset();
+    draw_colors(0, 400);
+    TEST_ASSERT("more than 256 colours drawn", palette.used == 256 && palette.free_count == 0);
+
+    fill(0, 0, W - 1, H - 1, 0);
+    release();
+    TEST_ASSERT("clearing frees every entry but black", palette.used == 1 && palette.free_count == 0);
+
+    uint32_t next = color_n(1000);
+    fill(5, 5, 10, 10, next);
+    TEST_ASSERT("next colour gets an exact entry", pixel(5, 5) == next && pixel(10, 10) == next);
+
+    draw_colors(0, 254);  // with black and the colour above, all 256 entries
+    bool exact = true;
+    for (int i = 0; i < 254; i++) exact &= pixel(i % W, i / W) == color_n(i);
+    TEST_ASSERT("a full palette's worth is exact again", exact && palette.used == 256);
+}
+
+static void test_partial_clear() {
+    printf("clearing part of the frame:\n");
+    reset();
+    draw_colors(0, 300);  // rows 0-4
+
+    // Keep row 2, whose entries sit between freed ones
+    uint32_t kept[W];
+    for (int x = 0; x < W; x++) kept[x] = pixel(x, 2);
+    fill(0, 0, W - 1, 1, 0);
+    fill(0, 3, W - 1, H - 1, 0);
+    release();
+
+    bool same = true;
+    for (int x = 0; x < W; x++) same &= pixel(x, 2) == kept[x];
+    TEST_ASSERT("pixels still shown keep their colour", same);
+    TEST_ASSERT("the rest is free", palette.free_count > 0 &&
+                (int)palette.used - palette.free_count == 1 + W);
+
+    // Fill every freed entry; none of them may repaint row 2
+    int room = 256 - (1 + W);
+    for (int i = 0; i < room; i++) {
+        int x = i % W, y = 10 + i / W;
+        fill(x, y, x, y, color_n(2000 + i));
+    }
+    bool exact = true;
+    for (int i = 0; i < room; i++) exact &= pixel(i % W, 10 + i / W) == color_n(2000 + i);
+    for (int x = 0; x < W; x++) same &= pixel(x, 2) == kept[x];
+    TEST_ASSERT("freed entries are reused with exact colours", exact && palette.used == 256);
+    TEST_ASSERT("reuse leaves the kept pixels alone", same);
+
+    fill(0, 20, 0, 20, color_n(5000));
+    TEST_ASSERT("full again after the freed entries", palette.free_count == 0 && palette.used == 256);
+}
+
+static void test_last_color() {
+    printf("last colour cache:\n");
+    reset();
+    uint32_t c = color_n(7);
+    fill(0, 0, 3, 3, c);
+    fill(0, 0, 3, 3, 0);
+    release();
+
+    // c's entry is gone; taking it for another colour must not leave c pointing at it
+    uint32_t d = color_n(8);
+    fill(10, 10, 10, 10, d);
+    fill(20, 20, 20, 20, c);
+    TEST_ASSERT("a colour drawn before the release gets its own entry again",
+                pixel(20, 20) == c && pixel(10, 10) == d);
+}
+
+int main() {
+    printf("Buffered display palette tests\n\n");
+
+    test_fill_up();
+    test_clear();
+    test_partial_clear();
+    test_last_color();
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
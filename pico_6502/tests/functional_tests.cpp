@@ -0,0 +1,114 @@
+//
+// Whole-program functional test runner (Klaus Dormann 6502/65C02 suites)
+//
+// Copyright 2026, John Clark
+//
+// Loads a 64K test image into Ram, starts at the entry point and runs until
+// the program traps in a branch/jump-to-self loop. The suite passes when the
+// trap address is its success address; any other trap identifies the failing
+// test in the listing.
+//
+// Usage: functional_tests --variant <6502|65c02|r65c02|w65c02s>
+//                         <image.bin> <start_pc> <success_pc> [max_cycles]
+//
+// Addresses are hex. Exits 77 (skipped) when the image is not present.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "w65c02s.hpp"
+#include "ram.hpp"
+
+#define SKIP_RETURN_CODE    77
+#define DEFAULT_MAX_CYCLES  200000000ULL
+
+static SimpleRam ram;
+
+template<typename Cpu>
+static int run_image(const char* variant, uint16_t start_pc, uint16_t success_pc, uint64_t max_cycles) {
+    Cpu cpu;
+    SimpleRam::set_instance(&ram);
+    cpu.ram_read = &SimpleRam::static_read;
+    cpu.ram_write = &SimpleRam::static_write;
+    cpu.reset();
+    cpu.reg.pc = start_pc;
+
+    auto t_start = std::chrono::steady_clock::now();
+
+    // A trap is any instruction that leaves PC where it started
+    uint16_t trap_pc = 0;
+    bool trapped = false;
+    while (cpu.cycles < max_cycles && !cpu.halted) {
+        uint16_t pc = cpu.reg.pc;
+        cpu.step();
+        if (cpu.reg.pc == pc) {
+            trap_pc = pc;
+            trapped = true;
+            break;
+        }
+    }
+
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+    printf("  %s: %llu cycles in %.2f s (%.1f MHz)\n", variant,
+           (unsigned long long)cpu.cycles, elapsed_s, elapsed_s > 0 ? cpu.cycles / elapsed_s / 1e6 : 0.0);
+
+    if (!trapped) {
+        printf("  FAIL: no trap after %llu cycles (pc=$%04X%s)\n",
+               (unsigned long long)cpu.cycles, cpu.reg.pc, cpu.halted ? ", halted" : "");
+        return 1;
+    }
+    if (trap_pc != success_pc) {
+        printf("  FAIL: trapped at $%04X (a=%02X x=%02X y=%02X p=%02X sp=%02X), success is $%04X\n",
+               trap_pc, cpu.reg.a, cpu.reg.x, cpu.reg.y, cpu.reg.flag.value(), cpu.reg.sp, success_pc);
+        return 1;
+    }
+    printf("  PASS: trapped at success address $%04X\n", trap_pc);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* variant = "w65c02s";
+    std::vector<const char*> args;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--variant") && i + 1 < argc) {
+            variant = argv[++i];
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    if (args.size() < 3) {
+        printf("usage: functional_tests --variant <6502|65c02|r65c02|w65c02s> <image.bin> <start_pc> <success_pc> [max_cycles]\n");
+        return 2;
+    }
+
+    FILE* f = fopen(args[0], "rb");
+    if (!f) {
+        printf("SKIP: %s not found\n", args[0]);
+        return SKIP_RETURN_CODE;
+    }
+    std::vector<uint8_t> image(0x10000);
+    size_t len = fread(image.data(), 1, image.size(), f);
+    fclose(f);
+
+    ram.reset();
+    ram.load(0x0000, image.data(), len);
+
+    uint16_t start_pc = static_cast<uint16_t>(strtoul(args[1], nullptr, 16));
+    uint16_t success_pc = static_cast<uint16_t>(strtoul(args[2], nullptr, 16));
+    uint64_t max_cycles = args.size() > 3 ? strtoull(args[3], nullptr, 10) : DEFAULT_MAX_CYCLES;
+
+    printf("Functional test %s [%s]: start $%04X, success $%04X\n", args[0], variant, start_pc, success_pc);
+
+    if (!strcmp(variant, "6502")) return run_image<NMOS6502>(variant, start_pc, success_pc, max_cycles);
+    if (!strcmp(variant, "65c02")) return run_image<C65C02>(variant, start_pc, success_pc, max_cycles);
+    if (!strcmp(variant, "r65c02")) return run_image<R65C02>(variant, start_pc, success_pc, max_cycles);
+    if (!strcmp(variant, "w65c02s")) return run_image<W65C02S>(variant, start_pc, success_pc, max_cycles);
+
+    printf("unknown variant: %s\n", variant);
+    return 2;
+}
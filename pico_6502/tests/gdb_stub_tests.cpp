@@ -0,0 +1,216 @@
+//
+// GDB remote stub tests
+//
+// Copyright 2026, John Clark
+//
+// Drives GdbStub through an in-memory transport the way gdb would: framed
+// packets in, acknowledgements and replies out. Covers registers, memory,
+// breakpoints, watchpoints, single step, Ctrl-C, checksum errors, and
+// reverse step/continue with a Rewinder attached.
+//
+
+#include <cstdio>
+#include <string>
+#include "w65c02s.hpp"
+#include "ram.hpp"
+#include "gdb_stub.hpp"
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+// ---------- Transport ----------
+
+static std::string to_stub, from_stub;
+static size_t to_stub_pos;
+
+static int read_char() {
+    return to_stub_pos < to_stub.size() ? (uint8_t)to_stub[to_stub_pos++] : -1;
+}
+
+static void write_data(const char* data, size_t len) {
+    from_stub.append(data, len);
+}
+
+static std::string frame(const std::string& body) {
+    uint8_t sum = 0;
+    for (char c : body) sum += (uint8_t)c;
+    char tail[4];
+    snprintf(tail, sizeof(tail), "#%02x", sum);
+    return "$" + body + tail;
+}
+
+// Body of the last packet the stub sent (acks dropped)
+static std::string last_reply() {
+    size_t start = from_stub.rfind('$');
+    size_t end = from_stub.rfind('#');
+    if (start == std::string::npos || end == std::string::npos || end < start) return "<none>";
+    return from_stub.substr(start + 1, end - start - 1);
+}
+
+// ---------- Program ----------
+
+// Count in $10, store the count at $0300,x, every 16th pass call a subroutine
+static const uint16_t load_addr = 0x0600;
+static const uint8_t program[] = {
+    0xa2, 0x00,         // $0600  ldx #$00
+    0xe6, 0x10,         // $0602  inc $10
+    0xa5, 0x10,         // $0604  lda $10
+    0x9d, 0x00, 0x03,   // $0606  sta $0300,x
+    0xe8,               // $0609  inx
+    0x29, 0x0f,         // $060a  and #$0f
+    0xd0, 0xf4,         // $060c  bne $0602
+    0x20, 0x00, 0x07,   // $060e  jsr $0700
+    0x80, 0xef,         // $0611  bra $0602
+};
+static const uint8_t subroutine[] = {
+    0xe6, 0x20,         // $0700  inc $20
+    0x60,               // $0702  rts
+};
+
+static SimpleRam ram;
+static W65C02S cpu;
+
+static void load() {
+    ram.reset();
+    ram.load(load_addr, program, sizeof(program));
+    ram.load(0x0700, subroutine, sizeof(subroutine));
+    SimpleRam::set_instance(&ram);
+    cpu.ram_read = &SimpleRam::static_read;
+    cpu.ram_write = &SimpleRam::static_write;
+    cpu.reset();
+    cpu.reg.pc = load_addr;
+}
+
+template<typename Stub>
+static std::string cmd(Stub& stub, const std::string& body) {
+    to_stub = frame(body);
+    to_stub_pos = 0;
+    from_stub.clear();
+    stub.poll();
+    return last_reply();
+}
+
+// Resume with c/s (or bs/bc) and run the loop until the stub stops again
+template<typename Stub>
+static std::string run(Stub& stub, const std::string& body, int max_steps = 100000) {
+    cmd(stub, body);
+    for (int i = 0; i < max_steps && !stub.stopped(); i++) {
+        if (stub.active()) stub.step(); else cpu.step();
+    }
+    return last_reply();
+}
+
+static void test_registers_memory() {
+    printf("registers and memory:\n");
+    load();
+    GdbStub<W65C02S> stub(cpu, ram.data(), read_char, write_data);
+
+    std::string r = cmd(stub, "qSupported:swbreak+");
+    TEST_ASSERT("qSupported advertises features", r.find("qXfer:features:read+") != std::string::npos &&
+                                                   r.find("ReverseStep") == std::string::npos);
+    TEST_ASSERT("acknowledges good packets", from_stub[0] == '+');
+    TEST_ASSERT("target description", cmd(stub, "qXfer:features:read:target.xml:0,400").find("name=\"pc\"") != std::string::npos);
+    TEST_ASSERT("stop reason at start", cmd(stub, "?") == "S05");
+
+    cpu.reg.a = 0x12; cpu.reg.x = 0x34; cpu.reg.y = 0x56; cpu.reg.sp = 0xfd;
+    std::string g = cmd(stub, "g");
+    TEST_ASSERT("read all registers", g.substr(0, 6) == "123456" && g.substr(8) == "fd0006");
+    TEST_ASSERT("read pc", cmd(stub, "p5") == "0006");
+    TEST_ASSERT("write register", cmd(stub, "P1=99") == "OK" && cpu.reg.x == 0x99);
+    TEST_ASSERT("write all registers", cmd(stub, "Gaabbcc01f00207") == "OK" &&
+                cpu.reg.a == 0xaa && cpu.reg.y == 0xcc && cpu.reg.flag.c() && cpu.reg.pc == 0x0702);
+
+    TEST_ASSERT("read memory", cmd(stub, "m600,4") == "a200e610");
+    TEST_ASSERT("long read is cut short", cmd(stub, "m600,400").size() == 2 * GDB_MAX_READ &&
+                cmd(stub, "m600,400").substr(0, 8) == "a200e610");
+    TEST_ASSERT("write memory", cmd(stub, "M300,3:010203") == "OK" && ram[0x0301] == 0x02 && ram[0x0302] == 0x03);
+    TEST_ASSERT("unknown packet gets empty reply", cmd(stub, "vMustReplyEmpty") == "");
+
+    to_stub = "$g#00";
+    to_stub_pos = 0;
+    from_stub.clear();
+    stub.poll();
+    TEST_ASSERT("bad checksum is refused", from_stub == "-");
+}
+
+static void test_run_control() {
+    printf("breakpoints and stepping:\n");
+    load();
+    GdbStub<W65C02S> stub(cpu, ram.data(), read_char, write_data);
+
+    TEST_ASSERT("continue has no immediate reply", cmd(stub, "c") == "<none>" && !stub.stopped());
+    TEST_ASSERT("no breakpoints, running: inactive", !stub.active());
+    stub.stop();
+
+    TEST_ASSERT("set breakpoint", cmd(stub, "Z0,700,1") == "OK" && stub.breakpoint_at(0x0700) && stub.active());
+    TEST_ASSERT("continue to breakpoint", run(stub, "c") == "T05swbreak:;" && cpu.reg.pc == 0x0700 && ram[0x10] == 16);
+    TEST_ASSERT("continue again hits it next time", run(stub, "c") == "T05swbreak:;" && ram[0x10] == 32);
+    TEST_ASSERT("single step", run(stub, "s") == "S05" && cpu.reg.pc == 0x0702 && ram[0x20] == 2);
+    TEST_ASSERT("clear breakpoint", cmd(stub, "z0,700,1") == "OK" && !stub.breakpoint_at(0x0700));
+
+    TEST_ASSERT("write watchpoint", cmd(stub, "Z2,320,1") == "OK" && cpu.ram_read != &SimpleRam::static_read);
+    TEST_ASSERT("stops after the write", run(stub, "c") == "T05watch:0320;" && ram[0x0320] == 0x21);
+    TEST_ASSERT("read watchpoint", cmd(stub, "Z3,20,1") == "OK" && run(stub, "c") == "T05rwatch:0020;");
+    TEST_ASSERT("remove watchpoints restores memory functions",
+                cmd(stub, "z2,320,1") == "OK" && cmd(stub, "z3,20,1") == "OK" &&
+                cpu.ram_read == &SimpleRam::static_read);
+
+    // Running with nothing set: the loop uses cpu.step(); Ctrl-C stops it at the next poll
+    cmd(stub, "c");
+    for (int i = 0; i < 1000; i++) cpu.step();
+    TEST_ASSERT("running without breakpoints is inactive", !stub.active());
+    to_stub = "\x03";
+    to_stub_pos = 0;
+    from_stub.clear();
+    stub.poll();
+    TEST_ASSERT("Ctrl-C interrupts", stub.stopped() && last_reply() == "S02");
+
+    TEST_ASSERT("detach resumes", cmd(stub, "D") == "OK" && !stub.stopped());
+}
+
+static void test_reverse() {
+    printf("reverse execution:\n");
+    load();
+    Rewinder<W65C02S> rw(cpu, ram.data(), nullptr, nullptr, {500, 1u << 20});
+    rw.start();
+    GdbStub<W65C02S> stub(cpu, ram.data(), read_char, write_data);
+    stub.attach_rewinder(&rw);
+
+    TEST_ASSERT("qSupported advertises reverse", cmd(stub, "qSupported").find("ReverseContinue+") != std::string::npos);
+    cmd(stub, "Z0,700,1");
+    run(stub, "c");
+    run(stub, "c");
+    run(stub, "c");
+    TEST_ASSERT("third hit", ram[0x20] == 2 && cpu.reg.pc == 0x0700);
+
+    uint8_t count = ram[0x10];
+    TEST_ASSERT("reverse step", run(stub, "bs") == "S05" && cpu.reg.pc == 0x060e);
+    TEST_ASSERT("reverse continue", run(stub, "bc") == "T05swbreak:;" && cpu.reg.pc == 0x0700 && ram[0x20] == 1 &&
+                ram[0x10] == count - 16);
+    run(stub, "bc");
+    TEST_ASSERT("reverse continue to start of history", run(stub, "bc") == "T05replaylog:begin;" &&
+                rw.position() == 0 && cpu.reg.pc == load_addr);
+    TEST_ASSERT("forward again", run(stub, "c") == "T05swbreak:;" && ram[0x10] == 16);
+}
+
+int main() {
+    printf("GDB stub tests\n\n");
+
+    test_registers_memory();
+    test_run_control();
+    test_reverse();
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+//
+// Polygon fill tests
+//
+// Copyright 2026, John Clark
+//
+// Runs hagl_fill_polygon on a mock surface that records every hline and
+// compares it with hagl_fill_polygon_float: random polygons, flat-topped and
+// flat-bottomed triangles through the triangle path and the edge table, and
+// shapes crossing a clip window that does not start at the origin.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "hagl/surface.h"
+#include "hagl/polygon.h"
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+// ---------- Mock surface ----------
+
+static const int W = 200, H = 150;
+
+struct HLine {
+    int16_t x, y;
+    uint16_t width;
+};
+
+// Pixels are bit masks so two fills can share a canvas
+static uint8_t canvas[H][W];
+static std::vector<HLine> hlines;
+static bool out_of_bounds;
+
+static void mock_hline(void*, int16_t x0, int16_t y0, uint16_t width, hagl_color_t color) {
+    hlines.push_back({x0, y0, width});
+    for (int x = x0; x < x0 + width; x++) {
+        if (x < 0 || x >= W || y0 < 0 || y0 >= H) {
+            out_of_bounds = true;
+            continue;
+        }
+        canvas[y0][x] |= (uint8_t)color;
+    }
+}
+
+static void mock_put_pixel(void*, int16_t x0, int16_t y0, hagl_color_t color) {
+    mock_hline(nullptr, x0, y0, 1, color);
+}
+
+static hagl_surface_t surface;
+
+static void set_clip(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    surface.clip.x0 = x0;
+    surface.clip.y0 = y0;
+    surface.clip.x1 = x1;
+    surface.clip.y1 = y1;
+}
+
+static void reset() {
+    memset(canvas, 0, sizeof(canvas));
+    hlines.clear();
+    out_of_bounds = false;
+}
+
+// Pixels drawn by exactly one of the fills given masks a and b
+static long differing(uint8_t a, uint8_t b) {
+    long d = 0;
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++) d += ((canvas[y][x] & a) != 0) != ((canvas[y][x] & b) != 0);
+    return d;
+}
+
+static long drawn(uint8_t mask) {
+    long n = 0;
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++) n += (canvas[y][x] & mask) != 0;
+    return n;
+}
+
+static void random_polygon(int16_t* v, int amount, int lo, int hi_x, int hi_y) {
+    for (int i = 0; i < amount; i++) {
+        v[2 * i] = lo + rand() % (hi_x - lo);
+        v[2 * i + 1] = lo + rand() % (hi_y - lo);
+    }
+}
+
+// ---------- Tests ----------
+
+static void test_against_float() {
+    printf("against the floating point fill:\n");
+    srand(6502);
+
+    long diff = 0, total = 0, worst = 0;
+    for (int round = 0; round < 5000; round++) {
+        int16_t v[2 * 16];
+        int amount = 3 + rand() % 14;
+        random_polygon(v, amount, 10, W - 10, H - 10);
+        reset();
+        hagl_fill_polygon(&surface, amount, v, 1);
+        hagl_fill_polygon_float(&surface, amount, v, 2);
+        long d = differing(1, 2);
+        diff += d;
+        total += drawn(3);
+        if (d > worst) worst = d;
+    }
+    printf("    %ld of %ld pixels differ, worst polygon %ld\n", diff, total, worst);
+    TEST_ASSERT("fewer than 1 in 10000 pixels differ", diff * 10000 < total);
+    TEST_ASSERT("no polygon differs by more than a few pixels", worst <= 8);
+}
+
+// The same triangle drawn by the triangle path and by the edge table, as a
+// quad with the first edge split at its midpoint. The edge must be even in
+// both directions so the midpoint lies exactly on it.
+static bool triangle_matches(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    int16_t tri[6] = {x0, y0, x1, y1, x2, y2};
+    int16_t quad[8] = {x0, y0, (int16_t)((x0 + x1) / 2), (int16_t)((y0 + y1) / 2), x1, y1, x2, y2};
+    reset();
+    hagl_fill_polygon(&surface, 3, tri, 1);
+    hagl_fill_polygon(&surface, 4, quad, 2);
+    return drawn(3) > 0 && differing(1, 2) == 0;
+}
+
+static void test_triangles() {
+    printf("triangle path:\n");
+    TEST_ASSERT("flat top", triangle_matches(20, 30, 120, 30, 70, 110));
+    TEST_ASSERT("flat top, apex outside the base", triangle_matches(20, 30, 60, 30, 150, 110));
+    TEST_ASSERT("flat bottom", triangle_matches(70, 20, 20, 100, 130, 100));
+    TEST_ASSERT("flat bottom, vertices in any order", triangle_matches(130, 100, 70, 20, 20, 100));
+    TEST_ASSERT("one scanline", triangle_matches(20, 50, 90, 50, 160, 50));
+    TEST_ASSERT("one pixel", triangle_matches(40, 40, 40, 40, 40, 40));
+
+    srand(65);
+    bool all = true;
+    for (int round = 0; round < 2000; round++) {
+        int16_t v[6];
+        random_polygon(v, 3, 5, W - 5, H - 5);
+        v[2] -= (v[2] - v[0]) & 1;  // even first edge
+        v[3] -= (v[3] - v[1]) & 1;
+        if (round % 4 == 0) v[3] = v[1];  // flat top or bottom depending on the third
+        all &= triangle_matches(v[0], v[1], v[2], v[3], v[4], v[5]);
+    }
+    TEST_ASSERT("random triangles match the edge table", all);
+}
+
+static void test_clip() {
+    printf("clipping:\n");
+    srand(1976);
+
+    bool inside = true, same_pixels = true;
+    for (int round = 0; round < 2000; round++) {
+        int16_t v[2 * 12];
+        int amount = 3 + rand() % 10;
+        random_polygon(v, amount, -60, W + 60, H + 60);
+
+        // Reference: whole surface, then cut to the window
+        set_clip(0, 0, W - 1, H - 1);
+        reset();
+        hagl_fill_polygon(&surface, amount, v, 1);
+        static uint8_t full[H][W];
+        memcpy(full, canvas, sizeof(canvas));
+
+        set_clip(20, 25, 140, 100);
+        reset();
+        hagl_fill_polygon(&surface, amount, v, 1);
+        for (const HLine& l : hlines) {
+            inside &= l.width > 0 && l.y >= 25 && l.y <= 100 && l.x >= 20 && l.x + l.width - 1 <= 140;
+        }
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                bool in_window = x >= 20 && x <= 140 && y >= 25 && y <= 100;
+                same_pixels &= canvas[y][x] == (in_window ? full[y][x] : 0);
+            }
+        }
+    }
+    set_clip(0, 0, W - 1, H - 1);
+    TEST_ASSERT("hlines stay inside the clip window", inside && !out_of_bounds);
+    TEST_ASSERT("clipped fill is the full fill cut to the window", same_pixels);
+
+    // A triangle far larger than the surface only walks the visible rows
+    int16_t tri[6] = {-20000, -30000, 30000, 0, 100, 30000};
+    set_clip(20, 25, 140, 100);
+    reset();
+    hagl_fill_polygon(&surface, 3, tri, 1);
+    TEST_ASSERT("huge triangle fills the window row by row",
+                hlines.size() == 76 && drawn(1) == 121 * 76 && !out_of_bounds);
+    set_clip(0, 0, W - 1, H - 1);
+}
+
+int main() {
+    printf("Polygon fill tests\n\n");
+
+    surface.width = W;
+    surface.height = H;
+    surface.depth = 16;
+    surface.hline = mock_hline;
+    surface.put_pixel = mock_put_pixel;
+    set_clip(0, 0, W - 1, H - 1);
+
+    test_against_float();
+    test_triangles();
+    test_clip();
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+//
+// Bitmap span table tests
+//
+// Copyright 2026, John Clark
+//
+// Builds span tables with hagl_bitmap_build_spans for bitmaps with empty,
+// opaque and edge-touching rows, and checks that replaying the table (as the
+// HAL's span blit does) draws exactly the pixels that are not transparent.
+// Also covers a table with more runs than fit in 16 bits.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "hagl/bitmap.h"
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+// ---------- Helpers ----------
+
+static const hagl_color_t CLEAR = 0;
+
+// Bitmap over caller-owned 32-bit pixels with its span table built
+static int32_t build(hagl_bitmap_t* b, std::vector<hagl_color_t>& px, int w, int h) {
+    hagl_bitmap_init(b, w, h, 32, px.data());
+    return hagl_bitmap_build_spans(b, CLEAR);
+}
+
+static uint32_t row_runs(const hagl_bitmap_t* b, int y) {
+    return b->span_rows[y + 1] - b->span_rows[y];
+}
+
+static bool is_span(const hagl_bitmap_t* b, uint32_t i, int x0, int width) {
+    return b->spans[i].x0 == x0 && b->spans[i].width == width;
+}
+
+// Replay the table: every opaque pixel drawn once, nothing else drawn
+static bool replay_matches(const hagl_bitmap_t* b, const std::vector<hagl_color_t>& px) {
+    std::vector<int> drawn(px.size(), 0);
+    for (int y = 0; y < b->height; y++) {
+        for (uint32_t i = b->span_rows[y]; i < b->span_rows[y + 1]; i++) {
+            const hagl_span_t& s = b->spans[i];
+            if (s.width == 0 || s.x0 + s.width > b->width) return false;
+            for (int x = s.x0; x < s.x0 + s.width; x++) drawn[y * b->width + x]++;
+        }
+    }
+    for (size_t i = 0; i < px.size(); i++) {
+        if (drawn[i] != (px[i] != CLEAR ? 1 : 0)) return false;
+    }
+    return true;
+}
+
+// ---------- Tests ----------
+
+static void test_rows() {
+    printf("rows:\n");
+    const int W = 8, H = 5;
+    const char* rows[H] = {
+        "........",  // all transparent
+        "#..##..#",  // runs touching both edges
+        "########",  // fully opaque
+        "........",
+        ".##.###.",
+    };
+    std::vector<hagl_color_t> px(W * H);
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++) px[y * W + x] = rows[y][x] == '#' ? 0xff8000 : CLEAR;
+
+    hagl_bitmap_t b;
+    int32_t n = build(&b, px, W, H);
+    TEST_ASSERT("counts every run", n == 6 && b.span_rows[H] == 6);
+    TEST_ASSERT("transparent rows have no runs", row_runs(&b, 0) == 0 && row_runs(&b, 3) == 0);
+    TEST_ASSERT("runs at both row edges", row_runs(&b, 1) == 3 && is_span(&b, b.span_rows[1], 0, 1) &&
+                is_span(&b, b.span_rows[1] + 1, 3, 2) && is_span(&b, b.span_rows[1] + 2, 7, 1));
+    TEST_ASSERT("opaque row is one run", row_runs(&b, 2) == 1 && is_span(&b, b.span_rows[2], 0, W));
+    TEST_ASSERT("inner runs", row_runs(&b, 4) == 2 && is_span(&b, b.span_rows[4], 1, 2) &&
+                is_span(&b, b.span_rows[4] + 1, 4, 3));
+    TEST_ASSERT("replay draws the opaque pixels", replay_matches(&b, px));
+
+    hagl_bitmap_free_spans(&b);
+    TEST_ASSERT("free clears the table", b.spans == NULL && b.span_rows == NULL);
+
+    std::vector<hagl_color_t> empty(W * H, CLEAR);
+    n = build(&b, empty, W, H);
+    TEST_ASSERT("all transparent bitmap", n == 0 && b.spans != NULL && b.span_rows[H] == 0);
+    hagl_bitmap_free_spans(&b);
+}
+
+static void test_random() {
+    printf("random bitmaps:\n");
+    srand(6502);
+
+    bool all_match = true, rebuilt = true;
+    for (int round = 0; round < 200; round++) {
+        int w = 1 + rand() % 40, h = 1 + rand() % 20;
+        std::vector<hagl_color_t> px(w * h);
+        int density = rand() % 4;  // mostly clear to mostly opaque
+        for (auto& p : px) p = (rand() % 4 < density) ? (hagl_color_t)(1 + rand() % 0xffffff) : CLEAR;
+
+        hagl_bitmap_t b;
+        build(&b, px, w, h);
+        all_match &= replay_matches(&b, px);
+
+        // Rebuilding after a change replaces the old table
+        px[rand() % px.size()] ^= 0x10;
+        rebuilt &= hagl_bitmap_build_spans(&b, CLEAR) >= 0 && replay_matches(&b, px);
+        hagl_bitmap_free_spans(&b);
+    }
+    TEST_ASSERT("replay matches every bitmap", all_match);
+    TEST_ASSERT("rebuild follows pixel changes", rebuilt);
+}
+
+static void test_many_runs() {
+    printf("large tables:\n");
+    // Every other pixel opaque: 256 runs a row, 76800 in all (past 16 bits)
+    const int W = 512, H = 300;
+    std::vector<hagl_color_t> px(W * H);
+    for (int i = 0; i < W * H; i++) px[i] = (i % 2) ? 0x00ff00 : CLEAR;
+
+    hagl_bitmap_t b;
+    int32_t n = build(&b, px, W, H);
+    bool rows_ok = true;
+    for (int y = 0; y <= H; y++) rows_ok &= b.span_rows[y] == (uint32_t)y * (W / 2);
+    TEST_ASSERT("more runs than 16 bits count", n == W / 2 * H && b.span_rows[H] == (uint32_t)n);
+    TEST_ASSERT("row offsets past 65535", rows_ok && b.span_rows[H - 1] > 65535);
+    TEST_ASSERT("last run is at the row end", is_span(&b, n - 1, W - 1, 1));
+    TEST_ASSERT("replay matches", replay_matches(&b, px));
+    hagl_bitmap_free_spans(&b);
+}
+
+int main() {
+    printf("Bitmap span table tests\n\n");
+
+    test_rows();
+    test_random();
+    test_many_runs();
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
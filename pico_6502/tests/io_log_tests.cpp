@@ -0,0 +1,216 @@
+//
+// I/O record/replay tests
+//
+// Copyright 2026, John Clark
+//
+// Checks the change encoding, long gaps, overflow and divergence detection of
+// IoLog directly, then records a program that polls the keyboard and random
+// ports and replays it to an identical memory image.
+//
+
+#include <cstdio>
+#include <vector>
+#include "w65c02s.hpp"
+#include "ram.hpp"
+#include "io_log.hpp"
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+// ---------- IoPrng ----------
+
+static void test_prng() {
+    printf("prng:\n");
+    IoPrng a(1234), b(1234), c(1235);
+    bool same = true, differs = false;
+    for (int i = 0; i < 1000; i++) {
+        uint8_t va = a.next_byte();
+        same &= va == b.next_byte();
+        differs |= va != c.next_byte();
+    }
+    TEST_ASSERT("same seed, same sequence", same);
+    TEST_ASSERT("different seed, different sequence", differs);
+
+    IoPrng z(0);
+    bool nonzero = false;
+    for (int i = 0; i < 16; i++) nonzero |= z.next_byte() != 0;
+    TEST_ASSERT("zero seed still produces output", nonzero);
+}
+
+// ---------- IoLog ----------
+
+static void test_change_encoding() {
+    printf("change encoding:\n");
+    uint32_t words[64];
+    IoLog log;
+    log.record(words, 64);
+
+    // Keyboard polled every 10 cycles; two keys arrive
+    const uint8_t live[] = {0, 0, 'a', 0, 0, 0, 'b', 0, 0, 0};
+    for (int i = 0; i < 10; i++) {
+        log.read(0x00FF, 100 + i * 10, live[i]);
+        if (i == 5) log.line(IO_LINE_IRQ, 150, true);
+    }
+    log.line(IO_LINE_IRQ, 200, false);
+    TEST_ASSERT("only changes are logged", log.size() == 2 * 6 && !log.overflowed());
+
+    IoLog replay;
+    replay.replay(words, log.size());
+    bool ok = true;
+    for (int i = 0; i < 10; i++) {
+        ok &= replay.read(0x00FF, 100 + i * 10, 0x55) == live[i];
+        if (i == 5) ok &= replay.line(IO_LINE_IRQ, 150, false);
+    }
+    ok &= !replay.line(IO_LINE_IRQ, 200, true);
+    TEST_ASSERT("replay returns recorded values, ignoring live", ok);
+    TEST_ASSERT("replay matched and finished", !replay.diverged() && replay.finished());
+}
+
+static void test_gap_and_overflow() {
+    printf("gaps and overflow:\n");
+    uint32_t words[8];
+    IoLog log;
+    log.record(words, 8);
+    uint64_t far = 2ull << 32;  // needs two gap events
+    log.read(0xD501, far, 0x10);
+    TEST_ASSERT("long delta split into gap events", log.size() == 6);
+
+    IoLog replay;
+    replay.replay(words, log.size());
+    TEST_ASSERT("value not visible early", replay.read(0xD501, far - 1, 0) == 0);
+    TEST_ASSERT("value visible at its cycle", replay.read(0xD501, far, 0) == 0x10 && !replay.diverged());
+
+    log.read(0xD501, far + 1, 0x00);
+    log.read(0xD501, far + 2, 0x10);
+    TEST_ASSERT("full log reports overflow", log.overflowed() && log.size() == 8);
+}
+
+static void test_divergence() {
+    printf("divergence:\n");
+    uint32_t words[16];
+    IoLog log;
+    log.record(words, 16);
+    log.read(0x00FF, 1000, 'x');
+    log.read(0x00FF, 1010, 0);
+
+    IoLog replay;
+    replay.replay(words, log.size());
+    replay.read(0x00FF, 990, 0);
+    replay.read(0x00FF, 1003, 0);  // the read recorded at 1000 happened later
+    TEST_ASSERT("late read flags divergence", replay.diverged() && replay.diverged_cycle() == 1000);
+}
+
+// ---------- Whole program ----------
+
+// Poll $FF, store each key plus a $FE random byte in a buffer at $0300, and
+// raise a counter in the IRQ handler
+static const uint16_t load_addr = 0x0600;
+static const uint8_t program[] = {
+    0x58,               // $0600  cli
+    0xa0, 0x00,         // $0601  ldy #$00
+    0xa5, 0xff,         // $0603  lda $ff
+    0xf0, 0xfc,         // $0605  beq $0603
+    0x99, 0x00, 0x03,   // $0607  sta $0300,y
+    0xc8,               // $060a  iny
+    0xa5, 0xfe,         // $060b  lda $fe
+    0x99, 0x00, 0x03,   // $060d  sta $0300,y
+    0xc8,               // $0610  iny
+    0x80, 0xf0,         // $0611  bra $0603
+};
+static const uint8_t irq_handler[] = {
+    0xe6, 0x10,         // $0700  inc $10
+    0x40,               // $0702  rti
+};
+
+static HookedRam ram;
+static W65C02S cpu;
+static IoLog io_log;
+static IoPrng prng;
+static std::vector<std::pair<uint64_t, uint8_t>> keys;  // live input: cycle, key
+static size_t next_key;
+static bool invert_live_irq;
+
+static uint8_t page0_read_hook(uint16_t addr, void*) {
+    if (addr == 0x00FF) {
+        uint8_t live = 0;
+        if (next_key < keys.size() && keys[next_key].first <= cpu.cycles) live = keys[next_key++].second;
+        return io_log.read(addr, cpu.cycles, live);
+    }
+    if (addr == 0x00FE) return prng.next_byte();
+    return ram[addr];
+}
+
+// Run with the given live input; returns the memory hash
+static uint32_t run_program(uint32_t seed, uint64_t cycles) {
+    ram.reset();
+    ram.load(load_addr, program, sizeof(program));
+    ram.load(0x0700, irq_handler, sizeof(irq_handler));
+    ram[0xfffe] = 0x00;
+    ram[0xffff] = 0x07;
+    ram.set_read_hook(0x00, page0_read_hook);
+    HookedRam::set_instance(&ram);
+    cpu.ram_read = &HookedRam::static_read;
+    cpu.ram_write = &HookedRam::static_write;
+    cpu.reset();
+    cpu.reg.pc = load_addr;
+    prng.seed_with(seed);
+    next_key = 0;
+
+    uint64_t slice_end = 1024;
+    while (cpu.cycles < cycles) {
+        cpu.step();
+        if (cpu.cycles >= slice_end) {
+            slice_end += 1024;
+            // Live interrupt input is a square wave over four slices
+            bool live_irq = ((slice_end & 0x1000) != 0) != invert_live_irq;
+            if (io_log.line(IO_LINE_IRQ, cpu.cycles, live_irq)) cpu.trigger_irq(); else cpu.clear_irq();
+        }
+    }
+    return io_log_ram_hash(ram.data(), 0x10000);
+}
+
+static void test_program_replay() {
+    printf("program record/replay:\n");
+    std::vector<uint32_t> words(4096);
+    keys = {{5000, 'h'}, {5100, 'i'}, {40000, '!'}, {90000, '\r'}};
+    invert_live_irq = false;
+    io_log.record(words.data(), words.size());
+    uint32_t recorded = run_program(42, 200000);
+    bool got_keys = ram[0x0300] == 'h' && ram[0x0302] == 'i' && ram[0x0306] == '\r';
+    TEST_ASSERT("recorded run saw the keys", got_keys && ram[0x10] != 0);
+
+    // Different live input during replay must not matter
+    keys = {{100, 'x'}, {200, 'y'}};
+    invert_live_irq = true;
+    io_log.replay(words.data(), io_log.size());
+    uint32_t replayed = run_program(42, 200000);
+    TEST_ASSERT("replay reproduces memory exactly", replayed == recorded);
+    TEST_ASSERT("replay matched the whole log", !io_log.diverged() && io_log.finished());
+
+    io_log.replay(words.data(), io_log.size());
+    TEST_ASSERT("other seed gives other memory", run_program(43, 200000) != recorded);
+}
+
+int main() {
+    printf("I/O record/replay tests\n\n");
+
+    test_prng();
+    test_change_encoding();
+    test_gap_and_overflow();
+    test_divergence();
+    test_program_replay();
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
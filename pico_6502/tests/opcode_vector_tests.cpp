@@ -0,0 +1,403 @@
+//
+// Per-instruction JSON test vector runner
+//
+// Copyright 2026, John Clark
+//
+// Runs vectors in the SingleStepTests 65x02 format (one JSON array per opcode
+// file) against a compile-time CPU variant, checking the final registers,
+// memory and cycle count of every vector:
+//
+//   [ { "name": "a9 42 00",
+//       "initial": { "pc": 4096, "s": 253, "a": 0, "x": 0, "y": 0, "p": 36,
+//                    "ram": [ [4096, 169], [4097, 66] ] },
+//       "final":   { ... },
+//       "cycles":  [ [4096, 169, "read"], [4097, 66, "read"] ] }, ... ]
+//
+// Only the number of bus cycles is compared, not the individual accesses.
+//
+// Usage: opcode_vector_tests --variant <6502|synertek65c02|rockwell65c02|wdc65c02>
+//                            [--skip op,op,...] <dir|file.json>...
+//
+// Exits 77 (skipped) when no vector files are found.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "w65c02s.hpp"
+#include "ram.hpp"
+
+namespace fs = std::filesystem;
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+#define SKIP_RETURN_CODE 77
+#define MAX_REPORTED_MISMATCHES 3
+
+// ---------- Minimal JSON reader ----------
+
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    const JsonValue* find(const char* key) const {
+        for (const auto& kv : object) {
+            if (kv.first == key) return &kv.second;
+        }
+        return nullptr;
+    }
+
+    int as_int() const { return static_cast<int>(number); }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : p_(text.data()), end_(text.data() + text.size()) {}
+
+    bool parse(JsonValue& out) {
+        skip_ws();
+        if (!parse_value(out)) return false;
+        skip_ws();
+        return p_ == end_;
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+
+    void skip_ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) p_++;
+    }
+
+    bool expect(char c) {
+        skip_ws();
+        if (p_ >= end_ || *p_ != c) return false;
+        p_++;
+        return true;
+    }
+
+    bool literal(const char* word) {
+        size_t len = strlen(word);
+        if (static_cast<size_t>(end_ - p_) < len || strncmp(p_, word, len) != 0) return false;
+        p_ += len;
+        return true;
+    }
+
+    bool parse_value(JsonValue& out) {
+        skip_ws();
+        if (p_ >= end_) return false;
+        switch (*p_) {
+            case '{': return parse_object(out);
+            case '[': return parse_array(out);
+            case '"': out.type = JsonValue::Type::String; return parse_string(out.string);
+            case 't': out.type = JsonValue::Type::Bool; out.boolean = true;  return literal("true");
+            case 'f': out.type = JsonValue::Type::Bool; out.boolean = false; return literal("false");
+            case 'n': out.type = JsonValue::Type::Null; return literal("null");
+            default:  return parse_number(out);
+        }
+    }
+
+    bool parse_number(JsonValue& out) {
+        char* num_end = nullptr;
+        out.type = JsonValue::Type::Number;
+        out.number = strtod(p_, &num_end);
+        if (num_end == p_ || num_end > end_) return false;
+        p_ = num_end;
+        return true;
+    }
+
+    bool parse_string(std::string& out) {
+        p_++;  // opening quote
+        while (p_ < end_ && *p_ != '"') {
+            if (*p_ == '\\') {
+                if (++p_ >= end_) return false;
+                switch (*p_) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'u': out += '?'; p_ += 4; break;  // not needed for test names
+                    default:  out += *p_; break;
+                }
+                p_++;
+            } else {
+                out += *p_++;
+            }
+        }
+        if (p_ >= end_) return false;
+        p_++;  // closing quote
+        return true;
+    }
+
+    bool parse_array(JsonValue& out) {
+        out.type = JsonValue::Type::Array;
+        p_++;
+        skip_ws();
+        if (p_ < end_ && *p_ == ']') { p_++; return true; }
+        while (true) {
+            out.array.emplace_back();
+            if (!parse_value(out.array.back())) return false;
+            skip_ws();
+            if (p_ < end_ && *p_ == ',') { p_++; continue; }
+            return expect(']');
+        }
+    }
+
+    bool parse_object(JsonValue& out) {
+        out.type = JsonValue::Type::Object;
+        p_++;
+        skip_ws();
+        if (p_ < end_ && *p_ == '}') { p_++; return true; }
+        while (true) {
+            skip_ws();
+            if (p_ >= end_ || *p_ != '"') return false;
+            out.object.emplace_back();
+            if (!parse_string(out.object.back().first)) return false;
+            if (!expect(':')) return false;
+            if (!parse_value(out.object.back().second)) return false;
+            skip_ws();
+            if (p_ < end_ && *p_ == ',') { p_++; continue; }
+            return expect('}');
+        }
+    }
+};
+
+// ---------- Vector execution ----------
+
+static SimpleRam ram;
+
+struct FileResult {
+    int vectors = 0;
+    int state_mismatches = 0;
+    int cycle_mismatches = 0;
+};
+
+template<typename Cpu>
+static void load_state(Cpu& cpu, const JsonValue& state) {
+    cpu.reg.pc = state.find("pc")->as_int();
+    cpu.reg.sp = state.find("s")->as_int();
+    cpu.reg.a = state.find("a")->as_int();
+    cpu.reg.x = state.find("x")->as_int();
+    cpu.reg.y = state.find("y")->as_int();
+    cpu.reg.flag.set_value(state.find("p")->as_int());
+    for (const auto& cell : state.find("ram")->array) {
+        ram[cell.array[0].as_int()] = cell.array[1].as_int();
+    }
+}
+
+// Compare registers and memory against the expected state, printing differences when verbose
+template<typename Cpu>
+static bool check_state(const Cpu& cpu, const JsonValue& state, bool verbose) {
+    bool ok = true;
+    auto check_reg = [&](const char* name, int actual) {
+        int expected = state.find(name)->as_int();
+        if (std::string(name) == "p") {
+            // B and bit 5 are not real flags - only their pushed copies matter
+            actual |= 0x30;
+            expected |= 0x30;
+        }
+        if (actual != expected) {
+            if (verbose) printf("      %s=%02X, expected %02X\n", name, actual, expected);
+            ok = false;
+        }
+    };
+    check_reg("pc", cpu.reg.pc);
+    check_reg("s", cpu.reg.sp);
+    check_reg("a", cpu.reg.a);
+    check_reg("x", cpu.reg.x);
+    check_reg("y", cpu.reg.y);
+    check_reg("p", cpu.reg.flag.value());
+
+    for (const auto& cell : state.find("ram")->array) {
+        uint16_t addr = cell.array[0].as_int();
+        uint8_t expected = cell.array[1].as_int();
+        if (ram[addr] != expected) {
+            if (verbose) printf("      ram[$%04X]=%02X, expected %02X\n", addr, ram[addr], expected);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Addresses the CPU wrote during the current vector, so they can be cleared
+// after it even when a wrong implementation writes outside the expected state
+static std::vector<uint16_t> written;
+
+static void tracked_write(uint16_t addr, uint8_t val) {
+    written.push_back(addr);
+    ram[addr] = val;
+}
+
+template<typename Cpu>
+static FileResult run_file(const JsonValue& vectors) {
+    FileResult result;
+    int reported = 0;
+
+    // One CPU and one RAM image for the whole file. After each vector only the
+    // addresses it loaded or the CPU wrote are zeroed again, not all 64K
+    Cpu cpu;
+    cpu.ram_read = &SimpleRam::static_read;
+    cpu.ram_write = &tracked_write;
+    SimpleRam::set_instance(&ram);
+    ram.reset();
+
+    for (const auto& v : vectors.array) {
+        const JsonValue* name = v.find("name");
+        const JsonValue* initial = v.find("initial");
+        const JsonValue* final_state = v.find("final");
+        const JsonValue* cycles = v.find("cycles");
+        if (!initial || !final_state || !cycles) continue;
+
+        cpu.reset();
+        load_state(cpu, *initial);
+
+        int actual_cycles = cpu.step();
+        int expected_cycles = static_cast<int>(cycles->array.size());
+        result.vectors++;
+
+        bool state_ok = check_state(cpu, *final_state, false);
+        bool cycles_ok = (actual_cycles == expected_cycles);
+        if (!state_ok) result.state_mismatches++;
+        if (!cycles_ok) result.cycle_mismatches++;
+
+        if ((!state_ok || !cycles_ok) && reported < MAX_REPORTED_MISMATCHES) {
+            reported++;
+            printf("    vector \"%s\":\n", name ? name->string.c_str() : "?");
+            if (!cycles_ok) printf("      cycles=%d, expected %d\n", actual_cycles, expected_cycles);
+            if (!state_ok) check_state(cpu, *final_state, true);
+        }
+
+        for (const auto& cell : initial->find("ram")->array) {
+            ram[cell.array[0].as_int()] = 0;
+        }
+        for (uint16_t addr : written) ram[addr] = 0;
+        written.clear();
+    }
+    return result;
+}
+
+template<typename Cpu>
+static void run_files(const char* variant, const std::vector<fs::path>& files, const std::set<int>& skip) {
+    for (const auto& path : files) {
+        std::string label = std::string(variant) + " " + path.filename().string();
+
+        // Opcode files are named by their hex opcode (e.g. "a9.json")
+        int opcode = static_cast<int>(strtol(path.stem().string().c_str(), nullptr, 16));
+        if (skip.count(opcode)) {
+            printf("  SKIP: %s\n", label.c_str());
+            continue;
+        }
+
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream text;
+        text << in.rdbuf();
+
+        JsonValue vectors;
+        if (!JsonParser(text.str()).parse(vectors) || vectors.type != JsonValue::Type::Array) {
+            printf("    parse error\n");
+            TEST_ASSERT(label.c_str(), false);
+            continue;
+        }
+
+        FileResult r = run_file<Cpu>(vectors);
+        char name[160];
+        snprintf(name, sizeof(name), "%s (%d vectors, %d state / %d cycle mismatches)",
+                 label.c_str(), r.vectors, r.state_mismatches, r.cycle_mismatches);
+        TEST_ASSERT(name, r.vectors > 0 && r.state_mismatches == 0 && r.cycle_mismatches == 0);
+    }
+}
+
+// ---------- Main ----------
+
+static std::vector<fs::path> collect_files(const std::vector<std::string>& args) {
+    std::vector<fs::path> files;
+    for (const auto& arg : args) {
+        std::error_code ec;
+        if (fs::is_directory(arg, ec)) {
+            for (const auto& entry : fs::directory_iterator(arg, ec)) {
+                if (entry.path().extension() == ".json") files.push_back(entry.path());
+            }
+        } else if (fs::is_regular_file(arg, ec)) {
+            files.emplace_back(arg);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+static std::set<int> parse_skip_list(const char* list) {
+    std::set<int> skip;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) skip.insert(static_cast<int>(strtol(item.c_str(), nullptr, 16)));
+    }
+    return skip;
+}
+
+int main(int argc, char** argv) {
+    const char* variant = "wdc65c02";
+    std::set<int> skip;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--variant") && i + 1 < argc) {
+            variant = argv[++i];
+        } else if (!strcmp(argv[i], "--skip") && i + 1 < argc) {
+            skip = parse_skip_list(argv[++i]);
+        } else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    std::vector<fs::path> files = collect_files(paths);
+    if (files.empty()) {
+        printf("SKIP: no JSON test vectors found\n");
+        return SKIP_RETURN_CODE;
+    }
+
+    printf("Opcode test vectors [%s]: %zu files\n", variant, files.size());
+
+    if (!strcmp(variant, "6502")) {
+        run_files<NMOS6502>(variant, files, skip);
+    } else if (!strcmp(variant, "synertek65c02")) {
+        run_files<C65C02>(variant, files, skip);
+    } else if (!strcmp(variant, "rockwell65c02")) {
+        run_files<R65C02>(variant, files, skip);
+    } else if (!strcmp(variant, "wdc65c02")) {
+        run_files<W65C02S>(variant, files, skip);
+    } else {
+        printf("unknown variant: %s\n", variant);
+        return 2;
+    }
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+//
+// Reverse execution tests
+//
+// Copyright 2026, John Clark
+//
+// Records a run of a program with keyboard input, random bytes and a periodic
+// IRQ while logging every step, then moves back and forth with Rewinder and
+// checks each position against the log. Also checks that the snapshot budget
+// is respected, and that cutting the history after a change resumes recording.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "w65c02s.hpp"
+#include "ram.hpp"
+#include "io_log.hpp"
+#include "rewind.hpp"
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+// ---------- Program ----------
+
+// Poll $FF, store each key and a $FE random byte at $0300,y; the IRQ handler
+// counts interrupts in $10 and scribbles the count across page $40
+static const uint16_t load_addr = 0x0600;
+static const uint8_t program[] = {
+    0x58,               // $0600  cli
+    0xa0, 0x00,         // $0601  ldy #$00
+    0xa5, 0xff,         // $0603  lda $ff
+    0xf0, 0xfc,         // $0605  beq $0603
+    0x99, 0x00, 0x03,   // $0607  sta $0300,y
+    0xc8,               // $060a  iny
+    0xa5, 0xfe,         // $060b  lda $fe
+    0x99, 0x00, 0x03,   // $060d  sta $0300,y
+    0xc8,               // $0610  iny
+    0x80, 0xf0,         // $0611  bra $0603
+};
+static const uint8_t irq_handler[] = {
+    0xe6, 0x10,         // $0700  inc $10
+    0xa6, 0x10,         // $0702  ldx $10
+    0xa5, 0x10,         // $0704  lda $10
+    0x9d, 0x00, 0x40,   // $0706  sta $4000,x
+    0x40,               // $0709  rti
+};
+
+static constexpr uint16_t KEY_STORE_PC = 0x0607;
+
+struct Logged {
+    uint16_t pc;
+    uint8_t a, y;
+    uint64_t cycles;
+};
+
+static HookedRam ram;
+static W65C02S cpu;
+static IoLog io_log;
+static IoPrng prng;
+static std::vector<uint32_t> io_words(1 << 16);
+static std::vector<std::pair<uint64_t, uint8_t>> keys;
+static size_t next_key;
+
+static uint8_t page0_read_hook(uint16_t addr, void*) {
+    if (addr == 0x00FF) {
+        uint8_t live = 0;
+        if (next_key < keys.size() && keys[next_key].first <= cpu.cycles) live = keys[next_key++].second;
+        return io_log.read(addr, cpu.cycles, live);
+    }
+    if (addr == 0x00FE) return prng.next_byte();
+    return ram[addr];
+}
+
+// IRQ input sampled once per 1024-cycle slice: high for one slice in eight
+static void slice_hook(uint64_t cycles_before) {
+    if (cycles_before / 1024 == cpu.cycles / 1024) return;
+    bool live = (cpu.cycles / 1024) % 8 == 0;
+    if (io_log.line(IO_LINE_IRQ, cpu.cycles, live)) cpu.trigger_irq(); else cpu.clear_irq();
+}
+
+static void setup() {
+    ram.reset();
+    ram.load(load_addr, program, sizeof(program));
+    ram.load(0x0700, irq_handler, sizeof(irq_handler));
+    ram[0xfffe] = 0x00;
+    ram[0xffff] = 0x07;
+    ram.set_read_hook(0x00, page0_read_hook);
+    HookedRam::set_instance(&ram);
+    cpu.ram_read = &HookedRam::static_read;
+    cpu.ram_write = &HookedRam::static_write;
+    cpu.reset();
+    cpu.reg.pc = load_addr;
+    prng.seed_with(99);
+    next_key = 0;
+    io_log.record(io_words.data(), io_words.size());
+}
+
+// Run to cycles through the rewinder, logging the state at every position
+static std::vector<Logged> record_run(Rewinder<W65C02S>& rw, uint64_t cycles) {
+    std::vector<Logged> log;
+    while (cpu.cycles < cycles) {
+        log.push_back({cpu.reg.pc, cpu.reg.a, cpu.reg.y, cpu.cycles});
+        rw.step();
+    }
+    log.push_back({cpu.reg.pc, cpu.reg.a, cpu.reg.y, cpu.cycles});
+    return log;
+}
+
+static bool at(const Logged& l) {
+    return cpu.reg.pc == l.pc && cpu.reg.a == l.a && cpu.reg.y == l.y && cpu.cycles == l.cycles;
+}
+
+static void test_step_and_seek() {
+    printf("step back and seek:\n");
+    setup();
+    keys = {{3000, 'a'}, {9000, 'b'}, {150000, 'c'}, {700000, 'd'}};
+    Rewinder<W65C02S> rw(cpu, ram.data(), &io_log, &prng, {20000, 16u << 20});
+    rw.set_step_hook(slice_hook);
+    rw.start();
+
+    auto log = record_run(rw, 1000000);
+    uint64_t end = rw.position();
+    uint32_t end_hash = io_log_ram_hash(ram.data(), 0x10000);
+
+    TEST_ASSERT("step back one", rw.step_back() && rw.position() == end - 1 && at(log[end - 1]));
+    TEST_ASSERT("step back across snapshots", rw.step_back(30000) && at(log[end - 30001]));
+    TEST_ASSERT("seek to the start", rw.seek(0) && at(log[0]));
+
+    bool ok = true;
+    for (uint64_t pos = 1000; pos < end; pos += 17011) ok &= rw.seek(pos) && at(log[pos]);
+    TEST_ASSERT("seek to scattered positions", ok);
+
+    TEST_ASSERT("seek back to the end reproduces memory",
+                rw.seek(end) && at(log[end]) && io_log_ram_hash(ram.data(), 0x10000) == end_hash);
+    TEST_ASSERT("replay stayed in step with the input log", !io_log.diverged());
+
+    // The last key store before the end, found by scanning the log
+    uint64_t expect = 0;
+    for (uint64_t i = 0; i < end; i++) if (log[i].pc == KEY_STORE_PC) expect = i;
+    bool found = rw.run_back([](const W65C02S& c) { return c.reg.pc == KEY_STORE_PC; });
+    TEST_ASSERT("run back to breakpoint", found && rw.position() == expect && at(log[expect]) && cpu.reg.a == 'd');
+
+    found = rw.run_back([](const W65C02S& c) { return c.reg.pc == KEY_STORE_PC; });
+    TEST_ASSERT("run back to the previous hit", found && cpu.reg.a == 'c');
+
+    found = rw.run_back([](const W65C02S& c) { return c.reg.pc == 0x1234; });
+    TEST_ASSERT("run back without a hit stops at the oldest snapshot", !found && rw.position() == rw.oldest());
+}
+
+static void test_budget() {
+    printf("memory budget:\n");
+    setup();
+    keys = {};
+    const size_t budget = 256 * 1024;
+    Rewinder<W65C02S> rw(cpu, ram.data(), &io_log, &prng, {2000, budget});
+    rw.set_step_hook(slice_hook);
+    rw.start();
+
+    auto log = record_run(rw, 4000000);
+    uint64_t end = rw.position();
+    TEST_ASSERT("memory stays within budget", rw.memory_bytes() <= budget);
+    TEST_ASSERT("oldest history dropped", rw.oldest() > 0 && !rw.seek(rw.oldest() - 1));
+    TEST_ASSERT("oldest reachable position is exact", rw.seek(rw.oldest()) && at(log[rw.oldest()]));
+    TEST_ASSERT("back to the end", rw.seek(end) && at(log[end]));
+}
+
+static void test_long_run() {
+    printf("long run:\n");
+    setup();
+    keys = {{1000, 'x'}};
+    Rewinder<W65C02S> rw(cpu, ram.data(), &io_log, &prng);
+    rw.set_step_hook(slice_hook);
+    rw.start();
+    while (cpu.cycles < 100000000) rw.step();
+    uint64_t end = rw.position();
+    uint16_t end_pc = cpu.reg.pc;
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool back = rw.step_back(1);
+    auto t1 = std::chrono::steady_clock::now();
+    bool fwd = rw.seek(end);
+    double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    printf("  %zu snapshots, %zu KB, step back in %.2f ms\n",
+           rw.snapshot_count(), rw.memory_bytes() / 1024, ms);
+    TEST_ASSERT("step back after 100M cycles", back && fwd && cpu.reg.pc == end_pc);
+    TEST_ASSERT("step back is interactive (< 100 ms)", ms < 100.0);
+}
+
+static void test_cut_future() {
+    printf("cut future:\n");
+    setup();
+    keys = {{3000, 'a'}, {200000, 'b'}};
+    Rewinder<W65C02S> rw(cpu, ram.data(), &io_log, &prng, {20000, 16u << 20});
+    rw.set_step_hook(slice_hook);
+    rw.start();
+    record_run(rw, 300000);
+    TEST_ASSERT("second key recorded", ram[0x0302] == 'b');
+
+    // Go back before the second key, change memory, then run on with new input
+    rw.seek(0);
+    while (cpu.cycles < 100000) rw.step();
+    ram[0x0300] = 'Z';
+    rw.cut_future();
+    keys = {{150000, 'q'}};
+    next_key = 0;
+    while (cpu.cycles < 300000) rw.step();
+    TEST_ASSERT("edit kept and new input recorded",
+                ram[0x0300] == 'Z' && ram[0x0302] == 'q' && io_log.mode() == IoLog::RECORD);
+
+    uint64_t end = rw.position();
+    uint8_t end_a = cpu.reg.a;
+    rw.step_back(50000);
+    TEST_ASSERT("new history replays", rw.seek(end) && cpu.reg.a == end_a && ram[0x0302] == 'q');
+}
+
+int main() {
+    printf("Reverse execution tests\n\n");
+
+    test_step_and_seek();
+    test_budget();
+    test_long_run();
+    test_cut_future();
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
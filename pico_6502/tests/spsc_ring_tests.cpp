@@ -0,0 +1,145 @@
+//
+// Single-producer/single-consumer ring tests
+//
+// Copyright 2026, John Clark
+//
+// Checks the ring bookkeeping on one thread, then streams a counting
+// sequence between two threads to catch lost, duplicated or torn elements.
+//
+
+#include <cstdio>
+#include <thread>
+#include "spsc_ring.hpp"
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+// ---------- Single-threaded ----------
+
+static void test_push_pop() {
+    printf("push/pop:\n");
+    SpscRing<uint8_t, 8> ring;
+    uint8_t v = 0;
+
+    TEST_ASSERT("starts empty", ring.empty() && ring.size() == 0 && !ring.pop(v));
+
+    bool all_pushed = true;
+    for (uint8_t i = 0; i < 8; i++) all_pushed &= ring.push(i);
+    TEST_ASSERT("holds all N elements", all_pushed && ring.full() && ring.size() == 8);
+    TEST_ASSERT("push fails when full", !ring.push(99) && ring.size() == 8);
+
+    bool in_order = true;
+    for (uint8_t i = 0; i < 8; i++) in_order &= ring.pop(v) && v == i;
+    TEST_ASSERT("pops in FIFO order", in_order && ring.empty());
+
+    // Run the indices around the ring several times
+    bool wrapped = true;
+    for (int i = 0; i < 100; i++) {
+        wrapped &= ring.push((uint8_t)i) && ring.push((uint8_t)(i + 1));
+        wrapped &= ring.pop(v) && v == (uint8_t)i && ring.pop(v) && v == (uint8_t)(i + 1);
+    }
+    TEST_ASSERT("wraps around", wrapped && ring.empty());
+}
+
+static void test_batch() {
+    printf("batch:\n");
+    SpscRing<uint16_t, 16> ring;
+    uint16_t in[20], out[20] = {0};
+    for (int i = 0; i < 20; i++) in[i] = (uint16_t)(1000 + i);
+
+    TEST_ASSERT("batch push stops at capacity", ring.push(in, 20) == 16 && ring.full());
+    TEST_ASSERT("batch pop partial", ring.pop(out, 5) == 5 && out[0] == 1000 && out[4] == 1004);
+    TEST_ASSERT("batch push across the wrap", ring.push(in + 16, 4) == 4 && ring.size() == 15);
+
+    size_t n = ring.pop(out, 20);
+    bool ok = n == 15;
+    for (size_t i = 0; i < n; i++) ok &= out[i] == 1005 + i;
+    TEST_ASSERT("batch pop across the wrap", ok && ring.empty());
+    TEST_ASSERT("batch pop from empty", ring.pop(out, 4) == 0);
+}
+
+static void test_peek_clear() {
+    printf("peek/drop/clear:\n");
+    struct Event { uint32_t cycle; uint8_t reg; uint8_t val; };
+    SpscRing<Event, 4> ring;
+
+    TEST_ASSERT("peek empty is null", ring.peek() == nullptr);
+    ring.push({100, 1, 2});
+    ring.push({200, 3, 4});
+    const Event* ev = ring.peek();
+    TEST_ASSERT("peek returns oldest", ev && ev->cycle == 100 && ev->reg == 1 && ring.size() == 2);
+    ring.drop();
+    ev = ring.peek();
+    TEST_ASSERT("drop advances", ev && ev->cycle == 200 && ring.size() == 1);
+
+    ring.clear();
+    TEST_ASSERT("clear empties", ring.empty() && ring.peek() == nullptr);
+    TEST_ASSERT("usable after clear", ring.push({300, 5, 6}) && ring.peek()->cycle == 300);
+}
+
+// ---------- Two threads ----------
+
+static void test_threads() {
+    printf("producer/consumer threads:\n");
+    static constexpr uint32_t COUNT = 500000;
+    static SpscRing<uint32_t, 64> ring;
+
+    std::thread producer([] {
+        uint32_t next = 0, batch[7];
+        while (next < COUNT) {
+            // Alternate single and batch pushes
+            size_t pushed;
+            if (next & 1) {
+                pushed = ring.push(next) ? 1 : 0;
+            } else {
+                uint32_t n = 0;
+                while (n < 7 && next + n < COUNT) { batch[n] = next + n; n++; }
+                pushed = ring.push(batch, n);
+            }
+            next += (uint32_t)pushed;
+            if (!pushed) std::this_thread::yield();  // full: let the consumer run
+        }
+    });
+
+    uint32_t expected = 0, mismatches = 0, batch[5];
+    while (expected < COUNT) {
+        size_t n;
+        if (expected & 2) {
+            n = ring.pop(batch[0]) ? 1 : 0;
+        } else {
+            n = ring.pop(batch, 5);
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (batch[i] != expected) mismatches++;
+            expected++;
+        }
+        if (!n) std::this_thread::yield();  // empty: let the producer run
+    }
+    producer.join();
+
+    TEST_ASSERT("every element arrives once, in order", mismatches == 0 && expected == COUNT);
+    TEST_ASSERT("ring drained", ring.empty());
+}
+
+int main() {
+    printf("SpscRing tests\n\n");
+
+    test_push_pop();
+    test_batch();
+    test_peek_clear();
+    test_threads();
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+//
+// Execution trace record/decode tests
+//
+// Copyright 2026, John Clark
+//
+// Runs a small program with a TraceBuffer attached while logging every
+// instruction separately, then checks that decoding the ring reproduces the
+// logged PCs, opcodes, register changes and stack pointer - from the start of
+// an unwrapped trace, and from the first keyframe of one that has wrapped many
+// times.
+//
+
+#include <cstdio>
+#include <vector>
+#include "w65c02s.hpp"
+#include "ram.hpp"
+
+// ---------- Test framework ----------
+
+static int tests_run, tests_passed, tests_failed;
+
+#define TEST_ASSERT(name, cond) do { \
+    tests_run++; \
+    if (cond) { tests_passed++; printf("  PASS: %s\n", name); } \
+    else { tests_failed++; printf("  FAIL: %s\n", name); } \
+} while(0)
+
+// ---------- Program ----------
+
+// Loop with short branches, a far JSR/RTS, stack traffic and an IRQ handler at $0700
+static const uint16_t load_addr = 0x0600;
+static const uint8_t program[] = {
+    0x58,               // $0600  cli
+    0xa2, 0x00,         // $0601  ldx #$00
+    0x8a,               // $0603  txa
+    0x69, 0x03,         // $0604  adc #$03
+    0x48,               // $0606  pha
+    0xa8,               // $0607  tay
+    0x20, 0x00, 0x08,   // $0608  jsr $0800
+    0x68,               // $060b  pla
+    0xe8,               // $060c  inx
+    0xd0, 0xf4,         // $060d  bne $0603
+    0x4c, 0x01, 0x06,   // $060f  jmp $0601
+};
+static const uint8_t irq_handler[] = {
+    0xe6, 0x10,         // $0700  inc $10
+    0x40,               // $0702  rti
+};
+static const uint8_t subroutine[] = {
+    0x88,               // $0800  dey
+    0x10, 0xfd,         // $0801  bpl $0800
+    0x60,               // $0803  rts
+};
+
+struct Logged {
+    uint16_t pc;
+    uint8_t opcode;
+    uint8_t a, x, y, sp;
+};
+
+static SimpleRam ram;
+
+// Run n steps, logging each instruction (and raising an IRQ every irq_every steps)
+static std::vector<Logged> run(W65C02S& cpu, int n, int irq_every) {
+    std::vector<Logged> log;
+    for (int i = 0; i < n; i++) {
+        if (irq_every && i % irq_every == 0) cpu.trigger_irq();
+        bool takes_irq = cpu.irq_pending && !cpu.reg.flag.i();
+        uint16_t pc = cpu.reg.pc;
+        uint8_t opcode = ram[pc];
+        cpu.step();
+        if (takes_irq) {
+            cpu.clear_irq();
+            continue;
+        }
+        log.push_back({pc, opcode, cpu.reg.a, cpu.reg.x, cpu.reg.y, cpu.reg.sp});
+    }
+    return log;
+}
+
+static bool matches(const TraceStep& s, const Logged& l) {
+    if (s.kind != TraceStep::INSTRUCTION || s.pc != l.pc || s.opcode != l.opcode || s.sp != l.sp) return false;
+    switch (s.reg) {
+        case TRACE_REG_A: case TRACE_REG_PULL_A: return s.value == l.a;
+        case TRACE_REG_X: case TRACE_REG_PULL_X: return s.value == l.x;
+        case TRACE_REG_Y: case TRACE_REG_PULL_Y: return s.value == l.y;
+        case TRACE_REG_SP: return s.value == l.sp;
+        default: return true;
+    }
+}
+
+// Instructions only, dropping START/IRQ/NMI markers
+static std::vector<TraceStep> instructions(const std::vector<TraceStep>& steps) {
+    std::vector<TraceStep> out;
+    for (const auto& s : steps) {
+        if (s.kind == TraceStep::INSTRUCTION) out.push_back(s);
+    }
+    return out;
+}
+
+static void test_trace(const char* label, uint32_t ring_records, int steps, int irq_every) {
+    printf("%s:\n", label);
+
+    ram.reset();
+    ram.load(load_addr, program, sizeof(program));
+    ram.load(0x0700, irq_handler, sizeof(irq_handler));
+    ram.load(0x0800, subroutine, sizeof(subroutine));
+    ram[0xfffe] = 0x00;
+    ram[0xffff] = 0x07;
+
+    W65C02S cpu;
+    SimpleRam::set_instance(&ram);
+    cpu.ram_read = &SimpleRam::static_read;
+    cpu.ram_write = &SimpleRam::static_write;
+    cpu.reset();
+    cpu.reg.pc = load_addr;
+
+    std::vector<uint32_t> storage(ring_records);
+    TraceBuffer trace(storage.data(), ring_records);
+    trace.start(cpu.reg.pc, cpu.reg.sp);
+    cpu.trace = &trace;
+
+    auto log = run(cpu, steps, irq_every);
+
+    std::vector<uint32_t> records;
+    for (size_t i = 0; i < trace.size(); i++) records.push_back(trace.at(i));
+    auto decoded = trace_decode(records, [&](uint8_t op) { return cpu.opcode_entry(op).mode.bytes; });
+    auto insns = instructions(decoded);
+
+    // The decoded instructions are the most recent ones in the log
+    bool ok = !insns.empty() && insns.size() <= log.size();
+    size_t offset = log.size() - insns.size();
+    for (size_t i = 0; ok && i < insns.size(); i++) {
+        if (!matches(insns[i], log[offset + i])) {
+            printf("  mismatch at %zu: trace $%04X %02X, log $%04X %02X\n",
+                   i, insns[i].pc, insns[i].opcode, log[offset + i].pc, log[offset + i].opcode);
+            ok = false;
+        }
+    }
+    TEST_ASSERT("decoded instructions match the execution log", ok);
+
+    bool saw_irq = false;
+    for (const auto& s : decoded) saw_irq |= s.kind == TraceStep::IRQ && s.pc == 0x0700;
+    TEST_ASSERT("interrupts are marked", !irq_every || saw_irq);
+
+    if (trace.size() < trace.capacity()) {
+        TEST_ASSERT("unwrapped trace decodes from the start", insns.size() == log.size() && decoded[0].kind == TraceStep::START);
+    } else {
+        // Only records before the first keyframe are lost
+        TEST_ASSERT("wrapped trace resyncs within a keyframe",
+                    insns.size() + TRACE_KEYFRAME_INTERVAL >= ring_records / 2);
+    }
+}
+
+int main() {
+    printf("Execution trace tests\n\n");
+
+    test_trace("unwrapped", 4096, 1500, 0);
+    test_trace("wrapped with interrupts", 1024, 50000, 97);
+
+    printf("\n========================================\n");
+    printf("  Results: %d run, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+    printf("========================================\n");
+
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,467 @@
+//
+// Headless runner for the pico_6502 programs
+//
+// Copyright 2026, John Clark
+//
+// Runs one program header (PROGRAM_HEADER, one binary per program) with the
+// firmware's I/O map but no display, sound or serial devices, and reports the
+// cycle count, wall time and a hash of emulated RAM. With --record the
+// keyboard input given by --keys is logged; with --replay a log captured here
+// or dumped by the firmware (IOLOG BEGIN/END on the serial console) is played
+// back, so two runs of an interactive program can be compared exactly. The
+// result line matches the firmware's replay report.
+//
+// Usage: headless_<program> [--seed <n>] [--cycles <n>] [--keys <cycle>:<text>]...
+//                           [--record <out.log>] [--replay <console.log>]
+//                           [--header <replay.h>] [--back <steps>] [--gdb <port>]
+//
+// In --keys text, \r and \e stand for Return and Escape. --back runs under
+// the Rewinder, then steps back the given number of instructions and forward
+// again, timing both and checking the memory image comes back identical.
+// --gdb waits for gdb on a localhost TCP port ("target remote :<port>") and
+// runs under its control, stopped at the reset vector, with reverse step and
+// continue through the Rewinder; the run ends when gdb disconnects.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "w65c02s.hpp"
+#include "ram.hpp"
+#include "io_log.hpp"
+#include "rewind.hpp"
+#include "gdb_stub.hpp"
+#include "blitter.hpp"
+
+#include PROGRAM_HEADER
+
+#ifndef PROGRAM_CPU
+#define PROGRAM_CPU W65C02S
+#endif
+
+#ifndef PROGRAM_VIDEO_MODE
+#define PROGRAM_VIDEO_MODE 0
+#endif
+
+#ifndef PROGRAM_CLK_FREQ_KHZ
+#define PROGRAM_CLK_FREQ_KHZ 1000
+#endif
+
+#ifndef PROGRAM_FRAME_RATE
+#define PROGRAM_FRAME_RATE 30
+#endif
+
+#ifndef PROGRAM_BLITTER_COST
+#define PROGRAM_BLITTER_COST 16
+#endif
+
+// Firmware I/O map and slice length (see main.cpp)
+static constexpr uint16_t VIDEO_REG_BASE = 0xD300;
+static constexpr uint16_t SOUND_BASE = 0xD400;
+static constexpr uint16_t ACIA_BASE = 0xD500;
+static constexpr uint16_t BLITTER_BASE = 0xD600;
+static constexpr uint8_t SOUND_REG_UNDERRUN = 0x10;
+static constexpr uint8_t VIDEO_MODE_COUNT = 4;
+static constexpr uint8_t VIDEO_REG_VBLANK = 0x01;
+static constexpr uint8_t VIDEO_REG_FPS = 0x02;
+static constexpr uint8_t VIDEO_REG_FRAME = 0x03;
+static constexpr uint8_t VBLANK_FLAG = 0x80;
+static constexpr uint8_t VBLANK_IRQ_ENABLE = 0x01;
+static constexpr uint8_t FRAME_RATE_MAX = 60;
+static constexpr uint32_t SLICE_CYCLES = 1024;
+
+struct Key {
+    uint64_t cycle;  // available from this cycle on
+    uint8_t ch;
+};
+
+static HookedRam ram;
+static PROGRAM_CPU cpu;
+static IoLog io_log;
+static IoPrng prng;
+static Blitter blitter(ram.data(), BLITTER_BASE);
+static std::deque<Key> keys;
+
+// No display: vblank comes every CPU clock / frame rate cycles instead
+static uint64_t next_vblank_cycle;
+static uint8_t frame_counter;
+static bool vblank_flag;
+static bool vblank_irq_enabled;
+
+static uint8_t keyboard_getchar() {
+    if (keys.empty() || keys.front().cycle > cpu.cycles) return 0;
+    uint8_t ch = keys.front().ch;
+    keys.pop_front();
+    return ch;
+}
+
+static uint8_t page0_read_hook(uint16_t addr, void*) {
+    if (addr == 0x00FF) return io_log.read(addr, cpu.cycles, keyboard_getchar());
+    if (addr == 0x00FE) return prng.next_byte();
+    return ram[addr];
+}
+
+static void update_irq_line();
+
+static void video_reg_write_hook(uint16_t addr, uint8_t val, void*) {
+    switch (addr & 0xFF) {
+        case 0:
+            ram[addr] = val < VIDEO_MODE_COUNT ? val : 0;
+            break;
+        case VIDEO_REG_VBLANK:
+            vblank_irq_enabled = (val & VBLANK_IRQ_ENABLE) != 0;
+            update_irq_line();
+            break;
+        case VIDEO_REG_FPS:
+            ram[addr] = (val >= 1 && val <= FRAME_RATE_MAX) ? val : (uint8_t)PROGRAM_FRAME_RATE;
+            break;
+    }
+}
+
+static uint8_t video_reg_read_hook(uint16_t addr, void*) {
+    switch (addr & 0xFF) {
+        case VIDEO_REG_VBLANK: {
+            uint8_t status = (vblank_flag ? VBLANK_FLAG : 0) | (vblank_irq_enabled ? VBLANK_IRQ_ENABLE : 0);
+            vblank_flag = false;
+            update_irq_line();
+            return io_log.read(addr, cpu.cycles, status);
+        }
+        case VIDEO_REG_FRAME:
+            return io_log.read(addr, cpu.cycles, frame_counter);
+        default:
+            return ram[addr];
+    }
+}
+
+// No sound or serial hardware: live values are idle, replay supplies the recorded ones
+static uint8_t sound_read_hook(uint16_t addr, void*) {
+    uint8_t reg = addr & 0xFF;
+    if (reg == SOUND_REG_UNDERRUN || reg == SOUND_REG_UNDERRUN + 1) return io_log.read(addr, cpu.cycles, 0);
+    return ram[addr];
+}
+
+static void update_irq_line() {
+    if (io_log.line(IO_LINE_IRQ, cpu.cycles, vblank_flag && vblank_irq_enabled)) {
+        cpu.trigger_irq();
+    } else {
+        cpu.clear_irq();
+    }
+}
+
+static uint8_t acia_read_hook(uint16_t addr, void*) {
+    uint8_t val = io_log.read(ACIA_BASE | (addr & 0x03), cpu.cycles, 0);
+    update_irq_line();
+    return val;
+}
+
+static void acia_write_hook(uint16_t, uint8_t, void*) {
+    update_irq_line();
+}
+
+static void blitter_write_hook(uint16_t addr, uint8_t val, void*) {
+    if ((addr & 0xFF) == BLIT_COMMAND) cpu.cycles += blitter.run(val);
+}
+
+// Slice boundary housekeeping after a step (vblank and the IRQ line are sampled once per slice)
+static void slice_hook(uint64_t cycles_before) {
+    if (cycles_before / SLICE_CYCLES == cpu.cycles / SLICE_CYCLES) return;
+    while (cpu.cycles >= next_vblank_cycle) {
+        next_vblank_cycle += PROGRAM_CLK_FREQ_KHZ * 1000ull / ram[VIDEO_REG_BASE + VIDEO_REG_FPS];
+        frame_counter++;
+        vblank_flag = true;
+    }
+    update_irq_line();
+}
+
+// Words of the last IOLOG BEGIN/END block in a log file
+static bool load_log(const char* path, uint32_t& seed, uint64_t& end_cycle, std::vector<uint32_t>& words) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    bool found = false, in_log = false;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        if (!strncmp(line, "IOLOG BEGIN", 11)) {
+            unsigned long s = 0, n = 0;
+            unsigned long long end = 0;
+            sscanf(line + 11, "%lu %lu %llu", &s, &n, &end);
+            seed = (uint32_t)s;
+            end_cycle = end;
+            words.clear();
+            found = in_log = true;
+            continue;
+        }
+        if (!strncmp(line, "IOLOG END", 9)) {
+            in_log = false;
+            continue;
+        }
+        if (!in_log) continue;
+
+        char* p = line;
+        char* end;
+        for (unsigned long v = strtoul(p, &end, 16); end != p; v = strtoul(p, &end, 16)) {
+            words.push_back((uint32_t)v);
+            p = end;
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+static void write_log(FILE* f, uint32_t seed, const uint32_t* words, size_t count, uint64_t end_cycle) {
+    fprintf(f, "IOLOG BEGIN %lu %zu %llu\n", (unsigned long)seed, count, (unsigned long long)end_cycle);
+    for (size_t i = 0; i < count; i++) {
+        fprintf(f, "%08lx%c", (unsigned long)words[i], (i % 8 == 7) ? '\n' : ' ');
+    }
+    fprintf(f, "\nIOLOG END\n");
+}
+
+// Replay log as a header for a PICO_6502_IO_LOG=REPLAY firmware build
+static bool write_header(const char* path, uint32_t seed, const uint32_t* words, size_t count, uint64_t end_cycle) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "// I/O replay log generated by headless runner for %s\n\n", PROGRAM_HEADER);
+    fprintf(f, "static const uint32_t io_replay_seed = %luu;\n", (unsigned long)seed);
+    fprintf(f, "static const uint64_t io_replay_end_cycle = %lluull;\n", (unsigned long long)end_cycle);
+    fprintf(f, "static const uint32_t io_replay_words[] = {\n");
+    if (count == 0) {
+        fprintf(f, "    0x00000000, 0x%08lx,  // empty log\n", (unsigned long)IO_EVENT_GAP << 24);
+    }
+    for (size_t i = 0; i < count; i++) {
+        fprintf(f, "%s0x%08lx,%s", (i % 8 == 0) ? "    " : " ", (unsigned long)words[i], (i % 8 == 7 || i + 1 == count) ? "\n" : "");
+    }
+    fprintf(f, "};\n");
+    fclose(f);
+    return true;
+}
+
+// ---------- gdb connection ----------
+
+static int gdb_fd = -1;
+static bool gdb_closed;
+
+static bool gdb_accept(int port) {
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    if (server < 0) return false;
+    int one = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(server, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(server, 1) < 0) {
+        close(server);
+        return false;
+    }
+    printf("waiting for gdb on port %d\n", port);
+    fflush(stdout);
+    gdb_fd = accept(server, nullptr, nullptr);
+    close(server);
+    return gdb_fd >= 0;
+}
+
+static int gdb_read_char() {
+    uint8_t c;
+    ssize_t n = recv(gdb_fd, &c, 1, MSG_DONTWAIT);
+    if (n == 0) gdb_closed = true;
+    return n == 1 ? c : -1;
+}
+
+static void gdb_write(const char* data, size_t len) {
+    while (len) {
+        ssize_t n = send(gdb_fd, data, len, 0);
+        if (n <= 0) {
+            gdb_closed = true;
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+// Queue "<cycle>:<text>" keystrokes
+static bool add_keys(const char* spec) {
+    char* text;
+    uint64_t cycle = strtoull(spec, &text, 0);
+    if (*text != ':') return false;
+    for (const char* p = text + 1; *p; p++) {
+        uint8_t ch = (uint8_t)*p;
+        if (ch == '\\' && p[1] == 'r') { ch = '\r'; p++; }
+        else if (ch == '\\' && p[1] == 'e') { ch = 0x1B; p++; }
+        keys.push_back({cycle, ch});
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    uint32_t seed = 1;
+    uint64_t max_cycles = 50000000;
+    bool cycles_given = false;
+    const char* record_path = nullptr;
+    const char* replay_path = nullptr;
+    const char* header_path = nullptr;
+    uint64_t back_steps = 0;
+    int gdb_port = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--cycles") && i + 1 < argc) {
+            max_cycles = strtoull(argv[++i], nullptr, 0);
+            cycles_given = true;
+        } else if (!strcmp(argv[i], "--keys") && i + 1 < argc) {
+            if (!add_keys(argv[++i])) {
+                printf("bad --keys (want <cycle>:<text>): %s\n", argv[i]);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--record") && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (!strcmp(argv[i], "--replay") && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (!strcmp(argv[i], "--header") && i + 1 < argc) {
+            header_path = argv[++i];
+        } else if (!strcmp(argv[i], "--back") && i + 1 < argc) {
+            back_steps = strtoull(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--gdb") && i + 1 < argc) {
+            gdb_port = atoi(argv[++i]);
+        } else {
+            printf("usage: %s [--seed <n>] [--cycles <n>] [--keys <cycle>:<text>]...\n"
+                   "       [--record <out.log>] [--replay <console.log>] [--header <replay.h>]\n"
+                   "       [--back <steps>] [--gdb <port>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<uint32_t> words;
+    if (replay_path) {
+        uint64_t end_cycle = 0;
+        if (!load_log(replay_path, seed, end_cycle, words)) {
+            printf("no IOLOG block in %s\n", replay_path);
+            return 1;
+        }
+        if (!cycles_given && end_cycle) max_cycles = end_cycle;
+        io_log.replay(words.data(), words.size());
+    } else {
+        // Recording is always on here; without --record it only costs the log buffer
+        words.resize(1 << 20);
+        io_log.record(words.data(), words.size());
+    }
+    prng.seed_with(seed);
+
+    HookedRam::set_instance(&ram);
+    ram.set_read_hook(0x00, page0_read_hook);
+    ram.set_write_hook(VIDEO_REG_BASE >> 8, video_reg_write_hook);
+    ram.set_read_hook(VIDEO_REG_BASE >> 8, video_reg_read_hook);
+    ram.set_read_hook(SOUND_BASE >> 8, sound_read_hook);
+    ram.set_read_hook(ACIA_BASE >> 8, acia_read_hook);
+    ram.set_write_hook(ACIA_BASE >> 8, acia_write_hook);
+    ram.set_write_hook(BLITTER_BASE >> 8, blitter_write_hook);
+    cpu.ram_read = &HookedRam::static_read;
+    cpu.ram_write = &HookedRam::static_write;
+
+    ram.load(program_load_addr, program, program_size);
+#ifdef PROGRAM_HAS_SINE_TABLE
+    ram.load(sine_table_addr, sine_table, sizeof(sine_table));
+#endif
+    ram[VIDEO_REG_BASE] = PROGRAM_VIDEO_MODE;
+    ram[VIDEO_REG_BASE + VIDEO_REG_FPS] = PROGRAM_FRAME_RATE;
+    ram[BLITTER_BASE + BLIT_COST] = PROGRAM_BLITTER_COST;
+    next_vblank_cycle = PROGRAM_CLK_FREQ_KHZ * 1000ull / PROGRAM_FRAME_RATE;
+    ram[0xFFFC] = program_load_addr & 0xFF;
+    ram[0xFFFD] = (program_load_addr >> 8) & 0xFF;
+
+    cpu.reset();
+    cpu.reg.pc = ram.read_word(0xFFFC);
+
+    // Same slice boundaries as the firmware, so IRQ line events land on the same cycles
+    Rewinder<PROGRAM_CPU> rewinder(cpu, ram.data(), &io_log, &prng);
+    if (back_steps || gdb_port) {
+        rewinder.set_step_hook(slice_hook);
+        rewinder.start();
+    }
+
+    if (gdb_port) {
+        if (!gdb_accept(gdb_port)) {
+            printf("cannot listen on port %d\n", gdb_port);
+            return 1;
+        }
+        GdbStub<PROGRAM_CPU> gdb(cpu, ram.data(), gdb_read_char, gdb_write);
+        gdb.attach_rewinder(&rewinder);
+        while (!gdb_closed) {
+            uint64_t before = cpu.cycles;
+            if (!gdb.active()) {
+                rewinder.step();
+            } else if (gdb.step() == 0) {
+                usleep(1000);  // stopped: wait for the next packet
+            }
+            if (before / SLICE_CYCLES != cpu.cycles / SLICE_CYCLES) gdb.poll();
+            if (cpu.halted) gdb.report_halt();
+        }
+        close(gdb_fd);
+        printf("gdb: disconnected at $%04X after %llu cycles, ram %08lx\n", cpu.reg.pc,
+               (unsigned long long)cpu.cycles, (unsigned long)io_log_ram_hash(ram.data(), 0x10000));
+        return 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (!cpu.halted) {
+        uint64_t before = cpu.cycles;
+        if (back_steps) {
+            rewinder.step();
+        } else {
+            cpu.step();
+            slice_hook(before);
+        }
+        if (before / SLICE_CYCLES != cpu.cycles / SLICE_CYCLES && cpu.cycles >= max_cycles) break;
+    }
+    uint64_t us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    printf("%s: %llu cycles in %llu us, ram %08lx, %s\n",
+           replay_path ? "replay" : "record",
+           (unsigned long long)cpu.cycles, (unsigned long long)us,
+           (unsigned long)io_log_ram_hash(ram.data(), 0x10000),
+           replay_path ? (io_log.diverged() ? "diverged" : "matched")
+                       : (io_log.overflowed() ? "overflowed" : "recorded"));
+    if (us) printf("%.2f MHz emulated\n", (double)cpu.cycles / (double)us);
+    if (io_log.diverged()) {
+        printf("replay diverged at cycle %llu\n", (unsigned long long)io_log.diverged_cycle());
+    }
+
+    if (back_steps) {
+        uint64_t end = rewinder.position();
+        uint32_t hash = io_log_ram_hash(ram.data(), 0x10000);
+        auto t0 = std::chrono::steady_clock::now();
+        bool back = rewinder.step_back(back_steps);
+        auto t1 = std::chrono::steady_clock::now();
+        bool fwd = rewinder.seek(end);
+        auto t2 = std::chrono::steady_clock::now();
+        printf("rewind: back %llu steps %s in %.2f ms, forward in %.2f ms, %zu snapshots (%zu KB), ram %s\n",
+               (unsigned long long)back_steps, back ? "ok" : "out of reach",
+               std::chrono::duration<double, std::milli>(t1 - t0).count(),
+               std::chrono::duration<double, std::milli>(t2 - t1).count(),
+               rewinder.snapshot_count(), rewinder.memory_bytes() / 1024,
+               fwd && io_log_ram_hash(ram.data(), 0x10000) == hash ? "identical" : "DIFFERENT");
+    }
+
+    size_t count = replay_path ? words.size() : io_log.size();
+    if (record_path) {
+        FILE* f = fopen(record_path, "w");
+        if (!f) {
+            printf("cannot write %s\n", record_path);
+            return 1;
+        }
+        write_log(f, seed, words.data(), count, cpu.cycles);
+        fclose(f);
+    }
+    if (header_path && !write_header(header_path, seed, words.data(), count, cpu.cycles)) {
+        printf("cannot write %s\n", header_path);
+        return 1;
+    }
+    return io_log.diverged() ? 1 : 0;
+}
@@ -0,0 +1,187 @@
+//
+// Execution trace decoder
+//
+// Copyright 2026, John Clark
+//
+// Turns a TRACE BEGIN/END dump captured from the serial console into a
+// disassembly listing. Other console output around the dump is ignored.
+// Operand bytes are shown when the program image is supplied; without it the
+// listing has the mnemonic and addressing mode only.
+//
+// Usage: trace_decode [--variant <6502|65c02|r65c02|w65c02s>]
+//                     [--image <file.bin> <load_addr>] <console.log>
+//
+
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "w65c02s.hpp"
+#include "trace.hpp"
+
+struct Image {
+    std::vector<uint8_t> mem;   // 64K, valid where loaded[] is set
+    std::vector<bool> loaded;
+};
+
+// Mnemonic for every opcode of a variant, matched through the handler in its opcode table
+template<typename Cpu>
+static std::array<const char*, 256> mnemonic_table(const Cpu& cpu) {
+    std::array<const char*, 256> names{};
+    auto match = [&](const auto& table) {
+        for (int op = 0; op < 256; op++) {
+            for (const auto& instr : table) {
+                if (cpu.opcode_entry(op).handler == instr.handler) names[op] = instr.mnemonic;
+            }
+        }
+    };
+
+    if constexpr (!Cpu::Variant::cmos) {
+        match(MOS6502_ISA_TABLE<Cpu>);
+        match(MOS6502_UNDOC_ISA_TABLE<Cpu>);
+    } else {
+        match(W65C02_ISA_TABLE<Cpu>);
+        if constexpr (Cpu::Variant::bit_ops) match(R65C02_BIT_ISA_TABLE<Cpu>);
+        if constexpr (Cpu::Variant::wai_stp) match(W65C02S_WDC_ISA_TABLE<Cpu>);
+    }
+
+    for (int op = 0; op < 256; op++) {
+        auto handler = cpu.opcode_entry(op).handler;
+        if (handler == &Cpu::op_nop || handler == &Cpu::op_nop_read) names[op] = "nop";
+        if constexpr (!Cpu::Variant::cmos) {
+            if (handler == &Cpu::op_jam) names[op] = "jam";
+        }
+        if (!names[op]) names[op] = "???";
+    }
+    return names;
+}
+
+static const char* const reg_names[] = {"", "A", "X", "Y", "SP", "A", "X", "Y"};
+
+template<typename Cpu>
+static int print_listing(const std::vector<uint32_t>& records, const Image& image) {
+    static Cpu cpu;
+    auto names = mnemonic_table(cpu);
+    auto steps = trace_decode(records, [](uint8_t op) { return cpu.opcode_entry(op).mode.bytes; });
+
+    for (const TraceStep& s : steps) {
+        switch (s.kind) {
+            case TraceStep::START: printf("---- start at $%04X\n", s.pc); continue;
+            case TraceStep::IRQ:   printf("---- IRQ -> $%04X\n", s.pc); continue;
+            case TraceStep::NMI:   printf("---- NMI -> $%04X\n", s.pc); continue;
+            default: break;
+        }
+
+        const auto& mode = cpu.opcode_entry(s.opcode).mode;
+        char bytes[16];
+        int pos = snprintf(bytes, sizeof(bytes), "%02x", s.opcode);
+        for (int i = 1; i < mode.bytes; i++) {
+            uint16_t addr = s.pc + i;
+            if (image.loaded[addr]) {
+                pos += snprintf(bytes + pos, sizeof(bytes) - pos, " %02x", image.mem[addr]);
+            } else {
+                pos += snprintf(bytes + pos, sizeof(bytes) - pos, " ..");
+            }
+        }
+
+        char flags[5] = {
+            (char)(s.nvzc & 0x08 ? 'N' : 'n'), (char)(s.nvzc & 0x04 ? 'V' : 'v'),
+            (char)(s.nvzc & 0x02 ? 'Z' : 'z'), (char)(s.nvzc & 0x01 ? 'C' : 'c'), 0
+        };
+
+        printf("$%04X  %-9s %-4s %-22s %s", s.pc, bytes, names[s.opcode], mode.name, flags);
+        if (s.reg) printf("  %s=%02X", reg_names[s.reg], s.value);
+        if (s.reg >= TRACE_REG_PULL_A) printf("  SP=%02X", s.sp);
+        printf("\n");
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* variant = nullptr;
+    const char* log_path = nullptr;
+    Image image{std::vector<uint8_t>(0x10000), std::vector<bool>(0x10000)};
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--variant") && i + 1 < argc) {
+            variant = argv[++i];
+        } else if (!strcmp(argv[i], "--image") && i + 2 < argc) {
+            const char* path = argv[++i];
+            uint16_t load = static_cast<uint16_t>(strtoul(argv[++i], nullptr, 16));
+            FILE* f = fopen(path, "rb");
+            if (!f) {
+                printf("cannot open %s\n", path);
+                return 1;
+            }
+            int c;
+            for (uint32_t addr = load; addr < 0x10000 && (c = fgetc(f)) != EOF; addr++) {
+                image.mem[addr] = static_cast<uint8_t>(c);
+                image.loaded[addr] = true;
+            }
+            fclose(f);
+        } else {
+            log_path = argv[i];
+        }
+    }
+
+    if (!log_path) {
+        printf("usage: trace_decode [--variant <6502|65c02|r65c02|w65c02s>] [--image <file.bin> <load_addr>] <console.log>\n");
+        return 2;
+    }
+
+    FILE* f = fopen(log_path, "r");
+    if (!f) {
+        printf("cannot open %s\n", log_path);
+        return 1;
+    }
+
+    // Collect the records of the last dump in the log
+    std::vector<uint32_t> records;
+    std::string dump_variant;
+    bool in_dump = false;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        if (!strncmp(line, "TRACE BEGIN", 11)) {
+            char name[32] = {};
+            sscanf(line + 11, "%31s", name);
+            dump_variant = name;
+            records.clear();
+            in_dump = true;
+            continue;
+        }
+        if (!strncmp(line, "TRACE END", 9)) {
+            in_dump = false;
+            continue;
+        }
+        if (!in_dump) continue;
+
+        char* p = line;
+        char* end;
+        for (unsigned long v = strtoul(p, &end, 16); end != p; v = strtoul(p, &end, 16)) {
+            records.push_back(static_cast<uint32_t>(v));
+            p = end;
+        }
+    }
+    fclose(f);
+
+    if (records.empty()) {
+        printf("no trace dump found in %s\n", log_path);
+        return 1;
+    }
+
+    // The dump header names the variant (Variant::name); --variant overrides it
+    std::string v = variant ? variant : dump_variant;
+    for (auto& ch : v) ch = static_cast<char>(tolower(ch));
+    printf("%zu records, %s\n", records.size(), v.c_str());
+
+    if (v == "6502") return print_listing<NMOS6502>(records, image);
+    if (v == "65c02") return print_listing<C65C02>(records, image);
+    if (v == "r65c02") return print_listing<R65C02>(records, image);
+    if (v == "w65c02s") return print_listing<W65C02S>(records, image);
+
+    printf("unknown variant: %s\n", v.c_str());
+    return 2;
+}
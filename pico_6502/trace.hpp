@@ -0,0 +1,166 @@
+//
+//  Compact execution trace for the W65C02S emulator
+//
+//  Copyright 2026, John Clark
+//
+//  Released under the GNU General Public License
+//  https://www.gnu.org/licenses/gpl.html
+//
+//  The CPU appends one 32-bit record per instruction to a fixed ring when a
+//  TraceBuffer is attached. PCs are delta-encoded: sequential code and short
+//  branches fit in the record, and only far jumps, calls, returns and
+//  interrupts add a second record with the absolute PC. A PC record is also
+//  written every TRACE_KEYFRAME_INTERVAL instructions so a wrapped ring can be
+//  decoded from any point.
+//
+//  Instruction record (bit 31 = 0)
+//    [7:0]    opcode
+//    [15:8]   flow: signed next_pc - (pc + instruction length), 0 if a PC record follows
+//    [23:16]  new value of the register the instruction writes
+//    [26:24]  which register: 0 none, 1 A, 2 X, 3 Y, 4 SP, or 5-7 A, X, Y
+//             pulled from the stack (SP went up by one)
+//    [30:27]  N V Z C after the instruction
+//
+//  PC record (bit 31 = 1)
+//    [15:0]   address of the next instruction
+//    [23:16]  SP
+//    [26:24]  reason: jump, keyframe, IRQ, NMI or start
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define TRACE_KEYFRAME_INTERVAL 256
+
+enum TraceReg : uint8_t {
+    TRACE_REG_NONE = 0, TRACE_REG_A, TRACE_REG_X, TRACE_REG_Y, TRACE_REG_SP,
+    TRACE_REG_PULL_A, TRACE_REG_PULL_X, TRACE_REG_PULL_Y,
+};
+
+enum TracePcReason : uint8_t { TRACE_PC_JUMP = 0, TRACE_PC_KEYFRAME, TRACE_PC_IRQ, TRACE_PC_NMI, TRACE_PC_START };
+
+// ============================================================================
+//  TraceBuffer - recorder over a caller-provided power-of-two ring
+// ============================================================================
+
+class TraceBuffer {
+public:
+    static constexpr uint32_t PC_RECORD = 0x80000000u;
+
+    // storage must hold a power-of-two number of records
+    TraceBuffer(uint32_t* storage, uint32_t records)
+        : buf_(storage), mask_(records - 1) {}
+
+    // Restart the trace at pc (drops everything recorded so far)
+    void start(uint16_t pc, uint8_t sp) {
+        head_ = 0;
+        wrapped_ = false;
+        since_keyframe_ = 0;
+        put_pc(pc_record(pc, sp, TRACE_PC_START));
+    }
+
+    // One executed instruction; which (TraceReg) is the register it wrote and
+    // value that register afterwards
+    inline void instruction(uint16_t pc, uint8_t opcode, uint8_t length, uint16_t next_pc,
+                            uint32_t which, uint8_t value, uint8_t p, uint8_t sp) {
+        int32_t flow = (int16_t)(uint16_t)(next_pc - pc - length);
+        bool far = flow < -127 || flow > 127;
+
+        uint32_t nvzc = ((p >> 4) & 0x0c) | (p & 0x03);  // N V - - - - Z C -> N V Z C
+        put(opcode | ((uint32_t)(uint8_t)(far ? 0 : flow) << 8) | ((uint32_t)value << 16) | (which << 24) | (nvzc << 27));
+
+        if (far) {
+            put_pc(pc_record(next_pc, sp, TRACE_PC_JUMP));
+        } else if (++since_keyframe_ >= TRACE_KEYFRAME_INTERVAL) {
+            put_pc(pc_record(next_pc, sp, TRACE_PC_KEYFRAME));
+        }
+    }
+
+    // Interrupt taken: execution continues at the vector target
+    void interrupt(uint16_t vector_pc, uint8_t sp, bool nmi) {
+        put_pc(pc_record(vector_pc, sp, nmi ? TRACE_PC_NMI : TRACE_PC_IRQ));
+    }
+
+    // Records currently held, oldest first
+    size_t size() const { return wrapped_ ? mask_ + 1 : head_; }
+    size_t capacity() const { return mask_ + 1; }
+    uint32_t at(size_t i) const {
+        uint32_t first = wrapped_ ? head_ : 0;
+        return buf_[(first + i) & mask_];
+    }
+
+    static uint32_t pc_record(uint16_t pc, uint8_t sp, TracePcReason reason) {
+        return PC_RECORD | pc | ((uint32_t)sp << 16) | ((uint32_t)reason << 24);
+    }
+
+private:
+    inline void put(uint32_t rec) {
+        uint32_t head = head_;
+        buf_[head] = rec;
+        head_ = head = (head + 1) & mask_;
+        if (head == 0) wrapped_ = true;
+    }
+
+    inline void put_pc(uint32_t rec) {
+        put(rec);
+        since_keyframe_ = 0;
+    }
+
+    uint32_t* buf_;
+    uint32_t mask_;
+    uint32_t head_{};          // next slot to write
+    bool wrapped_{};
+    uint32_t since_keyframe_{};
+};
+
+// ============================================================================
+//  Decoding (host tools and tests)
+// ============================================================================
+
+struct TraceStep {
+    enum Kind : uint8_t { INSTRUCTION, IRQ, NMI, START } kind;
+    uint16_t pc;        // instruction address, or target for IRQ/NMI/START
+    uint8_t opcode;
+    uint8_t reg;        // TraceReg
+    uint8_t value;
+    uint8_t nvzc;
+    uint8_t sp;         // stack pointer afterwards
+};
+
+// Rebuild the instruction stream; length_of(opcode) gives the instruction
+// length for the traced CPU variant. Records before the first PC record are
+// skipped since their addresses are unknown.
+template<typename LengthFn>
+std::vector<TraceStep> trace_decode(const std::vector<uint32_t>& records, LengthFn length_of) {
+    std::vector<TraceStep> steps;
+    bool synced = false;
+    uint16_t pc = 0;
+    uint8_t sp = 0;
+
+    for (uint32_t rec : records) {
+        if (rec & TraceBuffer::PC_RECORD) {
+            pc = rec & 0xffff;
+            sp = rec >> 16;
+            synced = true;
+            switch ((rec >> 24) & 0x07) {
+                case TRACE_PC_IRQ:   steps.push_back({TraceStep::IRQ, pc, 0, 0, 0, 0, sp}); break;
+                case TRACE_PC_NMI:   steps.push_back({TraceStep::NMI, pc, 0, 0, 0, 0, sp}); break;
+                case TRACE_PC_START: steps.push_back({TraceStep::START, pc, 0, 0, 0, 0, sp}); break;
+                default: break;
+            }
+            continue;
+        }
+        if (!synced) continue;
+
+        uint8_t opcode = rec & 0xff;
+        uint8_t reg = (rec >> 24) & 0x07, value = rec >> 16;
+        if (reg == TRACE_REG_SP) sp = value;
+        else if (reg >= TRACE_REG_PULL_A) sp++;
+        steps.push_back({TraceStep::INSTRUCTION, pc, opcode, reg, value, (uint8_t)((rec >> 27) & 0x0f), sp});
+        pc = pc + length_of(opcode) + (int8_t)(rec >> 8);
+    }
+    return steps;
+}
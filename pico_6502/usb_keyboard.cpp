@@ -4,17 +4,20 @@
 // Copyright 2026, John Clark
 //
 
+#include <atomic>
 #include "usb_keyboard.h"
+#include "spsc_ring.hpp"
 #include "tusb.h"
 #include "pico/stdlib.h"
 
-// Circular buffer for keyboard input
+// Keyboard input ring: USB host (producer) -> 6502 $FF reads (consumer)
 #define KB_BUFFER_SIZE 32
-static volatile uint8_t kb_buffer[KB_BUFFER_SIZE];
-static volatile uint8_t kb_head = 0;
-static volatile uint8_t kb_tail = 0;
+static SpscRing<uint8_t, KB_BUFFER_SIZE> kb_ring;
 static volatile uint8_t last_key = 0;
 
+// Latest unconsumed function key (1-12), kept out of the character stream
+static std::atomic<uint8_t> fkey_pending{0};
+
 // Key repeat configuration (in milliseconds)
 #define REPEAT_DELAY_MS   400   // Initial delay before repeat starts
 #define REPEAT_RATE_MS    50    // Interval between repeats
@@ -70,12 +73,9 @@ static const uint8_t hid_to_ascii_shift[128] = {
 // Track previously pressed keys to detect new key presses
 static uint8_t prev_keys[6] = {0};
 
-// Add character to input buffer
+// Add character to input buffer (dropped when full)
 static void kb_buffer_put(uint8_t ch) {
-    uint8_t next = (kb_head + 1) % KB_BUFFER_SIZE;
-    if (next != kb_tail) {  // Buffer not full
-        kb_buffer[kb_head] = ch;
-        kb_head = next;
+    if (kb_ring.push(ch)) {
         last_key = ch;
     }
 }
@@ -117,13 +117,12 @@ void usb_keyboard_task(void) {
 }
 
 bool usb_keyboard_available(void) {
-    return kb_head != kb_tail;
+    return !kb_ring.empty();
 }
 
 uint8_t usb_keyboard_getchar(void) {
-    if (kb_head == kb_tail) return 0;
-    uint8_t ch = kb_buffer[kb_tail];
-    kb_tail = (kb_tail + 1) % KB_BUFFER_SIZE;
+    uint8_t ch = 0;
+    kb_ring.pop(ch);
     return ch;
 }
 
@@ -132,10 +131,14 @@ uint8_t usb_keyboard_peek(void) {
 }
 
 void usb_keyboard_clear(void) {
-    kb_head = kb_tail = 0;
+    kb_ring.clear();
     last_key = 0;
 }
 
+uint8_t usb_keyboard_get_fkey(void) {
+    return fkey_pending.exchange(0, std::memory_order_acquire);
+}
+
 //--------------------------------------------------------------------
 // TinyUSB Callbacks
 //--------------------------------------------------------------------
@@ -195,6 +198,12 @@ void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t cons
 
             // Check if this is a new key press (not in previous report)
             if (!key_in_array(key, prev_keys, 6)) {
+                // Function keys are latched for the host, not typed
+                if (key >= HID_KEY_F1 && key <= HID_KEY_F12) {
+                    fkey_pending.store(key - HID_KEY_F1 + 1, std::memory_order_release);
+                    continue;
+                }
+
                 // Convert scan code to ASCII
                 uint8_t ch = 0;
                 if (key < 128) {
@@ -14,12 +14,16 @@
 extern "C" {
 #endif
 
-// Initialize USB host for keyboard input
+// Initialize USB host for keyboard input (USB IRQs are taken on the calling core)
 void usb_keyboard_init(void);
 
-// Poll USB host - must be called regularly from main loop
+// Poll USB host - must be called regularly on the core that ran usb_keyboard_init()
 void usb_keyboard_task(void);
 
+// The available/getchar/clear/fkey functions may be called from the other
+// core: the input buffer is a lock-free ring with the USB host as its only
+// producer and the 6502 as its only consumer
+
 // Check if a character is available in the input buffer
 bool usb_keyboard_available(void);
 
@@ -32,6 +36,10 @@ uint8_t usb_keyboard_peek(void);
 // Clear the keyboard input buffer
 void usb_keyboard_clear(void);
 
+// Get the most recent function key press, 1-12 for F1-F12 (0 if none)
+// Function keys are not passed to the input buffer; they control the host.
+uint8_t usb_keyboard_get_fkey(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,6 +1,10 @@
 //
 //  W65C02S processor implementation in C++
 //
+//  The core is a template over a cpu_variant policy (NMOS 6502, 65C02,
+//  Rockwell R65C02, WDC W65C02S) so the ISA and its quirks are fixed at
+//  compile time - see the aliases at the end of this file
+//
 //  Copyright 2018-2026, John Clark
 //
 //  Released under the GNU General Public License
@@ -15,35 +19,31 @@
 
 #include <cstdint>
 #include <array>
+#include <initializer_list>
+#include "trace.hpp"
+
+// Hot-path placement: firmware builds define W65C02S_CORE_IN_RAM to run the
+// step loop, handlers and addressing modes from SRAM instead of XIP flash
+#if W65C02S_CORE_IN_RAM
+#define W65C02S_HOT __attribute__((section(".time_critical.w65c02s")))
+#else
+#define W65C02S_HOT
+#endif
 
-class W65C02S;  // forward declaration
+template<typename Variant> class Cpu6502;  // forward declaration
 
 // ============================================================================
 //  W65C02S Instruction Set Definition
 // ============================================================================
 //
 #define __ (-1)
-#define W65C02S_ISA(X) \
+
+// 65C02 instructions common to all CMOS variants
+#define W65C02_ISA(X) \
     /*       abs ,absxi, absx, absy, absi, acum, imm , imp , rel ,zprel, stck,  zp , zpxi, zpx , zpy , zpi , zpiy, handler  */ \
     X(adc,   0x6d,  __ , 0x7d, 0x79,  __ ,  __ , 0x69,  __ ,  __ ,  __ ,  __ , 0x65, 0x61, 0x75,  __ , 0x72, 0x71, op_adc)  \
     X(and,   0x2d,  __ , 0x3d, 0x39,  __ ,  __ , 0x29,  __ ,  __ ,  __ ,  __ , 0x25, 0x21, 0x35,  __ , 0x32, 0x31, op_and)  \
     X(asl,   0x0e,  __ , 0x1e,  __ ,  __ , 0x0a,  __ ,  __ ,  __ ,  __ ,  __ , 0x06,  __ , 0x16,  __ ,  __ ,  __ , op_asl)  \
-    X(bbr0,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x0f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
-    X(bbr1,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x1f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
-    X(bbr2,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x2f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
-    X(bbr3,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x3f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
-    X(bbr4,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x4f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
-    X(bbr5,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x5f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
-    X(bbr6,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x6f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
-    X(bbr7,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x7f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
-    X(bbs0,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x8f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
-    X(bbs1,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x9f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
-    X(bbs2,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xaf,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
-    X(bbs3,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xbf,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
-    X(bbs4,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xcf,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
-    X(bbs5,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xdf,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
-    X(bbs6,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xef,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
-    X(bbs7,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xff,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
     X(bcc,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x90,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bcc)  \
     X(bcs,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xb0,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bcs)  \
     X(beq,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xf0,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_beq)  \
@@ -85,14 +85,6 @@ class W65C02S;  // forward declaration
     X(plp,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x28,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_plp)  \
     X(plx,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xfa,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_plx)  \
     X(ply,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x7a,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_ply)  \
-    X(rmb0,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x07,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
-    X(rmb1,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x17,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
-    X(rmb2,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x27,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
-    X(rmb3,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x37,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
-    X(rmb4,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x47,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
-    X(rmb5,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x57,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
-    X(rmb6,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x67,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
-    X(rmb7,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x77,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
     X(rol,   0x2e,  __ , 0x3e,  __ ,  __ , 0x2a,  __ ,  __ ,  __ ,  __ ,  __ , 0x26,  __ , 0x36,  __ ,  __ ,  __ , op_rol)  \
     X(ror,   0x6e,  __ , 0x7e,  __ ,  __ , 0x6a,  __ ,  __ ,  __ ,  __ ,  __ , 0x66,  __ , 0x76,  __ ,  __ ,  __ , op_ror)  \
     X(rti,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x40,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_rti)  \
@@ -101,6 +93,46 @@ class W65C02S;  // forward declaration
     X(sec,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x38,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_sec)  \
     X(sed,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xf8,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_sed)  \
     X(sei,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x78,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_sei)  \
+    X(sta,   0x8d,  __ , 0x9d, 0x99,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x85, 0x81, 0x95,  __ , 0x92, 0x91, op_sta)  \
+    X(stx,   0x8e,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x86,  __ ,  __ , 0x96,  __ ,  __ , op_stx)  \
+    X(sty,   0x8c,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x84,  __ , 0x94,  __ ,  __ ,  __ , op_sty)  \
+    X(stz,   0x9c,  __ , 0x9e,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x64,  __ , 0x74,  __ ,  __ ,  __ , op_stz)  \
+    X(tax,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xaa,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_tax)  \
+    X(tay,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xa8,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_tay)  \
+    X(trb,   0x1c,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x14,  __ ,  __ ,  __ ,  __ ,  __ , op_trb)  \
+    X(tsb,   0x0c,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x04,  __ ,  __ ,  __ ,  __ ,  __ , op_tsb)  \
+    X(tsx,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xba,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_tsx)  \
+    X(txa,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x8a,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_txa)  \
+    X(txs,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x9a,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_txs)  \
+    X(tya,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x98,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_tya)
+
+// Rockwell bit manipulation instructions (R65C02 and W65C02S)
+#define R65C02_BIT_ISA(X) \
+    /*       abs ,absxi, absx, absy, absi, acum, imm , imp , rel ,zprel, stck,  zp , zpxi, zpx , zpy , zpi , zpiy, handler  */ \
+    X(bbr0,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x0f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
+    X(bbr1,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x1f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
+    X(bbr2,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x2f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
+    X(bbr3,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x3f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
+    X(bbr4,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x4f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
+    X(bbr5,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x5f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
+    X(bbr6,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x6f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
+    X(bbr7,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x7f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbr)  \
+    X(bbs0,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x8f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
+    X(bbs1,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x9f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
+    X(bbs2,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xaf,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
+    X(bbs3,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xbf,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
+    X(bbs4,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xcf,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
+    X(bbs5,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xdf,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
+    X(bbs6,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xef,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
+    X(bbs7,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xff,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bbs)  \
+    X(rmb0,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x07,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
+    X(rmb1,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x17,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
+    X(rmb2,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x27,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
+    X(rmb3,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x37,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
+    X(rmb4,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x47,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
+    X(rmb5,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x57,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
+    X(rmb6,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x67,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
+    X(rmb7,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x77,  __ ,  __ ,  __ ,  __ ,  __ , op_rmb)  \
     X(smb0,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x87,  __ ,  __ ,  __ ,  __ ,  __ , op_smb)  \
     X(smb1,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x97,  __ ,  __ ,  __ ,  __ ,  __ , op_smb)  \
     X(smb2,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xa7,  __ ,  __ ,  __ ,  __ ,  __ , op_smb)  \
@@ -108,31 +140,153 @@ class W65C02S;  // forward declaration
     X(smb4,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xc7,  __ ,  __ ,  __ ,  __ ,  __ , op_smb)  \
     X(smb5,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xd7,  __ ,  __ ,  __ ,  __ ,  __ , op_smb)  \
     X(smb6,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xe7,  __ ,  __ ,  __ ,  __ ,  __ , op_smb)  \
-    X(smb7,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xf7,  __ ,  __ ,  __ ,  __ ,  __ , op_smb)  \
-    X(sta,   0x8d,  __ , 0x9d, 0x99,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x85, 0x81, 0x95,  __ , 0x92, 0x91, op_sta)  \
+    X(smb7,   __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xf7,  __ ,  __ ,  __ ,  __ ,  __ , op_smb)
+
+// WDC low-power instructions (W65C02S only)
+#define W65C02S_WDC_ISA(X) \
+    /*       abs ,absxi, absx, absy, absi, acum, imm , imp , rel ,zprel, stck,  zp , zpxi, zpx , zpy , zpi , zpiy, handler  */ \
     X(stp,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xdb,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_stp)  \
+    X(wai,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xcb,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_wai)
+
+// Complete W65C02S instruction set
+#define W65C02S_ISA(X) W65C02_ISA(X) R65C02_BIT_ISA(X) W65C02S_WDC_ISA(X)
+
+// NMOS 6502 documented instructions
+#define MOS6502_ISA(X) \
+    /*       abs ,absxi, absx, absy, absi, acum, imm , imp , rel ,zprel, stck,  zp , zpxi, zpx , zpy , zpi , zpiy, handler  */ \
+    X(adc,   0x6d,  __ , 0x7d, 0x79,  __ ,  __ , 0x69,  __ ,  __ ,  __ ,  __ , 0x65, 0x61, 0x75,  __ ,  __ , 0x71, op_adc)  \
+    X(and,   0x2d,  __ , 0x3d, 0x39,  __ ,  __ , 0x29,  __ ,  __ ,  __ ,  __ , 0x25, 0x21, 0x35,  __ ,  __ , 0x31, op_and)  \
+    X(asl,   0x0e,  __ , 0x1e,  __ ,  __ , 0x0a,  __ ,  __ ,  __ ,  __ ,  __ , 0x06,  __ , 0x16,  __ ,  __ ,  __ , op_asl)  \
+    X(bcc,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x90,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bcc)  \
+    X(bcs,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xb0,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bcs)  \
+    X(beq,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xf0,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_beq)  \
+    X(bit,   0x2c,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x24,  __ ,  __ ,  __ ,  __ ,  __ , op_bit)  \
+    X(bmi,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x30,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bmi)  \
+    X(bne,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xd0,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bne)  \
+    X(bpl,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x10,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bpl)  \
+    X(brk,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x00,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_brk)  \
+    X(bvc,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x50,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bvc)  \
+    X(bvs,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x70,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_bvs)  \
+    X(clc,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x18,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_clc)  \
+    X(cld,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xd8,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_cld)  \
+    X(cli,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x58,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_cli)  \
+    X(clv,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xb8,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_clv)  \
+    X(cmp,   0xcd,  __ , 0xdd, 0xd9,  __ ,  __ , 0xc9,  __ ,  __ ,  __ ,  __ , 0xc5, 0xc1, 0xd5,  __ ,  __ , 0xd1, op_cmp)  \
+    X(cpx,   0xec,  __ ,  __ ,  __ ,  __ ,  __ , 0xe0,  __ ,  __ ,  __ ,  __ , 0xe4,  __ ,  __ ,  __ ,  __ ,  __ , op_cpx)  \
+    X(cpy,   0xcc,  __ ,  __ ,  __ ,  __ ,  __ , 0xc0,  __ ,  __ ,  __ ,  __ , 0xc4,  __ ,  __ ,  __ ,  __ ,  __ , op_cpy)  \
+    X(dec,   0xce,  __ , 0xde,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xc6,  __ , 0xd6,  __ ,  __ ,  __ , op_dec)  \
+    X(dex,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xca,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_dex)  \
+    X(dey,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x88,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_dey)  \
+    X(eor,   0x4d,  __ , 0x5d, 0x59,  __ ,  __ , 0x49,  __ ,  __ ,  __ ,  __ , 0x45, 0x41, 0x55,  __ ,  __ , 0x51, op_eor)  \
+    X(inc,   0xee,  __ , 0xfe,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xe6,  __ , 0xf6,  __ ,  __ ,  __ , op_inc)  \
+    X(inx,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xe8,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_inx)  \
+    X(iny,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xc8,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_iny)  \
+    X(jmp,   0x4c,  __ ,  __ ,  __ , 0x6c,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_jmp)  \
+    X(jsr,   0x20,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_jsr)  \
+    X(lda,   0xad,  __ , 0xbd, 0xb9,  __ ,  __ , 0xa9,  __ ,  __ ,  __ ,  __ , 0xa5, 0xa1, 0xb5,  __ ,  __ , 0xb1, op_lda)  \
+    X(ldx,   0xae,  __ ,  __ , 0xbe,  __ ,  __ , 0xa2,  __ ,  __ ,  __ ,  __ , 0xa6,  __ ,  __ , 0xb6,  __ ,  __ , op_ldx)  \
+    X(ldy,   0xac,  __ , 0xbc,  __ ,  __ ,  __ , 0xa0,  __ ,  __ ,  __ ,  __ , 0xa4,  __ , 0xb4,  __ ,  __ ,  __ , op_ldy)  \
+    X(lsr,   0x4e,  __ , 0x5e,  __ ,  __ , 0x4a,  __ ,  __ ,  __ ,  __ ,  __ , 0x46,  __ , 0x56,  __ ,  __ ,  __ , op_lsr)  \
+    X(nop,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xea,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_nop)  \
+    X(ora,   0x0d,  __ , 0x1d, 0x19,  __ ,  __ , 0x09,  __ ,  __ ,  __ ,  __ , 0x05, 0x01, 0x15,  __ ,  __ , 0x11, op_ora)  \
+    X(pha,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x48,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_pha)  \
+    X(php,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x08,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_php)  \
+    X(pla,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x68,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_pla)  \
+    X(plp,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x28,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_plp)  \
+    X(rol,   0x2e,  __ , 0x3e,  __ ,  __ , 0x2a,  __ ,  __ ,  __ ,  __ ,  __ , 0x26,  __ , 0x36,  __ ,  __ ,  __ , op_rol)  \
+    X(ror,   0x6e,  __ , 0x7e,  __ ,  __ , 0x6a,  __ ,  __ ,  __ ,  __ ,  __ , 0x66,  __ , 0x76,  __ ,  __ ,  __ , op_ror)  \
+    X(rti,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x40,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_rti)  \
+    X(rts,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x60,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_rts)  \
+    X(sbc,   0xed,  __ , 0xfd, 0xf9,  __ ,  __ , 0xe9,  __ ,  __ ,  __ ,  __ , 0xe5, 0xe1, 0xf5,  __ ,  __ , 0xf1, op_sbc)  \
+    X(sec,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x38,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_sec)  \
+    X(sed,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xf8,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_sed)  \
+    X(sei,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x78,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_sei)  \
+    X(sta,   0x8d,  __ , 0x9d, 0x99,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x85, 0x81, 0x95,  __ ,  __ , 0x91, op_sta)  \
     X(stx,   0x8e,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x86,  __ ,  __ , 0x96,  __ ,  __ , op_stx)  \
     X(sty,   0x8c,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x84,  __ , 0x94,  __ ,  __ ,  __ , op_sty)  \
-    X(stz,   0x9c,  __ , 0x9e,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x64,  __ , 0x74,  __ ,  __ ,  __ , op_stz)  \
     X(tax,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xaa,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_tax)  \
     X(tay,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xa8,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_tay)  \
-    X(trb,   0x1c,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x14,  __ ,  __ ,  __ ,  __ ,  __ , op_trb)  \
-    X(tsb,   0x0c,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x04,  __ ,  __ ,  __ ,  __ ,  __ , op_tsb)  \
     X(tsx,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xba,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_tsx)  \
     X(txa,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x8a,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_txa)  \
     X(txs,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x9a,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_txs)  \
-    X(tya,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x98,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_tya)  \
-    X(wai,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xcb,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_wai)
+    X(tya,    __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x98,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_tya)
+
+// NMOS 6502 undocumented instructions (NOP and JAM opcodes are filled in by build_opcode_table)
+#define MOS6502_UNDOC_ISA(X) \
+    /*       abs ,absxi, absx, absy, absi, acum, imm , imp , rel ,zprel, stck,  zp , zpxi, zpx , zpy , zpi , zpiy, handler  */ \
+    X(ahx,    __ ,  __ ,  __ , 0x9f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x93, op_ahx)  \
+    X(alr,    __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x4b,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_alr)  \
+    X(anc,    __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x0b,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_anc)  \
+    X(anc,    __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x2b,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_anc)  \
+    X(arr,    __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x6b,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_arr)  \
+    X(dcp,   0xcf,  __ , 0xdf, 0xdb,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xc7, 0xc3, 0xd7,  __ ,  __ , 0xd3, op_dcp)  \
+    X(isc,   0xef,  __ , 0xff, 0xfb,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xe7, 0xe3, 0xf7,  __ ,  __ , 0xf3, op_isc)  \
+    X(las,    __ ,  __ ,  __ , 0xbb,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_las)  \
+    X(lax,   0xaf,  __ ,  __ , 0xbf,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xa7, 0xa3,  __ , 0xb7,  __ , 0xb3, op_lax)  \
+    X(lxa,    __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xab,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_lxa)  \
+    X(rla,   0x2f,  __ , 0x3f, 0x3b,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x27, 0x23, 0x37,  __ ,  __ , 0x33, op_rla)  \
+    X(rra,   0x6f,  __ , 0x7f, 0x7b,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x67, 0x63, 0x77,  __ ,  __ , 0x73, op_rra)  \
+    X(sax,   0x8f,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x87, 0x83,  __ , 0x97,  __ ,  __ , op_sax)  \
+    X(sbc,    __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xeb,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_sbc)  \
+    X(sbx,    __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0xcb,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_sbx)  \
+    X(shx,    __ ,  __ ,  __ , 0x9e,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_shx)  \
+    X(shy,    __ ,  __ , 0x9c,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_shy)  \
+    X(slo,   0x0f,  __ , 0x1f, 0x1b,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x07, 0x03, 0x17,  __ ,  __ , 0x13, op_slo)  \
+    X(sre,   0x4f,  __ , 0x5f, 0x5b,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x47, 0x43, 0x57,  __ ,  __ , 0x53, op_sre)  \
+    X(tas,    __ ,  __ ,  __ , 0x9b,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_tas)  \
+    X(xaa,    __ ,  __ ,  __ ,  __ ,  __ ,  __ , 0x8b,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ ,  __ , op_xaa)
 
 // ============================================================================
-//  AddressMode - represents a 65C02 addressing mode
+//  CPU variants - compile-time policies selecting the ISA and NMOS/CMOS quirks
 // ============================================================================
 
+namespace cpu_variant {
+
+// NMOS 6502: stable undocumented opcodes, JMP ($xxFF) page wrap bug,
+// N/V/Z from the binary result in decimal mode, D left alone on interrupts
+struct MOS6502 {
+    static constexpr const char* name = "6502";
+    static constexpr bool cmos    = false;
+    static constexpr bool bit_ops = false;  // RMB/SMB/BBR/BBS
+    static constexpr bool wai_stp = false;  // WAI/STP
+};
+
+// Original CMOS 65C02: undefined opcodes are NOPs, no bit instructions
+struct Cmos65C02 {
+    static constexpr const char* name = "65C02";
+    static constexpr bool cmos    = true;
+    static constexpr bool bit_ops = false;
+    static constexpr bool wai_stp = false;
+};
+
+// Rockwell R65C02: adds RMB/SMB/BBR/BBS
+struct R65C02 {
+    static constexpr const char* name = "R65C02";
+    static constexpr bool cmos    = true;
+    static constexpr bool bit_ops = true;
+    static constexpr bool wai_stp = false;
+};
+
+// WDC W65C02S: Rockwell set plus WAI/STP
+struct W65C02S {
+    static constexpr const char* name = "W65C02S";
+    static constexpr bool cmos    = true;
+    static constexpr bool bit_ops = true;
+    static constexpr bool wai_stp = true;
+};
+
+} // namespace cpu_variant
+
+// ============================================================================
+//  AddressMode - represents a 6502 addressing mode
+// ============================================================================
+
+template<typename Cpu>
 class AddressMode {
 public:
-    using GetFn     = uint8_t  (*)(W65C02S&, AddressMode&);
-    using WriteFn   = void     (*)(W65C02S&, AddressMode&, uint8_t);
-    using ResolveFn = uint16_t (*)(W65C02S&, AddressMode&);
+    using GetFn     = uint8_t  (*)(Cpu&, AddressMode&);
+    using WriteFn   = void     (*)(Cpu&, AddressMode&, uint8_t);
+    using ResolveFn = uint16_t (*)(Cpu&, AddressMode&);
 
     const char* name{};
     GetFn       get{};          // fetch operand + read value
@@ -142,15 +296,18 @@ public:
     uint8_t     cycles{};       // base cycle count
     uint8_t     write_extra{};  // additional cycles for write operations
     uint8_t     branch_extra{}; // additional cycles when branch taken
+    uint8_t     index_extra{};  // indexing cycle always taken by stores (and NMOS read-modify-write)
 
     uint16_t eff_addr{};
     uint8_t  page_penalty{};
 
     constexpr AddressMode() = default;
     constexpr AddressMode(const char* name, GetFn get, WriteFn write, ResolveFn resolve,
-                          uint8_t bytes, uint8_t cycles, uint8_t write_extra = 0, uint8_t branch_extra = 0)
+                          uint8_t bytes, uint8_t cycles, uint8_t write_extra = 0, uint8_t branch_extra = 0,
+                          uint8_t index_extra = 0)
         : name(name), get(get), write(write), resolve(resolve),
-          bytes(bytes), cycles(cycles), write_extra(write_extra), branch_extra(branch_extra) {}
+          bytes(bytes), cycles(cycles), write_extra(write_extra), branch_extra(branch_extra),
+          index_extra(index_extra) {}
 };
 
 // ============================================================================
@@ -228,15 +385,23 @@ struct Register6502 {
 };
 
 // ============================================================================
-//  W65C02S - the processor
+//  Cpu6502 - the processor, specialized at compile time by a cpu_variant policy
 // ============================================================================
 
-class W65C02S {
+template<typename VariantT>
+class Cpu6502 {
 public:
-    // Opcode entry - pairs an addressing mode with an instruction
+    using Variant = VariantT;
+    using AddressMode = ::AddressMode<Cpu6502>;
+
+    // Opcode entry - pairs an addressing mode with an instruction, and names
+    // the register the instruction writes for the execution trace (TraceReg,
+    // and the member it is read from)
     struct OpcodeEntry {
         AddressMode mode;
-        uint8_t (W65C02S::*handler)(AddressMode&, uint8_t opcode);
+        uint8_t (Cpu6502::*handler)(AddressMode&, uint8_t opcode);
+        uint8_t trace_reg{};
+        uint8_t Register6502::*trace_src{&Register6502::a};
     };
 
     Register6502 reg{};
@@ -252,22 +417,25 @@ public:
     uint8_t (*ram_read)(uint16_t addr) = nullptr;
     void (*ram_write)(uint16_t addr, uint8_t val) = nullptr;
 
-    W65C02S() { build_opcode_table(); }
+    // Execution trace - records every instruction while attached (see trace.hpp)
+    TraceBuffer* trace = nullptr;
+
+    Cpu6502() { build_opcode_table(); }
 
     // Convenience for reading 16-bit values (little-endian)
-    uint16_t ram_read_word(uint16_t addr) {
+    W65C02S_HOT uint16_t ram_read_word(uint16_t addr) {
         return ram_read(addr) | (ram_read(addr + 1) << 8);
     }
 
     // Fetch bytes from PC
-    uint8_t pop_byte_pc() { return ram_read(reg.pc++); }
-    uint16_t pop_word_pc() { return pop_byte_pc() | (pop_byte_pc() << 8); }
+    W65C02S_HOT uint8_t pop_byte_pc() { return ram_read(reg.pc++); }
+    W65C02S_HOT uint16_t pop_word_pc() { return pop_byte_pc() | (pop_byte_pc() << 8); }
 
     // Stack operations
-    void stack_push(uint8_t val) { ram_write(0x0100 | reg.sp--, val); }
-    void stack_push_word(uint16_t val) { stack_push(val >> 8); stack_push(val & 0xff); }
-    uint8_t stack_pull() { return ram_read(0x0100 | ++reg.sp); }
-    uint16_t stack_pull_word() { return stack_pull() | (stack_pull() << 8); }
+    W65C02S_HOT void stack_push(uint8_t val) { ram_write(0x0100 | reg.sp--, val); }
+    W65C02S_HOT void stack_push_word(uint16_t val) { stack_push(val >> 8); stack_push(val & 0xff); }
+    W65C02S_HOT uint8_t stack_pull() { return ram_read(0x0100 | ++reg.sp); }
+    W65C02S_HOT uint16_t stack_pull_word() { return stack_pull() | (stack_pull() << 8); }
 
     void reset() {
         reg.reset();
@@ -284,7 +452,7 @@ public:
     void clear_irq() { irq_pending = false; }
 
     // Execute one instruction, returns cycle count
-    int step() {
+    W65C02S_HOT int step() {
         // Halted by STP - only reset can recover
         if (halted) {
             cycles += 1;
@@ -298,8 +466,9 @@ public:
             stack_push_word(reg.pc);
             stack_push(reg.flag.value());  // NMI/IRQ push with B=0
             reg.flag.set_i(true);
-            reg.flag.set_d(false);  // 65C02 clears D on interrupt
+            if constexpr (Variant::cmos) reg.flag.set_d(false);  // 65C02 clears D on interrupt
             reg.pc = ram_read_word(0xfffa);
+            if (trace) trace->interrupt(reg.pc, reg.sp, true);
             cycles += 7;
             return 7;
         }
@@ -310,8 +479,9 @@ public:
             stack_push_word(reg.pc);
             stack_push(reg.flag.value());  // B=0 for IRQ
             reg.flag.set_i(true);
-            reg.flag.set_d(false);  // 65C02 clears D on interrupt
+            if constexpr (Variant::cmos) reg.flag.set_d(false);  // 65C02 clears D on interrupt
             reg.pc = ram_read_word(0xfffe);
+            if (trace) trace->interrupt(reg.pc, reg.sp, false);
             cycles += 7;
             return 7;
         }
@@ -323,6 +493,7 @@ public:
         }
 
         // Normal instruction execution
+        uint16_t pc = reg.pc;
         uint8_t opcode = ram_read(reg.pc++);
         auto& entry = op_[opcode];
         if (!entry.handler) {
@@ -330,14 +501,28 @@ public:
             cycles += 1;
             return 1;
         }
+        if (trace) return step_traced(entry, pc, opcode);
         int cyc = (this->*entry.handler)(entry.mode, opcode);
         cycles += cyc;
         return cyc;
     }
 
+    // Opcode table entry (addressing mode and handler) for disassembly and tools
+    const OpcodeEntry& opcode_entry(uint8_t opcode) const { return op_[opcode]; }
+
 private:
     std::array<OpcodeEntry, 256> op_{};
 
+    // Execute with the trace attached, recording the register the opcode table
+    // says the instruction writes
+    W65C02S_HOT int step_traced(OpcodeEntry& entry, uint16_t pc, uint8_t opcode) {
+        int cyc = (this->*entry.handler)(entry.mode, opcode);
+        cycles += cyc;
+        trace->instruction(pc, opcode, entry.mode.bytes, reg.pc, entry.trace_reg, reg.*entry.trace_src,
+                           reg.flag.value(), reg.sp);
+        return cyc;
+    }
+
 public:
     // ========================================================================
     //  Instruction implementations (public for ISA table access)
@@ -348,43 +533,43 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // CLC   0 -> c                               - - - - - - 0
-    uint8_t op_clc(AddressMode& m, uint8_t) { reg.flag.set_c(false); return m.cycles; }
+    W65C02S_HOT uint8_t op_clc(AddressMode& m, uint8_t) { reg.flag.set_c(false); return m.cycles; }
     // CLD   0 -> d                               - - - 0 - - -
-    uint8_t op_cld(AddressMode& m, uint8_t) { reg.flag.set_d(false); return m.cycles; }
+    W65C02S_HOT uint8_t op_cld(AddressMode& m, uint8_t) { reg.flag.set_d(false); return m.cycles; }
     // CLI   0 -> i                               - - - - 0 - -
-    uint8_t op_cli(AddressMode& m, uint8_t) { reg.flag.set_i(false); return m.cycles; }
+    W65C02S_HOT uint8_t op_cli(AddressMode& m, uint8_t) { reg.flag.set_i(false); return m.cycles; }
     // CLV   0 -> v                               - 0 - - - - -
-    uint8_t op_clv(AddressMode& m, uint8_t) { reg.flag.set_v(false); return m.cycles; }
+    W65C02S_HOT uint8_t op_clv(AddressMode& m, uint8_t) { reg.flag.set_v(false); return m.cycles; }
     // SEC   1 -> c                               - - - - - - 1
-    uint8_t op_sec(AddressMode& m, uint8_t) { reg.flag.set_c(true);  return m.cycles; }
+    W65C02S_HOT uint8_t op_sec(AddressMode& m, uint8_t) { reg.flag.set_c(true);  return m.cycles; }
     // SED   1 -> d                               - - - 1 - - -
-    uint8_t op_sed(AddressMode& m, uint8_t) { reg.flag.set_d(true);  return m.cycles; }
+    W65C02S_HOT uint8_t op_sed(AddressMode& m, uint8_t) { reg.flag.set_d(true);  return m.cycles; }
     // SEI   1 -> i                               - - - - 1 - -
-    uint8_t op_sei(AddressMode& m, uint8_t) { reg.flag.set_i(true);  return m.cycles; }
+    W65C02S_HOT uint8_t op_sei(AddressMode& m, uint8_t) { reg.flag.set_i(true);  return m.cycles; }
 
     // ------------------------------------------------------------------------
     //  Transfer operations
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // TAX   a -> x                               + - - - - + -
-    uint8_t op_tax(AddressMode& m, uint8_t) { reg.x = reg.a;  reg.flag.test_nz(reg.x); return m.cycles; }
+    W65C02S_HOT uint8_t op_tax(AddressMode& m, uint8_t) { reg.x = reg.a;  reg.flag.test_nz(reg.x); return m.cycles; }
     // TAY   a -> y                               + - - - - + -
-    uint8_t op_tay(AddressMode& m, uint8_t) { reg.y = reg.a;  reg.flag.test_nz(reg.y); return m.cycles; }
+    W65C02S_HOT uint8_t op_tay(AddressMode& m, uint8_t) { reg.y = reg.a;  reg.flag.test_nz(reg.y); return m.cycles; }
     // TXA   x -> a                               + - - - - + -
-    uint8_t op_txa(AddressMode& m, uint8_t) { reg.a = reg.x;  reg.flag.test_nz(reg.a); return m.cycles; }
+    W65C02S_HOT uint8_t op_txa(AddressMode& m, uint8_t) { reg.a = reg.x;  reg.flag.test_nz(reg.a); return m.cycles; }
     // TYA   y -> a                               + - - - - + -
-    uint8_t op_tya(AddressMode& m, uint8_t) { reg.a = reg.y;  reg.flag.test_nz(reg.a); return m.cycles; }
+    W65C02S_HOT uint8_t op_tya(AddressMode& m, uint8_t) { reg.a = reg.y;  reg.flag.test_nz(reg.a); return m.cycles; }
     // TSX   sp -> x                              + - - - - + -
-    uint8_t op_tsx(AddressMode& m, uint8_t) { reg.x = reg.sp; reg.flag.test_nz(reg.x); return m.cycles; }
+    W65C02S_HOT uint8_t op_tsx(AddressMode& m, uint8_t) { reg.x = reg.sp; reg.flag.test_nz(reg.x); return m.cycles; }
     // TXS   x -> sp                              - - - - - - -
-    uint8_t op_txs(AddressMode& m, uint8_t) { reg.sp = reg.x; return m.cycles; }
+    W65C02S_HOT uint8_t op_txs(AddressMode& m, uint8_t) { reg.sp = reg.x; return m.cycles; }
 
     // ------------------------------------------------------------------------
     //  Load operations
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // LDA   m -> a                               + - - - - + -
-    uint8_t op_lda(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_lda(AddressMode& m, uint8_t) {
         reg.a = m.get(*this, m);
         reg.flag.test_nz(reg.a);
         return m.cycles + m.page_penalty;
@@ -392,7 +577,7 @@ public:
 
     //                                            n v b d i z c
     // LDX   m -> x                               + - - - - + -
-    uint8_t op_ldx(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_ldx(AddressMode& m, uint8_t) {
         reg.x = m.get(*this, m);
         reg.flag.test_nz(reg.x);
         return m.cycles + m.page_penalty;
@@ -400,7 +585,7 @@ public:
 
     //                                            n v b d i z c
     // LDY   m -> y                               + - - - - + -
-    uint8_t op_ldy(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_ldy(AddressMode& m, uint8_t) {
         reg.y = m.get(*this, m);
         reg.flag.test_nz(reg.y);
         return m.cycles + m.page_penalty;
@@ -411,34 +596,34 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // STA   a -> m                               - - - - - - -
-    uint8_t op_sta(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_sta(AddressMode& m, uint8_t) {
         m.resolve(*this, m);
         m.write(*this, m, reg.a);
-        return m.cycles;
+        return m.cycles + m.index_extra;
     }
 
     //                                            n v b d i z c
     // STX   x -> m                               - - - - - - -
-    uint8_t op_stx(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_stx(AddressMode& m, uint8_t) {
         m.resolve(*this, m);
         m.write(*this, m, reg.x);
-        return m.cycles;
+        return m.cycles + m.index_extra;
     }
 
     //                                            n v b d i z c
     // STY   y -> m                               - - - - - - -
-    uint8_t op_sty(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_sty(AddressMode& m, uint8_t) {
         m.resolve(*this, m);
         m.write(*this, m, reg.y);
-        return m.cycles;
+        return m.cycles + m.index_extra;
     }
 
     //                                            n v b d i z c
     // STZ   0 -> m                               - - - - - - -
-    uint8_t op_stz(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_stz(AddressMode& m, uint8_t) {
         m.resolve(*this, m);
         m.write(*this, m, 0);
-        return m.cycles;
+        return m.cycles + m.index_extra;
     }
 
     // ------------------------------------------------------------------------
@@ -446,29 +631,29 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // PHA   a -> push stack                      - - - - - - -
-    uint8_t op_pha(AddressMode& m, uint8_t) { stack_push(reg.a); return m.cycles; }
+    W65C02S_HOT uint8_t op_pha(AddressMode&, uint8_t) { stack_push(reg.a); return 3; }
     // PHX   x -> push stack                      - - - - - - -
-    uint8_t op_phx(AddressMode& m, uint8_t) { stack_push(reg.x); return m.cycles; }
+    W65C02S_HOT uint8_t op_phx(AddressMode&, uint8_t) { stack_push(reg.x); return 3; }
     // PHY   y -> push stack                      - - - - - - -
-    uint8_t op_phy(AddressMode& m, uint8_t) { stack_push(reg.y); return m.cycles; }
+    W65C02S_HOT uint8_t op_phy(AddressMode&, uint8_t) { stack_push(reg.y); return 3; }
     // PHP   proc status -> push stack            - - - - - - -
-    uint8_t op_php(AddressMode& m, uint8_t) { stack_push(reg.flag.value() | 0x10); return m.cycles; }
+    W65C02S_HOT uint8_t op_php(AddressMode&, uint8_t) { stack_push(reg.flag.value() | 0x10); return 3; }
 
     // PLA   pull stack -> a                      + - - - - + -
-    uint8_t op_pla(AddressMode&, uint8_t) { reg.a = stack_pull(); reg.flag.test_nz(reg.a); return 4; }
+    W65C02S_HOT uint8_t op_pla(AddressMode&, uint8_t) { reg.a = stack_pull(); reg.flag.test_nz(reg.a); return 4; }
     // PLX   pull stack -> x                      + - - - - + -
-    uint8_t op_plx(AddressMode&, uint8_t) { reg.x = stack_pull(); reg.flag.test_nz(reg.x); return 4; }
+    W65C02S_HOT uint8_t op_plx(AddressMode&, uint8_t) { reg.x = stack_pull(); reg.flag.test_nz(reg.x); return 4; }
     // PLY   pull stack -> y                      + - - - - + -
-    uint8_t op_ply(AddressMode&, uint8_t) { reg.y = stack_pull(); reg.flag.test_nz(reg.y); return 4; }
+    W65C02S_HOT uint8_t op_ply(AddressMode&, uint8_t) { reg.y = stack_pull(); reg.flag.test_nz(reg.y); return 4; }
     // PLP   pull stack -> proc status            from stack
-    uint8_t op_plp(AddressMode&, uint8_t) { reg.flag.set_value(stack_pull()); reg.flag.set_b(false); return 4; }
+    W65C02S_HOT uint8_t op_plp(AddressMode&, uint8_t) { reg.flag.set_value(stack_pull()); reg.flag.set_b(false); return 4; }
 
     // ------------------------------------------------------------------------
     //  Logic operations
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // AND   a & m -> a                           + - - - - + -
-    uint8_t op_and(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_and(AddressMode& m, uint8_t) {
         reg.a &= m.get(*this, m);
         reg.flag.test_nz(reg.a);
         return m.cycles + m.page_penalty;
@@ -476,7 +661,7 @@ public:
 
     //                                            n v b d i z c
     // ORA   a | m -> a                           + - - - - + -
-    uint8_t op_ora(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_ora(AddressMode& m, uint8_t) {
         reg.a |= m.get(*this, m);
         reg.flag.test_nz(reg.a);
         return m.cycles + m.page_penalty;
@@ -484,7 +669,7 @@ public:
 
     //                                            n v b d i z c
     // EOR   a ^ m -> a                           + - - - - + -
-    uint8_t op_eor(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_eor(AddressMode& m, uint8_t) {
         reg.a ^= m.get(*this, m);
         reg.flag.test_nz(reg.a);
         return m.cycles + m.page_penalty;
@@ -495,7 +680,7 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // CMP   a - m                                + - - - - + +
-    uint8_t op_cmp(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_cmp(AddressMode& m, uint8_t) {
         uint8_t val = m.get(*this, m);
         uint16_t res = reg.a - val;
         reg.flag.set_c(reg.a >= val);
@@ -505,7 +690,7 @@ public:
 
     //                                            n v b d i z c
     // CPX   x - m                                + - - - - + +
-    uint8_t op_cpx(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_cpx(AddressMode& m, uint8_t) {
         uint8_t val = m.get(*this, m);
         uint16_t res = reg.x - val;
         reg.flag.set_c(reg.x >= val);
@@ -515,7 +700,7 @@ public:
 
     //                                            n v b d i z c
     // CPY   y - m                                + - - - - + +
-    uint8_t op_cpy(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_cpy(AddressMode& m, uint8_t) {
         uint8_t val = m.get(*this, m);
         uint16_t res = reg.y - val;
         reg.flag.set_c(reg.y >= val);
@@ -528,51 +713,96 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // ADC   a + m + c -> a, c                    + + - - - + +
-    uint8_t op_adc(AddressMode& m, uint8_t) {
-        uint8_t val = m.get(*this, m);
+    W65C02S_HOT uint8_t op_adc(AddressMode& m, uint8_t) {
+        adc(m.get(*this, m));
+        return m.cycles + m.page_penalty + decimal_extra();
+    }
+
+    //                                            n v b d i z c
+    // SBC   a - m - c -> a                       + + - - - + +
+    W65C02S_HOT uint8_t op_sbc(AddressMode& m, uint8_t) {
+        sbc(m.get(*this, m));
+        return m.cycles + m.page_penalty + decimal_extra();
+    }
+
+    // Add with carry - shared by ADC and RRA
+    W65C02S_HOT void adc(uint8_t val) {
         uint8_t a = reg.a;
+        uint8_t c = reg.flag.c() ? 1 : 0;
         uint16_t res;
 
         if (reg.flag.d()) {  // BCD mode
-            res = (a & 0x0f) + (val & 0x0f) + (reg.flag.c() ? 1 : 0);
-            if (res > 0x09) res += 0x06;
-            res += (a & 0xf0) + (val & 0xf0);
-            reg.flag.test_av(a, val, res);
-            if (res > 0x99) res += 0x60;
+            if constexpr (Variant::cmos) {
+                res = (a & 0x0f) + (val & 0x0f) + c;
+                if (res > 0x09) res += 0x06;
+                res += (a & 0xf0) + (val & 0xf0);
+                reg.flag.test_av(a, val, res);
+                if (res > 0x99) res += 0x60;
+                reg.flag.test_nz(res & 0xff);
+            } else {
+                // NMOS: N and V come from the intermediate result, Z from the binary sum
+                res = (a & 0x0f) + (val & 0x0f) + c;
+                if (res > 0x09) res = ((res + 0x06) & 0x0f) + 0x10;
+                res += (a & 0xf0) + (val & 0xf0);
+                reg.flag.test_n(res & 0xff);
+                reg.flag.test_av(a, val, res);
+                reg.flag.test_z((a + val + c) & 0xff);
+                if (res >= 0xa0) res += 0x60;
+            }
         } else {
-            res = a + val + (reg.flag.c() ? 1 : 0);
+            res = a + val + c;
             reg.flag.test_av(a, val, res);
+            reg.flag.test_nz(res & 0xff);
         }
 
         reg.a = res & 0xff;
-        reg.flag.test_nz(reg.a);
-        reg.flag.test_c(res);
-        return m.cycles + m.page_penalty;
+        reg.flag.set_c(res > 0xff);  // decimal fix-up can carry past bit 8
     }
 
-    //                                            n v b d i z c
-    // SBC   a - m - c -> a                       + + - - - + +
-    uint8_t op_sbc(AddressMode& m, uint8_t) {
-        uint8_t val = m.get(*this, m);
+    // Subtract with borrow - shared by SBC and ISC
+    W65C02S_HOT void sbc(uint8_t val) {
         uint8_t a = reg.a;
-        uint16_t res;
+        uint8_t c = reg.flag.c() ? 1 : 0;
+        uint16_t res = a + (val ^ 0xff) + c;
+
+        // Flags follow the binary result on NMOS, even in decimal mode
+        reg.flag.test_sv(a, val, res);
+        reg.flag.test_nz(res & 0xff);
+        reg.flag.test_c(res);
 
         if (reg.flag.d()) {  // BCD mode
-            uint8_t vc = val ^ 0xff;
-            res = (a & 0x0f) + (vc & 0x0f) + (reg.flag.c() ? 1 : 0);
-            if (res < 0x10) res -= 0x06;
-            res += (a & 0xf0) + (vc & 0xf0);
-            reg.flag.test_sv(a, val, res);
-            if (res < 0x100) res -= 0x60;
-        } else {
-            res = a + (val ^ 0xff) + (reg.flag.c() ? 1 : 0);
-            reg.flag.test_sv(a, val, res);
+            if constexpr (Variant::cmos) {
+                uint8_t vc = val ^ 0xff;
+                res = (a & 0x0f) + (vc & 0x0f) + c;
+                if (res < 0x10) res -= 0x06;
+                res += (a & 0xf0) + (vc & 0xf0);
+                reg.flag.test_sv(a, val, res);
+                if (res < 0x100) res -= 0x60;
+                reg.flag.test_nz(res & 0xff);
+                reg.flag.test_c(res);
+            } else {
+                int16_t lo = (a & 0x0f) - (val & 0x0f) + c - 1;
+                if (lo < 0) lo = ((lo - 0x06) & 0x0f) - 0x10;
+                int16_t dec = (a & 0xf0) - (val & 0xf0) + lo;
+                if (dec < 0) dec -= 0x60;
+                res = static_cast<uint16_t>(dec);
+            }
         }
 
         reg.a = res & 0xff;
-        reg.flag.test_nz(reg.a);
-        reg.flag.test_c(res);
-        return m.cycles + m.page_penalty;
+    }
+
+    // 65C02 takes one extra cycle for ADC/SBC in decimal mode
+    W65C02S_HOT uint8_t decimal_extra() const {
+        if constexpr (Variant::cmos) return reg.flag.d() ? 1 : 0;
+        return 0;
+    }
+
+    // Read-modify-write timing: NMOS always spends the indexing cycle,
+    // CMOS only when the index crosses a page
+    W65C02S_HOT uint8_t rmw_cycles(const AddressMode& m) const {
+        if constexpr (Variant::cmos) return m.cycles + m.write_extra + m.page_penalty;
+        return m.cycles + m.write_extra + m.index_extra;
     }
 
     // ------------------------------------------------------------------------
@@ -580,32 +810,32 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // INX   x + 1 -> x                           + - - - - + -
-    uint8_t op_inx(AddressMode& m, uint8_t) { reg.x++; reg.flag.test_nz(reg.x); return m.cycles; }
+    W65C02S_HOT uint8_t op_inx(AddressMode& m, uint8_t) { reg.x++; reg.flag.test_nz(reg.x); return m.cycles; }
     // INY   y + 1 -> y                           + - - - - + -
-    uint8_t op_iny(AddressMode& m, uint8_t) { reg.y++; reg.flag.test_nz(reg.y); return m.cycles; }
+    W65C02S_HOT uint8_t op_iny(AddressMode& m, uint8_t) { reg.y++; reg.flag.test_nz(reg.y); return m.cycles; }
     // DEX   x - 1 -> x                           + - - - - + -
-    uint8_t op_dex(AddressMode& m, uint8_t) { reg.x--; reg.flag.test_nz(reg.x); return m.cycles; }
+    W65C02S_HOT uint8_t op_dex(AddressMode& m, uint8_t) { reg.x--; reg.flag.test_nz(reg.x); return m.cycles; }
     // DEY   y - 1 -> y                           + - - - - + -
-    uint8_t op_dey(AddressMode& m, uint8_t) { reg.y--; reg.flag.test_nz(reg.y); return m.cycles; }
+    W65C02S_HOT uint8_t op_dey(AddressMode& m, uint8_t) { reg.y--; reg.flag.test_nz(reg.y); return m.cycles; }
 
     //                                            n v b d i z c
     // INC   m + 1 -> m                           + - - - - + -
-    uint8_t op_inc(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_inc(AddressMode& m, uint8_t) {
         uint8_t val = m.get(*this, m);
         val++;
         m.write(*this, m, val);
         reg.flag.test_nz(val);
-        return m.cycles + m.write_extra;
+        return m.cycles + m.write_extra + m.index_extra;
     }
 
     //                                            n v b d i z c
     // DEC   m - 1 -> m                           + - - - - + -
-    uint8_t op_dec(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_dec(AddressMode& m, uint8_t) {
         uint8_t val = m.get(*this, m);
         val--;
         m.write(*this, m, val);
         reg.flag.test_nz(val);
-        return m.cycles + m.write_extra;
+        return m.cycles + m.write_extra + m.index_extra;
     }
 
     // ------------------------------------------------------------------------
@@ -613,48 +843,48 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // ASL   c <- [76543210] <- 0                 + - - - - + +
-    uint8_t op_asl(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_asl(AddressMode& m, uint8_t) {
         uint8_t val = m.get(*this, m);
         reg.flag.set_c(val & 0x80);
         val <<= 1;
         m.write(*this, m, val);
         reg.flag.test_nz(val);
-        return m.cycles + m.write_extra;
+        return rmw_cycles(m);
     }
 
     //                                            n v b d i z c
     // LSR   0 -> [76543210] -> c                 0 - - - - + +
-    uint8_t op_lsr(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_lsr(AddressMode& m, uint8_t) {
         uint8_t val = m.get(*this, m);
         reg.flag.set_c(val & 0x01);
         val >>= 1;
         m.write(*this, m, val);
         reg.flag.test_nz(val);
-        return m.cycles + m.write_extra;
+        return rmw_cycles(m);
     }
 
     //                                            n v b d i z c
     // ROL   c <- [76543210] <- c                 + - - - - + +
-    uint8_t op_rol(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_rol(AddressMode& m, uint8_t) {
         uint8_t val = m.get(*this, m);
         uint8_t carry_in = reg.flag.c() ? 0x01 : 0x00;
         reg.flag.set_c(val & 0x80);
         val = (val << 1) | carry_in;
         m.write(*this, m, val);
         reg.flag.test_nz(val);
-        return m.cycles + m.write_extra;
+        return rmw_cycles(m);
     }
 
     //                                            n v b d i z c
     // ROR   c -> [76543210] -> c                 + - - - - + +
-    uint8_t op_ror(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_ror(AddressMode& m, uint8_t) {
         uint8_t val = m.get(*this, m);
         uint8_t carry_in = reg.flag.c() ? 0x80 : 0x00;
         reg.flag.set_c(val & 0x01);
         val = (val >> 1) | carry_in;
         m.write(*this, m, val);
         reg.flag.test_nz(val);
-        return m.cycles + m.write_extra;
+        return rmw_cycles(m);
     }
 
     // ------------------------------------------------------------------------
@@ -662,7 +892,7 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // BCC   branch on carry clear (c = 0)        - - - - - - -
-    uint8_t op_bcc(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_bcc(AddressMode& m, uint8_t) {
         uint16_t target = m.resolve(*this, m);
         if (!reg.flag.c()) { reg.pc = target; return m.cycles + m.branch_extra + m.page_penalty; }
         return m.cycles;
@@ -670,7 +900,7 @@ public:
 
     //                                            n v b d i z c
     // BCS   branch on carry set (c = 1)          - - - - - - -
-    uint8_t op_bcs(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_bcs(AddressMode& m, uint8_t) {
         uint16_t target = m.resolve(*this, m);
         if (reg.flag.c()) { reg.pc = target; return m.cycles + m.branch_extra + m.page_penalty; }
         return m.cycles;
@@ -678,7 +908,7 @@ public:
 
     //                                            n v b d i z c
     // BEQ   branch on result zero (z = 1)        - - - - - - -
-    uint8_t op_beq(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_beq(AddressMode& m, uint8_t) {
         uint16_t target = m.resolve(*this, m);
         if (reg.flag.z()) { reg.pc = target; return m.cycles + m.branch_extra + m.page_penalty; }
         return m.cycles;
@@ -686,7 +916,7 @@ public:
 
     //                                            n v b d i z c
     // BNE   branch on result not zero (z = 0)    - - - - - - -
-    uint8_t op_bne(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_bne(AddressMode& m, uint8_t) {
         uint16_t target = m.resolve(*this, m);
         if (!reg.flag.z()) { reg.pc = target; return m.cycles + m.branch_extra + m.page_penalty; }
         return m.cycles;
@@ -694,7 +924,7 @@ public:
 
     //                                            n v b d i z c
     // BMI   branch on result minus (n = 1)       - - - - - - -
-    uint8_t op_bmi(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_bmi(AddressMode& m, uint8_t) {
         uint16_t target = m.resolve(*this, m);
         if (reg.flag.n()) { reg.pc = target; return m.cycles + m.branch_extra + m.page_penalty; }
         return m.cycles;
@@ -702,7 +932,7 @@ public:
 
     //                                            n v b d i z c
     // BPL   branch on result plus (n = 0)        - - - - - - -
-    uint8_t op_bpl(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_bpl(AddressMode& m, uint8_t) {
         uint16_t target = m.resolve(*this, m);
         if (!reg.flag.n()) { reg.pc = target; return m.cycles + m.branch_extra + m.page_penalty; }
         return m.cycles;
@@ -710,7 +940,7 @@ public:
 
     //                                            n v b d i z c
     // BVC   branch on overflow clear (v = 0)     - - - - - - -
-    uint8_t op_bvc(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_bvc(AddressMode& m, uint8_t) {
         uint16_t target = m.resolve(*this, m);
         if (!reg.flag.v()) { reg.pc = target; return m.cycles + m.branch_extra + m.page_penalty; }
         return m.cycles;
@@ -718,7 +948,7 @@ public:
 
     //                                            n v b d i z c
     // BVS   branch on overflow set (v = 1)       - - - - - - -
-    uint8_t op_bvs(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_bvs(AddressMode& m, uint8_t) {
         uint16_t target = m.resolve(*this, m);
         if (reg.flag.v()) { reg.pc = target; return m.cycles + m.branch_extra + m.page_penalty; }
         return m.cycles;
@@ -726,7 +956,7 @@ public:
 
     //                                            n v b d i z c
     // BRA   branch always                        - - - - - - -
-    uint8_t op_bra(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_bra(AddressMode& m, uint8_t) {
         uint16_t target = m.resolve(*this, m);
         reg.pc = target;
         return m.cycles + m.branch_extra + m.page_penalty;
@@ -737,14 +967,16 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // JMP   m -> pc                              - - - - - - -
-    uint8_t op_jmp(AddressMode& m, uint8_t opcode) {
+    W65C02S_HOT uint8_t op_jmp(AddressMode& m, uint8_t opcode) {
         reg.pc = m.resolve(*this, m);
-        return (opcode == 0x4c) ? 3 : m.cycles;  // absolute is 3 cycles, indirect modes are 6
+        if (opcode == 0x4c) return 3;              // absolute
+        if constexpr (!Variant::cmos) return 5;    // NMOS indirect skips the page-wrap fix-up cycle
+        return m.cycles;                           // CMOS indirect modes are 6
     }
 
     //                                            n v b d i z c
     // JSR   push pc, m -> pc                     - - - - - - -
-    uint8_t op_jsr(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_jsr(AddressMode& m, uint8_t) {
         uint16_t target = m.resolve(*this, m);
         stack_push_word(reg.pc - 1);
         reg.pc = target;
@@ -753,14 +985,14 @@ public:
 
     //                                            n v b d i z c
     // RTS   pull stack -> pc                     - - - - - - -
-    uint8_t op_rts(AddressMode&, uint8_t) {
+    W65C02S_HOT uint8_t op_rts(AddressMode&, uint8_t) {
         reg.pc = stack_pull_word() + 1;
         return 6;
     }
 
     //                                            n v b d i z c
     // RTI   pull stack -> sr, pull stack -> pc   from stack
-    uint8_t op_rti(AddressMode&, uint8_t) {
+    W65C02S_HOT uint8_t op_rti(AddressMode&, uint8_t) {
         reg.flag.set_value(stack_pull());
         reg.flag.set_b(false);
         reg.pc = stack_pull_word();
@@ -772,7 +1004,7 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // BIT   a & m -> z, m7 -> n, m6 -> v        m7 m6 - - - + -
-    uint8_t op_bit(AddressMode& m, uint8_t opcode) {
+    W65C02S_HOT uint8_t op_bit(AddressMode& m, uint8_t opcode) {
         uint8_t val = m.get(*this, m);
         reg.flag.test_z(val & reg.a);
         // Immediate mode (0x89) does not affect N and V
@@ -785,20 +1017,20 @@ public:
 
     //                                            n v b d i z c
     // TRB   m & a -> z, m & ~a -> m              - - - - - + -
-    uint8_t op_trb(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_trb(AddressMode& m, uint8_t) {
         uint8_t val = m.get(*this, m);
         reg.flag.test_z(val & reg.a);
         m.write(*this, m, val & ~reg.a);
-        return m.cycles + m.write_extra;
+        return rmw_cycles(m);
     }
 
     //                                            n v b d i z c
     // TSB   m & a -> z, m | a -> m               - - - - - + -
-    uint8_t op_tsb(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_tsb(AddressMode& m, uint8_t) {
         uint8_t val = m.get(*this, m);
         reg.flag.test_z(val & reg.a);
         m.write(*this, m, val | reg.a);
-        return m.cycles + m.write_extra;
+        return rmw_cycles(m);
     }
 
     // ------------------------------------------------------------------------
@@ -806,25 +1038,25 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // RMB   reset memory bit b                   - - - - - - -
-    uint8_t op_rmb(AddressMode& m, uint8_t opcode) {
+    W65C02S_HOT uint8_t op_rmb(AddressMode& m, uint8_t opcode) {
         uint8_t bit = (opcode >> 4) & 0x07;
         uint8_t val = m.get(*this, m);
         m.write(*this, m, val & ~(1 << bit));
-        return m.cycles + m.write_extra;
+        return rmw_cycles(m);
     }
 
     //                                            n v b d i z c
     // SMB   set memory bit b                     - - - - - - -
-    uint8_t op_smb(AddressMode& m, uint8_t opcode) {
+    W65C02S_HOT uint8_t op_smb(AddressMode& m, uint8_t opcode) {
         uint8_t bit = (opcode >> 4) & 0x07;
         uint8_t val = m.get(*this, m);
         m.write(*this, m, val | (1 << bit));
-        return m.cycles + m.write_extra;
+        return rmw_cycles(m);
     }
 
     //                                            n v b d i z c
     // BBR   branch on bit b reset                - - - - - - -
-    uint8_t op_bbr(AddressMode& m, uint8_t opcode) {
+    W65C02S_HOT uint8_t op_bbr(AddressMode& m, uint8_t opcode) {
         uint8_t bit = (opcode >> 4) & 0x07;
         // MODE_ZP_REL: get() reads from zp, resolve() returns branch target
         uint8_t val = m.get(*this, m);
@@ -842,7 +1074,7 @@ public:
 
     //                                            n v b d i z c
     // BBS   branch on bit b set                  - - - - - - -
-    uint8_t op_bbs(AddressMode& m, uint8_t opcode) {
+    W65C02S_HOT uint8_t op_bbs(AddressMode& m, uint8_t opcode) {
         uint8_t bit = (opcode >> 4) & 0x07;
         uint8_t val = m.get(*this, m);
         int8_t off = static_cast<int8_t>(ram_read(reg.pc++));
@@ -861,11 +1093,11 @@ public:
     // ------------------------------------------------------------------------
     //                                            n v b d i z c
     // BRK   break                                - - 1 0 1 - -
-    uint8_t op_brk(AddressMode&, uint8_t) {
+    W65C02S_HOT uint8_t op_brk(AddressMode&, uint8_t) {
         reg.pc++;  // BRK skips the signature byte
         stack_push_word(reg.pc);
         stack_push(reg.flag.value() | 0x10);  // B flag set
-        reg.flag.set_d(false);
+        if constexpr (Variant::cmos) reg.flag.set_d(false);
         reg.flag.set_i(true);
         reg.pc = ram_read_word(0xfffe);
         return 7;
@@ -873,27 +1105,233 @@ public:
 
     //                                            n v b d i z c
     // NOP   no operation                         - - - - - - -
-    uint8_t op_nop(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_nop(AddressMode& m, uint8_t) {
         reg.pc += m.bytes - 1;
         return m.cycles;
     }
 
     //                                            n v b d i z c
     // STP   processor halt                       - - - - - - -
-    uint8_t op_stp(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_stp(AddressMode&, uint8_t) {
         halted = true;
-        return m.cycles;
+        return 3;
     }
 
     //                                            n v b d i z c
     // WAI   wait for interrupt                   - - - - - - -
-    uint8_t op_wai(AddressMode& m, uint8_t) {
+    W65C02S_HOT uint8_t op_wai(AddressMode&, uint8_t) {
         waiting = true;
+        return 3;
+    }
+
+    //                                            n v b d i z c
+    // NOP   no operation, operand is read        - - - - - - -
+    W65C02S_HOT uint8_t op_nop_read(AddressMode& m, uint8_t) {
+        m.get(*this, m);
+        return m.cycles + m.page_penalty;
+    }
+
+    // ------------------------------------------------------------------------
+    //  NMOS undocumented operations
+    // ------------------------------------------------------------------------
+    //                                            n v b d i z c
+    // JAM   processor lock-up                    - - - - - - -
+    W65C02S_HOT uint8_t op_jam(AddressMode& m, uint8_t) {
+        halted = true;
         return m.cycles;
     }
 
-    // Opcode table construction - defined after W65C02S_ISA_TABLE
+    //                                            n v b d i z c
+    // LAX   m -> a, m -> x                       + - - - - + -
+    W65C02S_HOT uint8_t op_lax(AddressMode& m, uint8_t) {
+        reg.a = reg.x = m.get(*this, m);
+        reg.flag.test_nz(reg.a);
+        return m.cycles + m.page_penalty;
+    }
+
+    //                                            n v b d i z c
+    // SAX   a & x -> m                           - - - - - - -
+    W65C02S_HOT uint8_t op_sax(AddressMode& m, uint8_t) {
+        m.resolve(*this, m);
+        m.write(*this, m, reg.a & reg.x);
+        return m.cycles + m.index_extra;
+    }
+
+    //                                            n v b d i z c
+    // DCP   m - 1 -> m, a - m                    + - - - - + +
+    W65C02S_HOT uint8_t op_dcp(AddressMode& m, uint8_t) {
+        uint8_t val = m.get(*this, m) - 1;
+        m.write(*this, m, val);
+        reg.flag.set_c(reg.a >= val);
+        reg.flag.test_nz((reg.a - val) & 0xff);
+        return rmw_cycles(m);
+    }
+
+    //                                            n v b d i z c
+    // ISC   m + 1 -> m, a - m - c -> a           + + - - - + +
+    W65C02S_HOT uint8_t op_isc(AddressMode& m, uint8_t) {
+        uint8_t val = m.get(*this, m) + 1;
+        m.write(*this, m, val);
+        sbc(val);
+        return rmw_cycles(m);
+    }
+
+    //                                            n v b d i z c
+    // SLO   m << 1 -> m, a | m -> a              + - - - - + +
+    W65C02S_HOT uint8_t op_slo(AddressMode& m, uint8_t) {
+        uint8_t val = m.get(*this, m);
+        reg.flag.set_c(val & 0x80);
+        val <<= 1;
+        m.write(*this, m, val);
+        reg.a |= val;
+        reg.flag.test_nz(reg.a);
+        return rmw_cycles(m);
+    }
+
+    //                                            n v b d i z c
+    // RLA   rol m -> m, a & m -> a               + - - - - + +
+    W65C02S_HOT uint8_t op_rla(AddressMode& m, uint8_t) {
+        uint8_t val = m.get(*this, m);
+        uint8_t carry_in = reg.flag.c() ? 0x01 : 0x00;
+        reg.flag.set_c(val & 0x80);
+        val = (val << 1) | carry_in;
+        m.write(*this, m, val);
+        reg.a &= val;
+        reg.flag.test_nz(reg.a);
+        return rmw_cycles(m);
+    }
+
+    //                                            n v b d i z c
+    // SRE   m >> 1 -> m, a ^ m -> a              + - - - - + +
+    W65C02S_HOT uint8_t op_sre(AddressMode& m, uint8_t) {
+        uint8_t val = m.get(*this, m);
+        reg.flag.set_c(val & 0x01);
+        val >>= 1;
+        m.write(*this, m, val);
+        reg.a ^= val;
+        reg.flag.test_nz(reg.a);
+        return rmw_cycles(m);
+    }
+
+    //                                            n v b d i z c
+    // RRA   ror m -> m, a + m + c -> a           + + - - - + +
+    W65C02S_HOT uint8_t op_rra(AddressMode& m, uint8_t) {
+        uint8_t val = m.get(*this, m);
+        uint8_t carry_in = reg.flag.c() ? 0x80 : 0x00;
+        reg.flag.set_c(val & 0x01);
+        val = (val >> 1) | carry_in;
+        m.write(*this, m, val);
+        adc(val);
+        return rmw_cycles(m);
+    }
+
+    //                                            n v b d i z c
+    // ANC   a & m -> a, n -> c                   + - - - - + +
+    W65C02S_HOT uint8_t op_anc(AddressMode& m, uint8_t) {
+        reg.a &= m.get(*this, m);
+        reg.flag.test_nz(reg.a);
+        reg.flag.set_c(reg.a & 0x80);
+        return m.cycles;
+    }
+
+    //                                            n v b d i z c
+    // ALR   (a & m) >> 1 -> a                    0 - - - - + +
+    W65C02S_HOT uint8_t op_alr(AddressMode& m, uint8_t) {
+        uint8_t val = reg.a & m.get(*this, m);
+        reg.flag.set_c(val & 0x01);
+        reg.a = val >> 1;
+        reg.flag.test_nz(reg.a);
+        return m.cycles;
+    }
+
+    //                                            n v b d i z c
+    // ARR   (a & m) ror 1 -> a                   + + - - - + +
+    W65C02S_HOT uint8_t op_arr(AddressMode& m, uint8_t) {
+        uint8_t val = reg.a & m.get(*this, m);
+        uint8_t carry_in = reg.flag.c() ? 0x80 : 0x00;
+        reg.a = (val >> 1) | carry_in;
+
+        if (!reg.flag.d()) {
+            reg.flag.test_nz(reg.a);
+            reg.flag.set_c(reg.a & 0x40);
+            reg.flag.set_v(((reg.a >> 6) ^ (reg.a >> 5)) & 0x01);
+        } else {
+            // Decimal mode: flags from the rotate, then a BCD fix-up per nibble
+            reg.flag.set_n(carry_in);
+            reg.flag.test_z(reg.a);
+            reg.flag.set_v((val ^ reg.a) & 0x40);
+            if ((val & 0x0f) + (val & 0x01) > 0x05) {
+                reg.a = (reg.a & 0xf0) | ((reg.a + 0x06) & 0x0f);
+            }
+            bool carry = (val & 0xf0) + (val & 0x10) > 0x50;
+            if (carry) reg.a += 0x60;
+            reg.flag.set_c(carry);
+        }
+        return m.cycles;
+    }
+
+    //                                            n v b d i z c
+    // SBX   (a & x) - m -> x                     + - - - - + +
+    W65C02S_HOT uint8_t op_sbx(AddressMode& m, uint8_t) {
+        uint8_t val = m.get(*this, m);
+        uint8_t ax = reg.a & reg.x;
+        reg.flag.set_c(ax >= val);
+        reg.x = ax - val;
+        reg.flag.test_nz(reg.x);
+        return m.cycles;
+    }
+
+    //                                            n v b d i z c
+    // LAS   m & sp -> a, x, sp                   + - - - - + -
+    W65C02S_HOT uint8_t op_las(AddressMode& m, uint8_t) {
+        reg.a = reg.x = reg.sp = m.get(*this, m) & reg.sp;
+        reg.flag.test_nz(reg.a);
+        return m.cycles + m.page_penalty;
+    }
+
+    //                                            n v b d i z c
+    // XAA   (a | $ee) & x & m -> a               + - - - - + -
+    W65C02S_HOT uint8_t op_xaa(AddressMode& m, uint8_t) {
+        reg.a = (reg.a | 0xee) & reg.x & m.get(*this, m);
+        reg.flag.test_nz(reg.a);
+        return m.cycles;
+    }
+
+    //                                            n v b d i z c
+    // LXA   (a | $ee) & m -> a, x                + - - - - + -
+    W65C02S_HOT uint8_t op_lxa(AddressMode& m, uint8_t) {
+        reg.a = reg.x = (reg.a | 0xee) & m.get(*this, m);
+        reg.flag.test_nz(reg.a);
+        return m.cycles;
+    }
+
+    //                                            n v b d i z c
+    // SHX   x & (h + 1) -> m                     - - - - - - -
+    W65C02S_HOT uint8_t op_shx(AddressMode& m, uint8_t) { return store_high_and(m, reg.x); }
+    // SHY   y & (h + 1) -> m                     - - - - - - -
+    W65C02S_HOT uint8_t op_shy(AddressMode& m, uint8_t) { return store_high_and(m, reg.y); }
+    // AHX   a & x & (h + 1) -> m                 - - - - - - -
+    W65C02S_HOT uint8_t op_ahx(AddressMode& m, uint8_t) { return store_high_and(m, reg.a & reg.x); }
+    // TAS   a & x -> sp, sp & (h + 1) -> m       - - - - - - -
+    W65C02S_HOT uint8_t op_tas(AddressMode& m, uint8_t) {
+        reg.sp = reg.a & reg.x;
+        return store_high_and(m, reg.sp);
+    }
+
+    // Unstable stores: the value is ANDed with the base address high byte + 1,
+    // and a page crossing replaces the target high byte with the stored value
+    W65C02S_HOT uint8_t store_high_and(AddressMode& m, uint8_t val) {
+        m.resolve(*this, m);
+        uint8_t hi = static_cast<uint8_t>((m.eff_addr >> 8) - m.page_penalty);
+        val &= static_cast<uint8_t>(hi + 1);
+        if (m.page_penalty) m.eff_addr = (val << 8) | (m.eff_addr & 0xff);
+        m.write(*this, m, val);
+        return m.cycles + m.index_extra;
+    }
+
+    // Opcode table construction - defined after the ISA tables
     inline void build_opcode_table();
+    static inline uint8_t trace_reg_of(const OpcodeEntry& entry);
 };
 
 // ============================================================================
@@ -902,145 +1340,174 @@ public:
 
 // --- Get functions ---
 
-inline uint8_t get_abs(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint8_t get_abs(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = cpu.pop_word_pc();
     m.page_penalty = 0;
     return cpu.ram_read(m.eff_addr);
 }
 
-inline uint8_t get_abs_x(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint8_t get_abs_x(Cpu& cpu, AddressMode<Cpu>& m) {
     uint16_t base = cpu.pop_word_pc();
     m.eff_addr = (base + cpu.reg.x) & 0xffff;
     m.page_penalty = ((base ^ m.eff_addr) & 0xff00) ? 1 : 0;
     return cpu.ram_read(m.eff_addr);
 }
 
-inline uint8_t get_abs_y(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint8_t get_abs_y(Cpu& cpu, AddressMode<Cpu>& m) {
     uint16_t base = cpu.pop_word_pc();
     m.eff_addr = (base + cpu.reg.y) & 0xffff;
     m.page_penalty = ((base ^ m.eff_addr) & 0xff00) ? 1 : 0;
     return cpu.ram_read(m.eff_addr);
 }
 
-inline uint8_t get_zp(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint8_t get_zp(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = cpu.pop_byte_pc();
     m.page_penalty = 0;
     return cpu.ram_read(m.eff_addr);
 }
 
-inline uint8_t get_zp_x(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint8_t get_zp_x(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = (cpu.pop_byte_pc() + cpu.reg.x) & 0xff;
     m.page_penalty = 0;
     return cpu.ram_read(m.eff_addr);
 }
 
-inline uint8_t get_zp_y(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint8_t get_zp_y(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = (cpu.pop_byte_pc() + cpu.reg.y) & 0xff;
     m.page_penalty = 0;
     return cpu.ram_read(m.eff_addr);
 }
 
-inline uint8_t get_zp_ind(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint8_t get_zp_ind(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = cpu.ram_read_word(cpu.pop_byte_pc());
     m.page_penalty = 0;
     return cpu.ram_read(m.eff_addr);
 }
 
-inline uint8_t get_zp_x_ind(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint8_t get_zp_x_ind(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = cpu.ram_read_word((cpu.pop_byte_pc() + cpu.reg.x) & 0xff);
     m.page_penalty = 0;
     return cpu.ram_read(m.eff_addr);
 }
 
-inline uint8_t get_zp_ind_y(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint8_t get_zp_ind_y(Cpu& cpu, AddressMode<Cpu>& m) {
     uint16_t base = cpu.ram_read_word(cpu.pop_byte_pc());
     m.eff_addr = (base + cpu.reg.y) & 0xffff;
     m.page_penalty = ((base ^ m.eff_addr) & 0xff00) ? 1 : 0;
     return cpu.ram_read(m.eff_addr);
 }
 
-inline uint8_t get_imm(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint8_t get_imm(Cpu& cpu, AddressMode<Cpu>& m) {
     m.page_penalty = 0;
     return cpu.pop_byte_pc();
 }
 
-inline uint8_t get_acc(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint8_t get_acc(Cpu& cpu, AddressMode<Cpu>& m) {
     m.page_penalty = 0;
     return cpu.reg.a;
 }
 
 // --- Resolve functions ---
 
-inline uint16_t resolve_abs(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_abs(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = cpu.pop_word_pc();
     m.page_penalty = 0;
     return m.eff_addr;
 }
 
-inline uint16_t resolve_abs_x(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_abs_x(Cpu& cpu, AddressMode<Cpu>& m) {
     uint16_t base = cpu.pop_word_pc();
     m.eff_addr = (base + cpu.reg.x) & 0xffff;
     m.page_penalty = ((base ^ m.eff_addr) & 0xff00) ? 1 : 0;
     return m.eff_addr;
 }
 
-inline uint16_t resolve_abs_y(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_abs_y(Cpu& cpu, AddressMode<Cpu>& m) {
     uint16_t base = cpu.pop_word_pc();
     m.eff_addr = (base + cpu.reg.y) & 0xffff;
     m.page_penalty = ((base ^ m.eff_addr) & 0xff00) ? 1 : 0;
     return m.eff_addr;
 }
 
-inline uint16_t resolve_abs_ind(W65C02S& cpu, AddressMode& m) {
-    m.eff_addr = cpu.ram_read_word(cpu.pop_word_pc());
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_abs_ind(Cpu& cpu, AddressMode<Cpu>& m) {
+    uint16_t ptr = cpu.pop_word_pc();
+    if constexpr (Cpu::Variant::cmos) {
+        m.eff_addr = cpu.ram_read_word(ptr);
+    } else {
+        // NMOS: the pointer high byte is fetched without carrying into the page
+        m.eff_addr = cpu.ram_read(ptr) | (cpu.ram_read((ptr & 0xff00) | ((ptr + 1) & 0xff)) << 8);
+    }
     m.page_penalty = 0;
     return m.eff_addr;
 }
 
-inline uint16_t resolve_abs_x_ind(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_abs_x_ind(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = cpu.ram_read_word((cpu.pop_word_pc() + cpu.reg.x) & 0xffff);
     m.page_penalty = 0;
     return m.eff_addr;
 }
 
-inline uint16_t resolve_zp(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_zp(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = cpu.pop_byte_pc();
     m.page_penalty = 0;
     return m.eff_addr;
 }
 
-inline uint16_t resolve_zp_x(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_zp_x(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = (cpu.pop_byte_pc() + cpu.reg.x) & 0xff;
     m.page_penalty = 0;
     return m.eff_addr;
 }
 
-inline uint16_t resolve_zp_y(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_zp_y(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = (cpu.pop_byte_pc() + cpu.reg.y) & 0xff;
     m.page_penalty = 0;
     return m.eff_addr;
 }
 
-inline uint16_t resolve_zp_ind(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_zp_ind(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = cpu.ram_read_word(cpu.pop_byte_pc());
     m.page_penalty = 0;
     return m.eff_addr;
 }
 
-inline uint16_t resolve_zp_x_ind(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_zp_x_ind(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = cpu.ram_read_word((cpu.pop_byte_pc() + cpu.reg.x) & 0xff);
     m.page_penalty = 0;
     return m.eff_addr;
 }
 
-inline uint16_t resolve_zp_ind_y(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_zp_ind_y(Cpu& cpu, AddressMode<Cpu>& m) {
     uint16_t base = cpu.ram_read_word(cpu.pop_byte_pc());
     m.eff_addr = (base + cpu.reg.y) & 0xffff;
     m.page_penalty = ((base ^ m.eff_addr) & 0xff00) ? 1 : 0;
     return m.eff_addr;
 }
 
-inline uint16_t resolve_rel(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_rel(Cpu& cpu, AddressMode<Cpu>& m) {
     int8_t off = static_cast<int8_t>(cpu.pop_byte_pc());
     uint16_t base = cpu.reg.pc;
     m.eff_addr = (base + off) & 0xffff;
@@ -1048,7 +1515,8 @@ inline uint16_t resolve_rel(W65C02S& cpu, AddressMode& m) {
     return m.eff_addr;
 }
 
-inline uint16_t resolve_zp_rel(W65C02S& cpu, AddressMode& m) {
+template<typename Cpu>
+W65C02S_HOT inline uint16_t resolve_zp_rel(Cpu& cpu, AddressMode<Cpu>& m) {
     m.eff_addr = cpu.pop_byte_pc();  // zp address for bit test
     int8_t off = static_cast<int8_t>(cpu.pop_byte_pc());
     uint16_t base = cpu.reg.pc;
@@ -1061,11 +1529,13 @@ inline uint16_t resolve_zp_rel(W65C02S& cpu, AddressMode& m) {
 
 // --- Write functions ---
 
-inline void write_mem(W65C02S& cpu, AddressMode& m, uint8_t val) {
+template<typename Cpu>
+W65C02S_HOT inline void write_mem(Cpu& cpu, AddressMode<Cpu>& m, uint8_t val) {
     cpu.ram_write(m.eff_addr, val);
 }
 
-inline void write_acc(W65C02S& cpu, AddressMode&, uint8_t val) {
+template<typename Cpu>
+W65C02S_HOT inline void write_acc(Cpu& cpu, AddressMode<Cpu>&, uint8_t val) {
     cpu.reg.a = val;
 }
 
@@ -1073,42 +1543,45 @@ inline void write_acc(W65C02S& cpu, AddressMode&, uint8_t val) {
 //  Addressing mode constants
 // ============================================================================
 
-// Ordered to match W65C02S_ISA column order: abs, absxi, absx, absy, absi, acum, imm, imp, rel, zprel, stck, zp, zpxi, zpx, zpy, zpi, zpiy
-//                                       name                      get            write      resolve             bytes cyc  wr  br
-inline constexpr AddressMode MODE_ABS      {"absolute",             get_abs,       write_mem, resolve_abs,        3,    4,   2,  0};
-inline constexpr AddressMode MODE_ABS_X_IND{"absolute_x_indirect",  nullptr,       nullptr,   resolve_abs_x_ind,  3,    6,   0,  0};
-inline constexpr AddressMode MODE_ABS_X    {"absolute_x",           get_abs_x,     write_mem, resolve_abs_x,      3,    4,   2,  0};
-inline constexpr AddressMode MODE_ABS_Y    {"absolute_y",           get_abs_y,     write_mem, resolve_abs_y,      3,    4,   0,  0};
-inline constexpr AddressMode MODE_ABS_IND  {"absolute_indirect",    nullptr,       nullptr,   resolve_abs_ind,    3,    6,   0,  0};
-inline constexpr AddressMode MODE_ACC      {"accumulator",          get_acc,       write_acc, nullptr,            1,    2,   0,  0};
-inline constexpr AddressMode MODE_IMM      {"immediate",            get_imm,       nullptr,   nullptr,            2,    2,   0,  0};
-inline constexpr AddressMode MODE_IMP      {"implied",              nullptr,       nullptr,   nullptr,            1,    2,   0,  0};
-inline constexpr AddressMode MODE_REL      {"relative",             nullptr,       nullptr,   resolve_rel,        2,    2,   0,  1};
-inline constexpr AddressMode MODE_ZP_REL   {"zero_page_relative",   get_zp,        nullptr,   resolve_zp_rel,     3,    5,   0,  1};
-inline constexpr AddressMode MODE_STACK    {"stack",                nullptr,       nullptr,   nullptr,            1,    3,   0,  0};
-inline constexpr AddressMode MODE_ZP       {"zero_page",            get_zp,        write_mem, resolve_zp,         2,    3,   2,  0};
-inline constexpr AddressMode MODE_ZP_X_IND {"zero_page_x_indirect", get_zp_x_ind,  write_mem, resolve_zp_x_ind,   2,    6,   0,  0};
-inline constexpr AddressMode MODE_ZP_X     {"zero_page_x",          get_zp_x,      write_mem, resolve_zp_x,       2,    4,   2,  0};
-inline constexpr AddressMode MODE_ZP_Y     {"zero_page_y",          get_zp_y,      write_mem, resolve_zp_y,       2,    4,   0,  0};
-inline constexpr AddressMode MODE_ZP_IND   {"zero_page_indirect",   get_zp_ind,    write_mem, resolve_zp_ind,     2,    5,   0,  0};
-inline constexpr AddressMode MODE_ZP_IND_Y {"zero_page_indirect_y", get_zp_ind_y,  write_mem, resolve_zp_ind_y,   2,    5,   0,  0};
+// Ordered to match the ISA column order: abs, absxi, absx, absy, absi, acum, imm, imp, rel, zprel, stck, zp, zpxi, zpx, zpy, zpi, zpiy
+//                                                          name                      get                 write           resolve                  bytes cyc  wr  br  ix
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ABS      {"absolute",             get_abs<Cpu>,       write_mem<Cpu>, resolve_abs<Cpu>,        3,    4,   2,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ABS_X_IND{"absolute_x_indirect",  nullptr,            nullptr,        resolve_abs_x_ind<Cpu>,  3,    6,   0,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ABS_X    {"absolute_x",           get_abs_x<Cpu>,     write_mem<Cpu>, resolve_abs_x<Cpu>,      3,    4,   2,  0,  1};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ABS_Y    {"absolute_y",           get_abs_y<Cpu>,     write_mem<Cpu>, resolve_abs_y<Cpu>,      3,    4,   2,  0,  1};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ABS_IND  {"absolute_indirect",    nullptr,            nullptr,        resolve_abs_ind<Cpu>,    3,    6,   0,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ACC      {"accumulator",          get_acc<Cpu>,       write_acc<Cpu>, nullptr,                 1,    2,   0,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_IMM      {"immediate",            get_imm<Cpu>,       nullptr,        nullptr,                 2,    2,   0,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_IMP      {"implied",              nullptr,            nullptr,        nullptr,                 1,    2,   0,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_REL      {"relative",             nullptr,            nullptr,        resolve_rel<Cpu>,        2,    2,   0,  1,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ZP_REL   {"zero_page_relative",   get_zp<Cpu>,        nullptr,        resolve_zp_rel<Cpu>,     3,    5,   0,  1,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_STACK    {"stack",                nullptr,            nullptr,        nullptr,                 1,    3,   0,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ZP       {"zero_page",            get_zp<Cpu>,        write_mem<Cpu>, resolve_zp<Cpu>,         2,    3,   2,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ZP_X_IND {"zero_page_x_indirect", get_zp_x_ind<Cpu>,  write_mem<Cpu>, resolve_zp_x_ind<Cpu>,   2,    6,   2,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ZP_X     {"zero_page_x",          get_zp_x<Cpu>,      write_mem<Cpu>, resolve_zp_x<Cpu>,       2,    4,   2,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ZP_Y     {"zero_page_y",          get_zp_y<Cpu>,      write_mem<Cpu>, resolve_zp_y<Cpu>,       2,    4,   0,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ZP_IND   {"zero_page_indirect",   get_zp_ind<Cpu>,    write_mem<Cpu>, resolve_zp_ind<Cpu>,     2,    5,   0,  0,  0};
+template<typename Cpu> inline constexpr AddressMode<Cpu> MODE_ZP_IND_Y {"zero_page_indirect_y", get_zp_ind_y<Cpu>,  write_mem<Cpu>, resolve_zp_ind_y<Cpu>,   2,    5,   2,  0,  1};
 
 // ============================================================================
-//  ISA Table (generated from X-macro)
+//  ISA Tables (generated from X-macro)
 // ============================================================================
 
+template<typename Cpu>
 struct InstructionDef {
     const char* mnemonic;
     int16_t opcodes[17];  // -1 means addressing mode not available
-    uint8_t (W65C02S::*handler)(AddressMode&, uint8_t);
+    uint8_t (Cpu::*handler)(AddressMode<Cpu>&, uint8_t);
 };
 
 #define MAKE_ENTRY(name, abs, absxi, absx, absy, absi, acum, imm, imp, rel, zprel, stck, zp, zpxi, zpx, zpy, zpi, zpiy, handler) \
-    { #name, { abs, absxi, absx, absy, absi, acum, imm, imp, rel, zprel, stck, zp, zpxi, zpx, zpy, zpi, zpiy }, &W65C02S::handler },
+    { #name, { abs, absxi, absx, absy, absi, acum, imm, imp, rel, zprel, stck, zp, zpxi, zpx, zpy, zpi, zpiy }, &Cpu::handler },
 
-inline const InstructionDef W65C02S_ISA_TABLE[] = {
-    W65C02S_ISA(MAKE_ENTRY)
-};
+template<typename Cpu> inline const InstructionDef<Cpu> W65C02_ISA_TABLE[]        = { W65C02_ISA(MAKE_ENTRY) };
+template<typename Cpu> inline const InstructionDef<Cpu> R65C02_BIT_ISA_TABLE[]    = { R65C02_BIT_ISA(MAKE_ENTRY) };
+template<typename Cpu> inline const InstructionDef<Cpu> W65C02S_WDC_ISA_TABLE[]   = { W65C02S_WDC_ISA(MAKE_ENTRY) };
+template<typename Cpu> inline const InstructionDef<Cpu> MOS6502_ISA_TABLE[]       = { MOS6502_ISA(MAKE_ENTRY) };
+template<typename Cpu> inline const InstructionDef<Cpu> MOS6502_UNDOC_ISA_TABLE[] = { MOS6502_UNDOC_ISA(MAKE_ENTRY) };
 
 #undef MAKE_ENTRY
 #undef __
@@ -1117,65 +1590,144 @@ inline const InstructionDef W65C02S_ISA_TABLE[] = {
 //  Opcode table construction
 // ============================================================================
 
-inline void W65C02S::build_opcode_table() {
-    // Addressing mode lookup table (matches column order in W65C02S_ISA macro)
+template<typename VariantT>
+inline void Cpu6502<VariantT>::build_opcode_table() {
+    // Addressing mode lookup table (matches column order in the ISA macros)
     static constexpr const AddressMode* ADDR_MODES[] = {
-        &MODE_ABS,       // abs
-        &MODE_ABS_X_IND, // absxi (absolute indexed indirect)
-        &MODE_ABS_X,     // absx
-        &MODE_ABS_Y,     // absy
-        &MODE_ABS_IND,   // absi (absolute indirect)
-        &MODE_ACC,       // acum
-        &MODE_IMM,       // imm
-        &MODE_IMP,       // imp
-        &MODE_REL,       // rel
-        &MODE_ZP_REL,    // zprel
-        &MODE_STACK,     // stck
-        &MODE_ZP,        // zp
-        &MODE_ZP_X_IND,  // zpxi (zero page indexed indirect)
-        &MODE_ZP_X,      // zpx
-        &MODE_ZP_Y,      // zpy
-        &MODE_ZP_IND,    // zpi (zero page indirect)
-        &MODE_ZP_IND_Y,  // zpiy (zero page indirect indexed)
+        &MODE_ABS<Cpu6502>,       // abs
+        &MODE_ABS_X_IND<Cpu6502>, // absxi (absolute indexed indirect)
+        &MODE_ABS_X<Cpu6502>,     // absx
+        &MODE_ABS_Y<Cpu6502>,     // absy
+        &MODE_ABS_IND<Cpu6502>,   // absi (absolute indirect)
+        &MODE_ACC<Cpu6502>,       // acum
+        &MODE_IMM<Cpu6502>,       // imm
+        &MODE_IMP<Cpu6502>,       // imp
+        &MODE_REL<Cpu6502>,       // rel
+        &MODE_ZP_REL<Cpu6502>,    // zprel
+        &MODE_STACK<Cpu6502>,     // stck
+        &MODE_ZP<Cpu6502>,        // zp
+        &MODE_ZP_X_IND<Cpu6502>,  // zpxi (zero page indexed indirect)
+        &MODE_ZP_X<Cpu6502>,      // zpx
+        &MODE_ZP_Y<Cpu6502>,      // zpy
+        &MODE_ZP_IND<Cpu6502>,    // zpi (zero page indirect)
+        &MODE_ZP_IND_Y<Cpu6502>,  // zpiy (zero page indirect indexed)
     };
 
     // Initialize all entries to nullptr (handled as 1-cycle NOP in step())
-    op_.fill({MODE_IMP, nullptr});
-
-    // Populate from ISA table
-    for (const auto& instr : W65C02S_ISA_TABLE) {
-        for (int mode = 0; mode < 17; ++mode) {
-            int16_t opcode = instr.opcodes[mode];
-            if (opcode >= 0) {
-                op_[opcode] = {*ADDR_MODES[mode], instr.handler};
+    op_.fill({MODE_IMP<Cpu6502>, nullptr});
+
+    // Populate from an ISA table
+    auto populate = [this](const auto& table) {
+        for (const auto& instr : table) {
+            for (int mode = 0; mode < 17; ++mode) {
+                int16_t opcode = instr.opcodes[mode];
+                if (opcode >= 0) {
+                    op_[opcode] = {*ADDR_MODES[mode], instr.handler};
+                }
             }
         }
+    };
+
+    if constexpr (!Variant::cmos) {
+        populate(MOS6502_ISA_TABLE<Cpu6502>);
+        populate(MOS6502_UNDOC_ISA_TABLE<Cpu6502>);
+
+        // Undocumented NOPs - implied ones are plain, the rest perform the operand read
+        for (uint8_t op : {0x1a, 0x3a, 0x5a, 0x7a, 0xda, 0xfa}) op_[op] = {MODE_IMP<Cpu6502>, &Cpu6502::op_nop};
+        for (uint8_t op : {0x80, 0x82, 0x89, 0xc2, 0xe2})       op_[op] = {MODE_IMM<Cpu6502>, &Cpu6502::op_nop_read};
+        for (uint8_t op : {0x04, 0x44, 0x64})                   op_[op] = {MODE_ZP<Cpu6502>, &Cpu6502::op_nop_read};
+        for (uint8_t op : {0x14, 0x34, 0x54, 0x74, 0xd4, 0xf4}) op_[op] = {MODE_ZP_X<Cpu6502>, &Cpu6502::op_nop_read};
+        op_[0x0c] = {MODE_ABS<Cpu6502>, &Cpu6502::op_nop_read};
+        for (uint8_t op : {0x1c, 0x3c, 0x5c, 0x7c, 0xdc, 0xfc}) op_[op] = {MODE_ABS_X<Cpu6502>, &Cpu6502::op_nop_read};
+
+        // JAM - locks up the processor until reset
+        for (uint8_t op : {0x02, 0x12, 0x22, 0x32, 0x42, 0x52, 0x62, 0x72, 0x92, 0xb2, 0xd2, 0xf2}) {
+            op_[op] = {MODE_IMP<Cpu6502>, &Cpu6502::op_jam};
+        }
+    } else {
+        populate(W65C02_ISA_TABLE<Cpu6502>);
+        if constexpr (Variant::bit_ops) populate(R65C02_BIT_ISA_TABLE<Cpu6502>);
+        if constexpr (Variant::wai_stp) populate(W65C02S_WDC_ISA_TABLE<Cpu6502>);
+
+        // Undefined opcodes - the 65C02 treats these as NOPs with various byte/cycle counts
+        // 1-byte undefined opcodes (1 cycle) - $x3 and $xB patterns, plus $x7 and $xF
+        // where the variant lacks the bit instructions
+        for (uint8_t hi = 0; hi < 0x10; hi++) {
+            for (uint8_t lo : {0x03, 0x07, 0x0b, 0x0f}) {
+                uint8_t op = (hi << 4) | lo;
+                if (!op_[op].handler) op_[op] = {{"undefined", nullptr, nullptr, nullptr, 1, 1, 0, 0}, &Cpu6502::op_nop};
+            }
+        }
+
+        // 2-byte undefined opcodes
+        op_[0x02] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &Cpu6502::op_nop};
+        op_[0x22] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &Cpu6502::op_nop};
+        op_[0x42] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &Cpu6502::op_nop};
+        op_[0x62] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &Cpu6502::op_nop};
+        op_[0x82] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &Cpu6502::op_nop};
+        op_[0xc2] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &Cpu6502::op_nop};
+        op_[0xe2] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &Cpu6502::op_nop};
+        op_[0x44] = {{"undefined", nullptr, nullptr, nullptr, 2, 3, 0, 0}, &Cpu6502::op_nop};
+        op_[0x54] = {{"undefined", nullptr, nullptr, nullptr, 2, 4, 0, 0}, &Cpu6502::op_nop};
+        op_[0xd4] = {{"undefined", nullptr, nullptr, nullptr, 2, 4, 0, 0}, &Cpu6502::op_nop};
+        op_[0xf4] = {{"undefined", nullptr, nullptr, nullptr, 2, 4, 0, 0}, &Cpu6502::op_nop};
+
+        // 3-byte undefined opcodes
+        op_[0x5c] = {{"undefined", nullptr, nullptr, nullptr, 3, 8, 0, 0}, &Cpu6502::op_nop};
+        op_[0xdc] = {{"undefined", nullptr, nullptr, nullptr, 3, 4, 0, 0}, &Cpu6502::op_nop};
+        op_[0xfc] = {{"undefined", nullptr, nullptr, nullptr, 3, 4, 0, 0}, &Cpu6502::op_nop};
     }
 
-    // Undefined opcodes - WDC 65C02 treats these as NOPs with various byte/cycle counts
-    // 1-byte undefined opcodes (1 cycle) - $x3 and $xB patterns
-    for (uint8_t hi = 0; hi < 0x10; hi++) {
-        uint8_t op1 = (hi << 4) | 0x03;
-        uint8_t op2 = (hi << 4) | 0x0b;
-        if (!op_[op1].handler) op_[op1] = {{"undefined", nullptr, nullptr, nullptr, 1, 1, 0, 0}, &W65C02S::op_nop};
-        if (!op_[op2].handler) op_[op2] = {{"undefined", nullptr, nullptr, nullptr, 1, 1, 0, 0}, &W65C02S::op_nop};
-    }
-
-    // 2-byte undefined opcodes
-    op_[0x02] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &W65C02S::op_nop};
-    op_[0x22] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &W65C02S::op_nop};
-    op_[0x42] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &W65C02S::op_nop};
-    op_[0x62] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &W65C02S::op_nop};
-    op_[0x82] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &W65C02S::op_nop};
-    op_[0xc2] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &W65C02S::op_nop};
-    op_[0xe2] = {{"undefined", nullptr, nullptr, nullptr, 2, 2, 0, 0}, &W65C02S::op_nop};
-    op_[0x44] = {{"undefined", nullptr, nullptr, nullptr, 2, 3, 0, 0}, &W65C02S::op_nop};
-    op_[0x54] = {{"undefined", nullptr, nullptr, nullptr, 2, 4, 0, 0}, &W65C02S::op_nop};
-    op_[0xd4] = {{"undefined", nullptr, nullptr, nullptr, 2, 4, 0, 0}, &W65C02S::op_nop};
-    op_[0xf4] = {{"undefined", nullptr, nullptr, nullptr, 2, 4, 0, 0}, &W65C02S::op_nop};
-
-    // 3-byte undefined opcodes
-    op_[0x5c] = {{"undefined", nullptr, nullptr, nullptr, 3, 8, 0, 0}, &W65C02S::op_nop};
-    op_[0xdc] = {{"undefined", nullptr, nullptr, nullptr, 3, 4, 0, 0}, &W65C02S::op_nop};
-    op_[0xfc] = {{"undefined", nullptr, nullptr, nullptr, 3, 4, 0, 0}, &W65C02S::op_nop};
+    static uint8_t Register6502::* const trace_srcs[] = {
+        &Register6502::a, &Register6502::a, &Register6502::x, &Register6502::y,
+        &Register6502::sp, &Register6502::a, &Register6502::x, &Register6502::y,
+    };
+    for (auto& entry : op_) {
+        entry.trace_reg = trace_reg_of(entry);
+        entry.trace_src = trace_srcs[entry.trace_reg];
+    }
+}
+
+// Register an instruction leaves its result in, for the execution trace. LAX
+// and LXA also copy A to X and LAS sets A, X and SP alike, so one register
+// covers them; SP is recorded for every instruction that moves it.
+template<typename VariantT>
+inline uint8_t Cpu6502<VariantT>::trace_reg_of(const OpcodeEntry& entry) {
+    using C = Cpu6502;
+    auto h = entry.handler;
+    auto any = [h](std::initializer_list<decltype(h)> handlers) {
+        for (auto candidate : handlers) {
+            if (h == candidate) return true;
+        }
+        return false;
+    };
+
+    if (!h) return TRACE_REG_NONE;
+    if (h == &C::op_pla) return TRACE_REG_PULL_A;
+    if (h == &C::op_plx) return TRACE_REG_PULL_X;
+    if (h == &C::op_ply) return TRACE_REG_PULL_Y;
+    if (entry.mode.write == MODE_ACC<C>.write && any({&C::op_asl, &C::op_lsr, &C::op_rol, &C::op_ror, &C::op_inc, &C::op_dec})) {
+        return TRACE_REG_A;
+    }
+    if (any({&C::op_lda, &C::op_txa, &C::op_tya, &C::op_and, &C::op_ora, &C::op_eor, &C::op_adc, &C::op_sbc,
+             &C::op_lax, &C::op_lxa, &C::op_xaa, &C::op_anc, &C::op_alr, &C::op_arr,
+             &C::op_slo, &C::op_rla, &C::op_sre, &C::op_rra})) {
+        return TRACE_REG_A;
+    }
+    if (any({&C::op_ldx, &C::op_tax, &C::op_tsx, &C::op_inx, &C::op_dex, &C::op_sbx})) return TRACE_REG_X;
+    if (any({&C::op_ldy, &C::op_tay, &C::op_iny, &C::op_dey})) return TRACE_REG_Y;
+    if (any({&C::op_txs, &C::op_pha, &C::op_phx, &C::op_phy, &C::op_php, &C::op_plp,
+             &C::op_jsr, &C::op_rts, &C::op_rti, &C::op_brk, &C::op_las, &C::op_tas})) {
+        return TRACE_REG_SP;
+    }
+    return TRACE_REG_NONE;
 }
+
+// ============================================================================
+//  Processor types
+// ============================================================================
+
+using NMOS6502 = Cpu6502<cpu_variant::MOS6502>;
+using C65C02   = Cpu6502<cpu_variant::Cmos65C02>;
+using R65C02   = Cpu6502<cpu_variant::R65C02>;
+using W65C02S  = Cpu6502<cpu_variant::W65C02S>;